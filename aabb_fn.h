@@ -2,6 +2,13 @@
 #define GEOMETRY_AABBFN_H_INCLUDED_
 
 #include "aabb.h"
+#include "arena.h"
+#include "parallel.h"
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <type_traits>
 #include <vector>
 
 namespace Geometry
@@ -61,22 +68,42 @@ namespace Geometry
         }
         //assert( a==bb );
     }
+
+    // as above, returning the boxes in storage taken from arena.
+    // at most two boxes per dimension come out, and that much is reserved
+    // up front so collecting them never reallocates
+    template <typename AABB>
+    ArenaVector<AABB> AABB_Difference(
+        const AABB& a, const AABB& b,
+        Arena& arena
+    )
+    {
+        ArenaVector<AABB> result( (ArenaAllocator<AABB>( arena )) );
+        result.reserve( 2*AABB::VectorType::sDimensions );
+        auto ii = std::back_inserter( result );
+        AABB_Difference( a, b, ii );
+        return result;
+    }
+
     // edges
-    // outputs the set of edges that enclose the space defined by the AABB
+    // outputs the set of edges that enclose the space defined by the AABB,
+    // with the temporary corner and edge lists taken from arena
     template <typename AABB, typename insertion_iterator>
     void AABB_GatherEdges(
         AABB box,
-        insertion_iterator& ii
+        insertion_iterator& ii,
+        Arena& arena
     )
     {
         typedef typename AABB::VectorType Point;
         typedef std::pair<int, int> Edge;
 
         // create temporary storage for the edges
-        std::vector< Point > corners;
-        corners.reserve( iPow( 2, Point::sDimensions ) );
+        ArenaVector< Point > corners( (ArenaAllocator< Point >( arena )) );
+        corners.reserve( size_t(1) << Point::sDimensions );
 
-        std::vector< Edge > edges;
+        ArenaVector< Edge > edges( (ArenaAllocator< Edge >( arena )) );
+        edges.reserve( Point::sDimensions << (Point::sDimensions-1) );
 
         const Point e( box.GetMaxBound() );
         const Point o( box.GetMinBound() );
@@ -107,6 +134,105 @@ namespace Geometry
             *ii++ = LineN< Point >( corners[edges[e].first], corners[edges[e].second] );
     }
 
+    // as above, the temporaries fit in a stack buffer for up to 4 dimensions
+    // and only larger boxes fall back on the heap
+    template <typename AABB, typename insertion_iterator>
+    void AABB_GatherEdges(
+        AABB box,
+        insertion_iterator& ii
+    )
+    {
+        typedef typename AABB::VectorType Point;
+        const size_t corners = size_t(1) << Point::sDimensions;
+        const size_t edges = Point::sDimensions << (Point::sDimensions-1);
+        const size_t needed = corners*sizeof(Point) + edges*sizeof(std::pair<int, int>) + 2*alignof(std::max_align_t);
+
+        alignas(std::max_align_t) char buffer[ needed < 2048 ? needed : 2048 ];
+        Arena arena( buffer, sizeof(buffer), needed );
+        AABB_GatherEdges( box, ii, arena );
+    }
+
+    // bounds
+    // the box that starting from *first and calling ExpandToContain with each
+    // later point builds, bit for bit, but without its per point branches or
+    // nextafter. the loop keeps a plain running min and max as selects the
+    // compiler vectorises, the policy splits it across threads, and the max
+    // bound is nudged once at the end: past the largest of the later points
+    // if that reaches the first point's, as ExpandToContain would have, or
+    // left on the first point's if nothing later touched it.
+    // ties keep the earlier value, so -0 and +0 come out as in the loop
+    template <typename AABB, typename iterator>
+    void AABB_ComputeBounds(
+        iterator first, iterator last,
+        AABB& result,
+        const ExecutionPolicy& policy = ExecutionPolicy()
+    )
+    {
+        typedef typename AABB::VectorBase VectorBase;
+        typedef typename VectorBase::ScalarType Scalar;
+        const size_t D = VectorBase::sDimensions;
+        struct Extent
+        {
+            Scalar mMin[D];
+            Scalar mMax[D];
+        };
+
+        assert( first!=last );
+        const size_t count = size_t( last - first );
+        const VectorBase& origin = *first;
+        const Scalar lowest = std::numeric_limits<Scalar>::has_infinity
+            ? -std::numeric_limits<Scalar>::infinity()
+            : std::numeric_limits<Scalar>::lowest();
+
+        Extent identity;
+        for (size_t d=0;d!=D;++d)
+        {
+            identity.mMin[d] = origin[d];
+            identity.mMax[d] = lowest;
+        }
+
+        const Extent extent = ParallelReduce( policy, 1, count, identity,
+            [&](size_t begin, size_t end) {
+                Extent e = identity;
+                for (size_t i=begin;i!=end;++i)
+                {
+                    const VectorBase& p = first[i];
+                    for (size_t d=0;d!=D;++d)
+                    {
+                        e.mMin[d] = p[d] < e.mMin[d] ? p[d] : e.mMin[d];
+                        e.mMax[d] = p[d] > e.mMax[d] ? p[d] : e.mMax[d];
+                    }
+                }
+                return e;
+            },
+            [](const Extent& a, const Extent& b) {
+                Extent e;
+                for (size_t d=0;d!=D;++d)
+                {
+                    e.mMin[d] = b.mMin[d] < a.mMin[d] ? b.mMin[d] : a.mMin[d];
+                    e.mMax[d] = b.mMax[d] > a.mMax[d] ? b.mMax[d] : a.mMax[d];
+                }
+                return e;
+            } );
+
+        VectorBase minBound( origin ), maxBound( origin );
+        for (size_t d=0;d!=D;++d)
+        {
+            minBound[d] = extent.mMin[d];
+            if (count>1 && extent.mMax[d] >= origin[d])
+            {
+                maxBound[d] = std::is_integral< Scalar >::value
+                    ? extent.mMax[d]+1
+                    : nextafter(
+                        extent.mMax[d],
+                        std::numeric_limits< Scalar >::max()
+                    );
+            }
+        }
+        result.SetMinBound( minBound );
+        result.SetMaxBound( maxBound );
+    }
+
 }
 
 #endif
\ No newline at end of file
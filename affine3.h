@@ -0,0 +1,305 @@
+#ifndef GEOMETRY_AFFINE3_H_INCLUDED_
+#define GEOMETRY_AFFINE3_H_INCLUDED_
+
+#include "geometry_uninitialised.h"
+#include "matrixnm.h"
+#include "matrix4.h"
+#include "vector3d.h"
+#include "aabb3d.h"
+#include "parallel.h"
+
+#include <cassert>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // a Matrix4 without its constant last column: rows 0-2 hold the linear
+    // part and row 3 the translation, exactly as Matrix4 stores them.
+    // points transform as operator*(MatrixN, VectorN) does, as row vectors,
+    // and a*b gives the same transform as the Matrix4 product
+    template< typename Scalar >
+    class Affine3 : public MatrixNM<Scalar, 4, 3>
+    {
+    public:
+        typedef Scalar ScalarType;
+        typedef Affine3<Scalar> MatrixType;
+        typedef MatrixNM<Scalar, 4, 3> BaseType;
+        typedef Vector3d<Scalar> VectorType;
+        typedef AxisAlignedBoundingBox3d<Scalar> BoundsType;
+
+        // identity
+        Affine3();
+
+        // explictly uninitialised construction
+        explicit Affine3(const Uninitialised&)
+            : BaseType(uninitialised)
+        { }
+
+        Affine3(const BaseType& rhs)
+            : BaseType(rhs)
+        { }
+
+        Affine3(std::initializer_list<Scalar> data)
+            : BaseType(data)
+        { }
+
+        // from a Matrix4, whose last column must be 0,0,0,1
+        explicit Affine3(const MatrixNM<Scalar, 4, 4>& m);
+
+        // from basis vectors and a translation
+        Affine3(
+            const VectorN<Scalar,3>& x,
+            const VectorN<Scalar,3>& y,
+            const VectorN<Scalar,3>& z,
+            const VectorN<Scalar,3>& t);
+
+        static Affine3 Identity();
+        void BecomeIdentity();
+
+        static Affine3 Translation(const VectorN<Scalar,3>& t);
+
+        VectorType GetTranslation() const;
+        void SetTranslation(const VectorN<Scalar,3>& t);
+
+        void ComputeMatrix4(Matrix4<Scalar>& result) const;
+        Matrix4<Scalar> GetMatrix4() const;
+
+        // general inverse, the linear part must not be singular
+        Affine3 GetInverse() const;
+
+        // inverse for rotation plus translation only, transposes the linear part
+        Affine3 GetRigidInverse() const;
+
+        VectorType TransformPoint(const VectorN<Scalar,3>& p) const;
+        VectorType TransformDirection(const VectorN<Scalar,3>& d) const;
+
+        // the tightest box around the transformed box, max bound exclusive
+        BoundsType TransformBounds(const AxisAlignedBoundingBox< Vector3d<Scalar> >& box) const;
+    };
+
+    //
+    // Free-functions
+    //
+
+    // equivalent to the Matrix4 product, skipping the constant column
+    template< typename Scalar >
+    Affine3<Scalar> operator* (const Affine3<Scalar>& lhs, const Affine3<Scalar>& rhs)
+    {
+        Affine3<Scalar> r(uninitialised);
+        for (int n=0;n!=4;++n)
+        {
+            for (int m=0;m!=3;++m)
+            {
+                r[n][m] = lhs[n][0]*rhs[0][m] + lhs[n][1]*rhs[1][m] + lhs[n][2]*rhs[2][m];
+            }
+        }
+        r[3][0] += rhs[3][0];
+        r[3][1] += rhs[3][1];
+        r[3][2] += rhs[3][2];
+        return r;
+    }
+
+    // batch compose, result[i] = lhs[i] * rhs[i]. result may alias either input
+    template< typename Scalar >
+    void Multiply(const Affine3<Scalar>* lhs, const Affine3<Scalar>* rhs, Affine3<Scalar>* result, size_t count)
+    {
+        for (size_t i=0;i!=count;++i)
+            result[i] = lhs[i] * rhs[i];
+    }
+
+    template< typename Scalar >
+    void Multiply(const Affine3<Scalar>* lhs, const Affine3<Scalar>* rhs, Affine3<Scalar>* result, size_t count,
+        const ExecutionPolicy& policy)
+    {
+        ParallelFor( policy, 0, count, [=](size_t begin, size_t end) {
+            Multiply( lhs+begin, rhs+begin, result+begin, end-begin );
+        } );
+    }
+
+    //
+    // Member Functions
+    //
+
+    template< typename Scalar >
+    Affine3<Scalar>::Affine3()
+        : BaseType(uninitialised)
+    {
+        BecomeIdentity();
+    }
+
+    template< typename Scalar >
+    Affine3<Scalar>::Affine3(const MatrixNM<Scalar, 4, 4>& m)
+        : BaseType(uninitialised)
+    {
+        assert( m[0][3]==0 && m[1][3]==0 && m[2][3]==0 && m[3][3]==1 );
+        for (int n=0;n!=4;++n)
+            for (int c=0;c!=3;++c)
+                (*this)[n][c] = m[n][c];
+    }
+
+    template< typename Scalar >
+    Affine3<Scalar>::Affine3(
+        const VectorN<Scalar,3>& x,
+        const VectorN<Scalar,3>& y,
+        const VectorN<Scalar,3>& z,
+        const VectorN<Scalar,3>& t)
+        : BaseType(uninitialised)
+    {
+        for (int c=0;c!=3;++c)
+        {
+            (*this)[0][c] = x[c];
+            (*this)[1][c] = y[c];
+            (*this)[2][c] = z[c];
+            (*this)[3][c] = t[c];
+        }
+    }
+
+    // static
+    template< typename Scalar >
+    Affine3<Scalar> Affine3<Scalar>::Identity()
+    {
+        return Affine3();
+    }
+
+    template< typename Scalar >
+    void Affine3<Scalar>::BecomeIdentity()
+    {
+        for (int n=0;n!=4;++n)
+            for (int c=0;c!=3;++c)
+                (*this)[n][c] = (n==c);
+    }
+
+    // static
+    template< typename Scalar >
+    Affine3<Scalar> Affine3<Scalar>::Translation(const VectorN<Scalar,3>& t)
+    {
+        Affine3 result;
+        result.SetTranslation(t);
+        return result;
+    }
+
+    template< typename Scalar >
+    typename Affine3<Scalar>::VectorType Affine3<Scalar>::GetTranslation() const
+    {
+        return VectorType( (*this)[3][0], (*this)[3][1], (*this)[3][2] );
+    }
+
+    template< typename Scalar >
+    void Affine3<Scalar>::SetTranslation(const VectorN<Scalar,3>& t)
+    {
+        (*this)[3][0] = t[0];
+        (*this)[3][1] = t[1];
+        (*this)[3][2] = t[2];
+    }
+
+    template< typename Scalar >
+    void Affine3<Scalar>::ComputeMatrix4(Matrix4<Scalar>& result) const
+    {
+        for (int n=0;n!=4;++n)
+        {
+            for (int c=0;c!=3;++c)
+                result[n][c] = (*this)[n][c];
+            result[n][3] = (n==3);
+        }
+    }
+
+    template< typename Scalar >
+    Matrix4<Scalar> Affine3<Scalar>::GetMatrix4() const
+    {
+        Matrix4<Scalar> result(uninitialised);
+        ComputeMatrix4(result);
+        return result;
+    }
+
+    template< typename Scalar >
+    Affine3<Scalar> Affine3<Scalar>::GetInverse() const
+    {
+        const Affine3& m = *this;
+
+        // inverse of the linear part by cofactors
+        const Scalar c00 = m[1][1]*m[2][2] - m[1][2]*m[2][1];
+        const Scalar c01 = m[1][2]*m[2][0] - m[1][0]*m[2][2];
+        const Scalar c02 = m[1][0]*m[2][1] - m[1][1]*m[2][0];
+        const Scalar det = m[0][0]*c00 + m[0][1]*c01 + m[0][2]*c02;
+        assert( det != 0 );
+        const Scalar id = 1 / det;
+
+        Affine3 r(uninitialised);
+        r[0][0] = c00 * id;
+        r[0][1] = (m[0][2]*m[2][1] - m[0][1]*m[2][2]) * id;
+        r[0][2] = (m[0][1]*m[1][2] - m[0][2]*m[1][1]) * id;
+        r[1][0] = c01 * id;
+        r[1][1] = (m[0][0]*m[2][2] - m[0][2]*m[2][0]) * id;
+        r[1][2] = (m[0][2]*m[1][0] - m[0][0]*m[1][2]) * id;
+        r[2][0] = c02 * id;
+        r[2][1] = (m[0][1]*m[2][0] - m[0][0]*m[2][1]) * id;
+        r[2][2] = (m[0][0]*m[1][1] - m[0][1]*m[1][0]) * id;
+
+        // the translation becomes -t * inverse(linear)
+        for (int c=0;c!=3;++c)
+            r[3][c] = -( m[3][0]*r[0][c] + m[3][1]*r[1][c] + m[3][2]*r[2][c] );
+        return r;
+    }
+
+    template< typename Scalar >
+    Affine3<Scalar> Affine3<Scalar>::GetRigidInverse() const
+    {
+        const Affine3& m = *this;
+        Affine3 r(uninitialised);
+        for (int n=0;n!=3;++n)
+            for (int c=0;c!=3;++c)
+                r[n][c] = m[c][n];
+        for (int c=0;c!=3;++c)
+            r[3][c] = -( m[3][0]*r[0][c] + m[3][1]*r[1][c] + m[3][2]*r[2][c] );
+        return r;
+    }
+
+    template< typename Scalar >
+    typename Affine3<Scalar>::VectorType Affine3<Scalar>::TransformPoint(const VectorN<Scalar,3>& p) const
+    {
+        const Affine3& m = *this;
+        return VectorType(
+            p[0]*m[0][0] + p[1]*m[1][0] + p[2]*m[2][0] + m[3][0],
+            p[0]*m[0][1] + p[1]*m[1][1] + p[2]*m[2][1] + m[3][1],
+            p[0]*m[0][2] + p[1]*m[1][2] + p[2]*m[2][2] + m[3][2] );
+    }
+
+    template< typename Scalar >
+    typename Affine3<Scalar>::VectorType Affine3<Scalar>::TransformDirection(const VectorN<Scalar,3>& d) const
+    {
+        const Affine3& m = *this;
+        return VectorType(
+            d[0]*m[0][0] + d[1]*m[1][0] + d[2]*m[2][0],
+            d[0]*m[0][1] + d[1]*m[1][1] + d[2]*m[2][1],
+            d[0]*m[0][2] + d[1]*m[1][2] + d[2]*m[2][2] );
+    }
+
+    // Arvo, "Transforming Axis-Aligned Bounding Boxes", Graphics Gems 1990
+    template< typename Scalar >
+    typename Affine3<Scalar>::BoundsType Affine3<Scalar>::TransformBounds(const AxisAlignedBoundingBox< Vector3d<Scalar> >& box) const
+    {
+        const Affine3& m = *this;
+        VectorType lo( m[3][0], m[3][1], m[3][2] );
+        VectorType hi( lo );
+        for (int c=0;c!=3;++c)
+        {
+            for (int k=0;k!=3;++k)
+            {
+                const Scalar a = m[k][c] * box.GetMinBound()[k];
+                const Scalar b = m[k][c] * box.GetMaxBound()[k];
+                lo[c] += std::min(a, b);
+                hi[c] += std::max(a, b);
+            }
+        }
+        // through ExpandToContain, so the max bound is exclusive as usual
+        BoundsType result( lo );
+        result.ExpandToContain( hi );
+        return result;
+    }
+}
+
+#endif//GEOMETRY_AFFINE3_H_INCLUDED_
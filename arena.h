@@ -0,0 +1,245 @@
+#ifndef GEOMETRY_ARENA_H_INCLUDED_
+#define GEOMETRY_ARENA_H_INCLUDED_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // monotonic allocator: allocation bumps a pointer through large blocks,
+    // nothing is freed individually, and Reset rewinds to the start in O(1)
+    // keeping every block for reuse. once warmed up a per frame arena does
+    // no heap traffic at all. not thread safe, give each thread its own
+    class Arena
+    {
+        public:
+            const static size_t sDefaultBlockSize = 64*1024;
+            const static size_t sNoBlock = ~size_t(0);
+
+            explicit Arena(size_t blockSize = sDefaultBlockSize);
+
+            // starts in the caller's buffer, which must outlive the arena,
+            // and only moves on to heap blocks once that is full
+            Arena(void* buffer, size_t size, size_t blockSize = sDefaultBlockSize);
+
+            ~Arena();
+
+            Arena(const Arena&) = delete;
+            Arena& operator=(const Arena&) = delete;
+
+            // align must be a power of two
+            void* Allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+            // uninitialised storage for count objects
+            template<typename T>
+            T* AllocateArray(size_t count);
+
+            // invalidates everything allocated so far
+            void Reset();
+
+            // returns the heap blocks to the system as well as resetting
+            void Release();
+
+            size_t GetBytesUsed() const;
+            size_t GetCapacity() const;
+            size_t GetBlockCount() const;
+
+        private:
+            class Block
+            {
+                public:
+                    char* mData;
+                    size_t mSize;
+            };
+
+            // moves on to the next block with room for size bytes at align
+            void NextBlock(size_t size, size_t align);
+
+            char* mBuffer;
+            size_t mBufferSize;
+            size_t mBlockSize;
+
+            std::vector<Block> mBlocks;
+            // index into mBlocks of the current block, sNoBlock while in mBuffer
+            size_t mBlock;
+            char* mCurrent;
+            char* mEnd;
+            size_t mUsed;
+    };
+
+    // standard allocator handing out arena memory, deallocate does nothing.
+    // containers using it must not outlive the arena's next Reset
+    template<typename T>
+    class ArenaAllocator
+    {
+        public:
+            typedef T value_type;
+
+            ArenaAllocator(Arena& arena)
+                : mArena(&arena)
+            { }
+
+            template<typename U>
+            ArenaAllocator(const ArenaAllocator<U>& rhs)
+                : mArena(&rhs.GetArena())
+            { }
+
+            T* allocate(size_t n)
+            {
+                return mArena->AllocateArray<T>(n);
+            }
+
+            void deallocate(T*, size_t)
+            { }
+
+            Arena& GetArena() const { return *mArena; }
+
+        private:
+            Arena* mArena;
+    };
+
+    template<typename T, typename U>
+    bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+    {
+        return &lhs.GetArena() == &rhs.GetArena();
+    }
+
+    template<typename T, typename U>
+    bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    // reserve up front where the size is known, growth leaves the old
+    // storage behind in the arena until the next Reset
+    template<typename T>
+    using ArenaVector = std::vector< T, ArenaAllocator<T> >;
+
+    //
+    // Class Implementation
+    //
+
+    inline Arena::Arena(size_t blockSize)
+        : mBuffer(nullptr)
+        , mBufferSize(0)
+        , mBlockSize(blockSize)
+        , mBlock(sNoBlock)
+        , mCurrent(nullptr)
+        , mEnd(nullptr)
+        , mUsed(0)
+    {
+        assert( blockSize>0 );
+    }
+
+    inline Arena::Arena(void* buffer, size_t size, size_t blockSize)
+        : mBuffer(static_cast<char*>(buffer))
+        , mBufferSize(size)
+        , mBlockSize(blockSize)
+        , mBlock(sNoBlock)
+        , mCurrent(mBuffer)
+        , mEnd(mBuffer+size)
+        , mUsed(0)
+    {
+        assert( blockSize>0 );
+    }
+
+    inline Arena::~Arena()
+    {
+        for (const Block& block : mBlocks)
+            delete[] block.mData;
+    }
+
+    inline void* Arena::Allocate(size_t size, size_t align)
+    {
+        assert( align>0 && (align & (align-1))==0 );
+        uintptr_t p = (reinterpret_cast<uintptr_t>(mCurrent) + align-1) & ~uintptr_t(align-1);
+        if (mCurrent==nullptr || p + size > reinterpret_cast<uintptr_t>(mEnd))
+        {
+            NextBlock( size, align );
+            p = (reinterpret_cast<uintptr_t>(mCurrent) + align-1) & ~uintptr_t(align-1);
+        }
+
+        char* result = reinterpret_cast<char*>(p);
+        mUsed += size + (result - mCurrent);
+        mCurrent = result + size;
+        return result;
+    }
+
+    template<typename T>
+    T* Arena::AllocateArray(size_t count)
+    {
+        return static_cast<T*>( Allocate( count*sizeof(T), alignof(T) ) );
+    }
+
+    inline void Arena::NextBlock(size_t size, size_t align)
+    {
+        // blocks kept from before a Reset are reused in order, skipping any too small
+        const size_t needed = size + align - 1;
+        size_t next = mBlock==sNoBlock ? 0 : mBlock+1;
+        while (next<mBlocks.size() && mBlocks[next].mSize<needed)
+            ++next;
+
+        if (next==mBlocks.size())
+        {
+            Block block;
+            block.mSize = needed>mBlockSize ? needed : mBlockSize;
+            block.mData = new char[block.mSize];
+            mBlocks.push_back( block );
+        }
+
+        mBlock = next;
+        mCurrent = mBlocks[next].mData;
+        mEnd = mCurrent + mBlocks[next].mSize;
+    }
+
+    inline void Arena::Reset()
+    {
+        mUsed = 0;
+        if (mBuffer!=nullptr || mBlocks.empty())
+        {
+            mBlock = sNoBlock;
+            mCurrent = mBuffer;
+            mEnd = mBuffer + mBufferSize;
+        }
+        else
+        {
+            mBlock = 0;
+            mCurrent = mBlocks[0].mData;
+            mEnd = mCurrent + mBlocks[0].mSize;
+        }
+    }
+
+    inline void Arena::Release()
+    {
+        for (const Block& block : mBlocks)
+            delete[] block.mData;
+        mBlocks.clear();
+        Reset();
+    }
+
+    inline size_t Arena::GetBytesUsed() const
+    {
+        return mUsed;
+    }
+
+    inline size_t Arena::GetCapacity() const
+    {
+        size_t result = mBufferSize;
+        for (const Block& block : mBlocks)
+            result += block.mSize;
+        return result;
+    }
+
+    inline size_t Arena::GetBlockCount() const
+    {
+        return mBlocks.size();
+    }
+}
+
+#endif//GEOMETRY_ARENA_H_INCLUDED_
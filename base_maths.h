@@ -3,6 +3,9 @@
 
 #include <limits>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 namespace Geometry
 {
@@ -66,6 +69,34 @@ namespace Geometry
         return cos(d);
     }
 
+    inline float ACos( float f )
+    {
+        return acosf(f);
+    }
+
+    inline double ACos( double d )
+    {
+        return acos(d);
+    }
+
+    // Abramowitz & Stegun 4.4.46, |error| <= 2e-8 over [-1,1]
+    // branch free apart from the select, so loops using it can vectorise
+    template< typename Scalar >
+    inline Scalar ACosApprox( Scalar x )
+    {
+        const Scalar a = x < 0 ? -x : x;
+        Scalar p = Scalar(-0.0012624911);
+        p = p*a + Scalar( 0.0066700901);
+        p = p*a + Scalar(-0.0170881256);
+        p = p*a + Scalar( 0.0308918810);
+        p = p*a + Scalar(-0.0501743046);
+        p = p*a + Scalar( 0.0889789874);
+        p = p*a + Scalar(-0.2145988016);
+        p = p*a + Scalar( 1.5707963050);
+        const Scalar r = Sqrt( 1 - a ) * p;
+        return x < 0 ? Scalar(3.14159265358979323846) - r : r;
+    }
+
     inline int Abs( int i )
     {
         return abs(i);
@@ -109,6 +140,213 @@ namespace Geometry
         return iPow(b,e);
     }
 
+    // selects the implementation behind the accuracy-templated functions below,
+    // the plain overloads above always forward to the C library
+    enum Accuracy {
+        // C library, one scalar at a time
+        accuracy_exact,
+        // branch free polynomials, see SinCos and RSqrt for their error and range
+        accuracy_precise,
+        // branch free, absolute error below 4e-5 for sin/cos, ~5e-6 relative for rsqrt
+        accuracy_fast
+    };
+
+    // sine and cosine of x, sharing the range reduction. the approximate
+    // tiers take |x| up to 2^20 and give NaN past that, as for inf and NaN.
+    // over that range accuracy_precise is within 2 ulp (float) and 3 ulp
+    // (double), right up to the zeros of sin and cos
+    template< Accuracy A = accuracy_exact, typename Scalar >
+    inline void SinCos( Scalar x, Scalar* s, Scalar* c )
+    {
+        static_assert( std::is_floating_point<Scalar>::value, "SinCos needs a floating point type" );
+        if (A == accuracy_exact)
+        {
+            *s = Sin(x);
+            *c = Cos(x);
+            return;
+        }
+
+        // reduce to r in [-pi/4,pi/4] and the quadrant q, x = r + j*pi/2.
+        // this is done in double for float too, as a float reduction loses
+        // all relative accuracy next to the zeros. j is rounded by adding and
+        // taking away 1.5*2^52, which leaves j in the low bits of the sum, so
+        // there is no floor and no float to int conversion. pi/2 is split in
+        // three (Cody-Waite), the first two 33 bits long so that j times them
+        // is exact for |j| below 2^20
+        typedef typename std::conditional< std::is_same<Scalar, float>::value, uint32_t, uint64_t >::type Bits;
+        const double limit = 1048576;
+        const double magic = 6755399441055744.0;
+        const double twoOverPi = 6.36619772367581382433e-01;
+        const double pio2_1 = 1.57079632673412561417e+00;
+        const double pio2_2 = 6.07710050630396597660e-11;
+        const double pio2_3 = 2.02226624879595063154e-21;
+
+        // out of range lanes are swapped for NaN, which carries through. the
+        // swap is done on the bits so the compiler keeps one straight line
+        // path instead of splitting the loop on the test
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const double xd = x;
+        uint64_t xBits, nanBits;
+        std::memcpy( &xBits, &xd, sizeof(xBits) );
+        std::memcpy( &nanBits, &nan, sizeof(nanBits) );
+        const uint64_t keep = uint64_t(0) - uint64_t( Fabs( xd ) <= limit );
+        const uint64_t rBits = (xBits & keep) | (nanBits & ~keep);
+        double xr;
+        std::memcpy( &xr, &rBits, sizeof(xr) );
+        const double shifted = xr * twoOverPi + magic;
+        const double j = shifted - magic;
+        uint64_t jBits;
+        std::memcpy( &jBits, &shifted, sizeof(jBits) );
+        const Bits q = Bits( jBits );
+        const Scalar r = Scalar( ((xr - j*pio2_1) - j*pio2_2) - j*pio2_3 );
+        const Scalar z = r*r;
+
+        Scalar ps, pc;
+        if (A == accuracy_fast)
+        {
+            // truncated Taylor series, the error peaks at |r| = pi/4
+            ps = r + r*z*( Scalar(-1.0/6) + z*Scalar(1.0/120) );
+            pc = 1 - z/2 + z*z*( Scalar(1.0/24) + z*Scalar(-1.0/720) );
+        }
+        else if (std::is_same<Scalar, float>::value)
+        {
+            // cephes sinf / cosf minimax coefficients
+            ps = r + r*z*( Scalar(-1.6666654611E-1) + z*( Scalar(8.3321608736E-3) + z*Scalar(-1.9515295891E-4) ) );
+            pc = 1 - z/2 + z*z*( Scalar(4.166664568298827E-2) + z*( Scalar(-1.388731625493765E-3) + z*Scalar(2.443315711809948E-5) ) );
+        }
+        else
+        {
+            // cephes sin / cos minimax coefficients
+            ps = Scalar(1.58962301576546568060E-10);
+            ps = ps*z + Scalar(-2.50507477628578072866E-8);
+            ps = ps*z + Scalar(2.75573136213857245213E-6);
+            ps = ps*z + Scalar(-1.98412698295895385996E-4);
+            ps = ps*z + Scalar(8.33333333332211858878E-3);
+            ps = ps*z + Scalar(-1.66666666666666307295E-1);
+            ps = r + r*z*ps;
+            pc = Scalar(-1.13585365213876817300E-11);
+            pc = pc*z + Scalar(2.08757008419747316778E-9);
+            pc = pc*z + Scalar(-2.75573141792967388112E-7);
+            pc = pc*z + Scalar(2.48015872888517045348E-5);
+            pc = pc*z + Scalar(-1.38888888888730564116E-3);
+            pc = pc*z + Scalar(4.16666666666665929218E-2);
+            pc = 1 - z/2 + z*z*pc;
+        }
+
+        // rotate by the quadrant on the bits, odd quadrants swap sin and cos
+        // and the sign flips go straight into the sign bit. plain selects get
+        // turned back into branches when only one of the results is used
+        const int signShift = int( 8*sizeof(Bits) ) - 2;
+        Bits sBits, cBits;
+        std::memcpy( &sBits, &ps, sizeof(sBits) );
+        std::memcpy( &cBits, &pc, sizeof(cBits) );
+        const Bits swap = Bits(0) - (q & 1);
+        const Bits rs = (cBits & swap) | (sBits & ~swap);
+        const Bits rc = (sBits & swap) | (cBits & ~swap);
+        sBits = rs ^ ((q & 2) << signShift);
+        cBits = rc ^ (((q + 1) & 2) << signShift);
+        std::memcpy( s, &sBits, sizeof(sBits) );
+        std::memcpy( c, &cBits, sizeof(cBits) );
+    }
+
+    template< Accuracy A, typename Scalar >
+    inline Scalar Sin( Scalar x )
+    {
+        Scalar s, c;
+        SinCos<A>( x, &s, &c );
+        return s;
+    }
+
+    template< Accuracy A, typename Scalar >
+    inline Scalar Cos( Scalar x )
+    {
+        Scalar s, c;
+        SinCos<A>( x, &s, &c );
+        return c;
+    }
+
+    // 1/sqrt(x) for x > 0. the approximate tiers start from the bit level
+    // estimate and refine with Newton-Raphson, each step doubling the good bits
+    template< Accuracy A = accuracy_exact, typename Scalar >
+    inline Scalar RSqrt( Scalar x )
+    {
+        static_assert( std::is_floating_point<Scalar>::value, "RSqrt needs a floating point type" );
+        if (A == accuracy_exact)
+            return 1 / Sqrt(x);
+
+        Scalar y;
+        int steps;
+        if (std::is_same<Scalar, float>::value)
+        {
+            uint32_t i;
+            std::memcpy( &i, &x, sizeof(i) );
+            i = 0x5f375a86 - (i >> 1);
+            std::memcpy( &y, &i, sizeof(y) );
+            steps = A == accuracy_fast ? 2 : 3;
+        }
+        else
+        {
+            uint64_t i;
+            std::memcpy( &i, &x, sizeof(i) );
+            i = 0x5fe6eb50c7b537a9ull - (i >> 1);
+            std::memcpy( &y, &i, sizeof(y) );
+            steps = A == accuracy_fast ? 2 : 4;
+        }
+
+        const Scalar h = x / 2;
+        for (int n=0;n!=steps;++n)
+            y = y * ( Scalar(1.5) - h*y*y );
+        return y;
+    }
+
+    //
+    // batch forms, result[i] = f(x[i]) for i in [0,count).
+    // the loop bodies are branch free for the approximate tiers
+    // so the compiler can run them at full SIMD width
+    //
+
+    template< Accuracy A = accuracy_exact, typename Scalar >
+    inline void Sin( const Scalar* x, Scalar* result, size_t count )
+    {
+        for (size_t i=0;i!=count;++i)
+            result[i] = Sin<A>( x[i] );
+    }
+
+    template< Accuracy A = accuracy_exact, typename Scalar >
+    inline void Cos( const Scalar* x, Scalar* result, size_t count )
+    {
+        for (size_t i=0;i!=count;++i)
+            result[i] = Cos<A>( x[i] );
+    }
+
+    template< Accuracy A = accuracy_exact, typename Scalar >
+    inline void SinCos( const Scalar* x, Scalar* s, Scalar* c, size_t count )
+    {
+        for (size_t i=0;i!=count;++i)
+            SinCos<A>( x[i], s+i, c+i );
+    }
+
+    template< typename Scalar >
+    inline void Sqrt( const Scalar* x, Scalar* result, size_t count )
+    {
+        for (size_t i=0;i!=count;++i)
+            result[i] = Sqrt( x[i] );
+    }
+
+    template< Accuracy A = accuracy_exact, typename Scalar >
+    inline void RSqrt( const Scalar* x, Scalar* result, size_t count )
+    {
+        for (size_t i=0;i!=count;++i)
+            result[i] = RSqrt<A>( x[i] );
+    }
+
+    template< typename Scalar >
+    inline void Pow( const Scalar* b, Scalar e, Scalar* result, size_t count )
+    {
+        for (size_t i=0;i!=count;++i)
+            result[i] = Pow( b[i], e );
+    }
+
 }
 
 #endif //BASIC_MATHS_HEADER_INCLUDED
@@ -0,0 +1,548 @@
+#ifndef GEOMETRY_BINARY_FILE_H_INCLUDED_
+#define GEOMETRY_BINARY_FILE_H_INCLUDED_
+
+#include "vectorn.h"
+#include "aabb.h"
+#include "triangle.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // count contiguous T owned elsewhere
+    template< typename T >
+    class ArraySpan
+    {
+    public:
+        // empty
+        ArraySpan();
+        ArraySpan(T* data, size_t count);
+
+        size_t GetSize() const;
+        bool IsEmpty() const;
+        T* GetData() const;
+
+        T& operator[] (size_t offset) const;
+        T* begin() const;
+        T* end() const;
+
+    private:
+        T* mData;
+        size_t mCount;
+    };
+
+    // what one element of a section holds: count scalars as a vector,
+    // a box of two vectors or a triangle of three
+    enum class BinaryKind : uint32_t
+    {
+        vector = 1,
+        box = 2,
+        triangle = 3
+    };
+
+    // a section as described in the file's table
+    class BinarySection
+    {
+    public:
+        const static size_t sNameLength = 32;
+
+        uint32_t mKind;
+        // floating point, signed or unsigned in the high byte, bytes per scalar in the low
+        uint32_t mScalar;
+        // of the vectors the element is built from
+        uint32_t mDimension;
+        uint32_t mElementSize;
+        uint64_t mCount;
+        // from the start of the file, a multiple of sAlignment
+        uint64_t mOffset;
+        // zero terminated, may be empty
+        char mName[sNameLength];
+    };
+
+    // collects arrays and writes them as one file:
+    //
+    //   64 byte header: "GEOMBIN\0", endian tag, version, section count, table offset
+    //   table: a 64 byte BinarySection per array
+    //   data: each array raw, starting on a 64 byte boundary
+    //
+    // everything is written in the writer's byte order and the tag says
+    // which that was. the arrays are only referenced, they must stay alive
+    // and unchanged until Write
+    class BinaryWriter
+    {
+    public:
+        // of each section from the start of the file, enough for any SIMD load
+        const static size_t sAlignment = 64;
+        const static uint32_t sVersion = 1;
+
+        // VectorN<Scalar,N>, AxisAlignedBoundingBox<T>, Triangle<T> or types
+        // derived from them that add no members. names longer than
+        // BinarySection::sNameLength-1 are truncated
+        template< typename T >
+        void AddArray(const char* name, const T* data, size_t count);
+        template< typename T >
+        void AddArray(const char* name, const std::vector<T>& data);
+
+        size_t GetSectionCount() const;
+
+        bool Write(const char* path) const;
+
+    private:
+        std::vector<BinarySection> mSections;
+        std::vector<const void*> mData;
+    };
+
+    // maps a file written by BinaryWriter and hands out its arrays where they
+    // lie, opening costs the header and table and each array is paged in as
+    // it is touched. files written on a machine of the other byte order open,
+    // but only ComputeArray can read them
+    class BinaryReader
+    {
+    public:
+        const static size_t sNoSection = ~size_t(0);
+
+        BinaryReader();
+        ~BinaryReader();
+        BinaryReader(const BinaryReader&) = delete;
+        BinaryReader& operator=(const BinaryReader&) = delete;
+
+        // false if the file is missing, truncated or not this format,
+        // or is of a newer version
+        bool Open(const char* path);
+        void Close();
+
+        bool IsOpen() const;
+        bool IsNativeEndian() const;
+        uint32_t GetVersion() const;
+
+        size_t GetSectionCount() const;
+        // already in native byte order
+        const BinarySection& GetSection(size_t section) const;
+        // the first section of that name, or sNoSection
+        size_t FindSection(const char* name) const;
+
+        // true if the section holds T, or a type of the same layout
+        template< typename T >
+        bool Holds(size_t section) const;
+
+        // the section in place, empty if it does not hold T or the file is
+        // of the other byte order
+        template< typename T >
+        ArraySpan<const T> GetArray(size_t section) const;
+
+        // copies the section out, swapping bytes if needed
+        template< typename T >
+        bool ComputeArray(size_t section, std::vector<T>& result) const;
+
+    private:
+        void SwapBytes(void* data, size_t size) const;
+        void SwapScalars(void* data, size_t scalarSize, size_t count) const;
+
+        const unsigned char* mFile;
+        size_t mFileSize;
+        // the file read whole where there is no mmap
+        std::unique_ptr<uint64_t[]> mBuffer;
+        std::vector<BinarySection> mSections;
+        uint32_t mVersion;
+        bool mNativeEndian;
+    };
+
+    //
+    // Free-functions
+    //
+
+    // the scalar code stored in BinarySection::mScalar
+    template< typename Scalar >
+    uint32_t GetBinaryScalar()
+    {
+        static_assert( std::is_arithmetic<Scalar>::value, "scalars must be arithmetic" );
+        const uint32_t type = std::is_floating_point<Scalar>::value ? 1 : std::is_signed<Scalar>::value ? 2 : 3;
+        return (type << 8) | uint32_t(sizeof(Scalar));
+    }
+
+    // the section describing count elements of the pointed to type. overloads
+    // on the base templates, so derived types such as Vector3d and Triangle3d match
+    template< typename Scalar, size_t N >
+    BinarySection GetBinarySection(const VectorN<Scalar, N>*, size_t count)
+    {
+        BinarySection s = {};
+        s.mKind = uint32_t(BinaryKind::vector);
+        s.mScalar = GetBinaryScalar<Scalar>();
+        s.mDimension = uint32_t(N);
+        s.mElementSize = uint32_t(N*sizeof(Scalar));
+        s.mCount = count;
+        return s;
+    }
+
+    template< typename T >
+    BinarySection GetBinarySection(const AxisAlignedBoundingBox<T>*, size_t count)
+    {
+        BinarySection s = GetBinarySection( (const typename T::BaseType*)nullptr, count );
+        s.mKind = uint32_t(BinaryKind::box);
+        s.mElementSize *= 2;
+        return s;
+    }
+
+    template< typename T >
+    BinarySection GetBinarySection(const Triangle<T>*, size_t count)
+    {
+        BinarySection s = GetBinarySection( (const typename T::BaseType*)nullptr, count );
+        s.mKind = uint32_t(BinaryKind::triangle);
+        s.mElementSize *= 3;
+        return s;
+    }
+
+    //
+    // Class Implementation
+    //
+
+    template< typename T >
+    ArraySpan<T>::ArraySpan()
+        : mData(nullptr), mCount(0)
+    {
+    }
+
+    template< typename T >
+    ArraySpan<T>::ArraySpan(T* data, size_t count)
+        : mData(data), mCount(count)
+    {
+    }
+
+    template< typename T >
+    size_t ArraySpan<T>::GetSize() const
+    {
+        return mCount;
+    }
+
+    template< typename T >
+    bool ArraySpan<T>::IsEmpty() const
+    {
+        return mCount==0;
+    }
+
+    template< typename T >
+    T* ArraySpan<T>::GetData() const
+    {
+        return mData;
+    }
+
+    template< typename T >
+    T& ArraySpan<T>::operator[] (size_t offset) const
+    {
+        assert( offset<mCount );
+        return mData[offset];
+    }
+
+    template< typename T >
+    T* ArraySpan<T>::begin() const
+    {
+        return mData;
+    }
+
+    template< typename T >
+    T* ArraySpan<T>::end() const
+    {
+        return mData + mCount;
+    }
+
+    template< typename T >
+    void BinaryWriter::AddArray(const char* name, const T* data, size_t count)
+    {
+        // the geometry types declare their own assignment, so are not
+        // trivially copyable, but they are plain data in every other way
+        static_assert( std::is_standard_layout<T>::value && std::is_trivially_destructible<T>::value,
+            "only plain data can be written raw" );
+        BinarySection s = GetBinarySection( data, count );
+        // a derived type with members of its own would not match the layout
+        assert( s.mElementSize==sizeof(T) );
+        std::strncpy( s.mName, name ? name : "", BinarySection::sNameLength-1 );
+        mSections.push_back( s );
+        mData.push_back( data );
+    }
+
+    template< typename T >
+    void BinaryWriter::AddArray(const char* name, const std::vector<T>& data)
+    {
+        AddArray( name, data.data(), data.size() );
+    }
+
+    inline size_t BinaryWriter::GetSectionCount() const
+    {
+        return mSections.size();
+    }
+
+    inline bool BinaryWriter::Write(const char* path) const
+    {
+        const uint64_t tableOffset = sAlignment;
+        uint64_t offset = tableOffset + mSections.size()*sizeof(BinarySection);
+        std::vector<BinarySection> table( mSections );
+        for (auto& s : table)
+        {
+            offset = (offset + sAlignment-1) / sAlignment * sAlignment;
+            s.mOffset = offset;
+            offset += s.mCount*s.mElementSize;
+        }
+
+        unsigned char header[sAlignment] = {};
+        const uint32_t endian = 0x01020304;
+        const uint32_t version = sVersion;
+        const uint64_t count = table.size();
+        std::memcpy( header, "GEOMBIN", 8 );
+        std::memcpy( header+8, &endian, 4 );
+        std::memcpy( header+12, &version, 4 );
+        std::memcpy( header+16, &count, 8 );
+        std::memcpy( header+24, &tableOffset, 8 );
+
+        std::FILE* file = std::fopen( path, "wb" );
+        if (!file)
+            return false;
+        bool ok = std::fwrite( header, sizeof(header), 1, file )==1;
+        if (ok && !table.empty())
+            ok = std::fwrite( table.data(), sizeof(BinarySection), table.size(), file )==table.size();
+
+        uint64_t written = tableOffset + table.size()*sizeof(BinarySection);
+        const unsigned char zeros[sAlignment] = {};
+        for (size_t i=0;ok && i!=table.size();++i)
+        {
+            const size_t pad = size_t(table[i].mOffset - written);
+            const size_t size = size_t(table[i].mCount*table[i].mElementSize);
+            ok = (pad==0 || std::fwrite( zeros, 1, pad, file )==pad)
+                && (size==0 || std::fwrite( mData[i], 1, size, file )==size);
+            written = table[i].mOffset + size;
+        }
+        return std::fclose( file )==0 && ok;
+    }
+
+    inline BinaryReader::BinaryReader()
+        : mFile(nullptr), mFileSize(0), mVersion(0), mNativeEndian(true)
+    {
+    }
+
+    inline BinaryReader::~BinaryReader()
+    {
+        Close();
+    }
+
+    inline bool BinaryReader::Open(const char* path)
+    {
+        Close();
+#ifndef _WIN32
+        const int fd = ::open( path, O_RDONLY );
+        if (fd<0)
+            return false;
+        struct stat info;
+        if (::fstat( fd, &info )!=0 || size_t(info.st_size)<BinaryWriter::sAlignment)
+        {
+            ::close( fd );
+            return false;
+        }
+        mFileSize = size_t(info.st_size);
+        void* map = ::mmap( nullptr, mFileSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+        // the mapping holds its own reference to the file
+        ::close( fd );
+        if (map==MAP_FAILED)
+        {
+            mFileSize = 0;
+            return false;
+        }
+        mFile = static_cast<const unsigned char*>( map );
+#else
+        std::FILE* file = std::fopen( path, "rb" );
+        if (!file)
+            return false;
+        std::fseek( file, 0, SEEK_END );
+        const long size = std::ftell( file );
+        std::fseek( file, 0, SEEK_SET );
+        if (size<long(BinaryWriter::sAlignment))
+        {
+            std::fclose( file );
+            return false;
+        }
+        mFileSize = size_t(size);
+        mBuffer.reset( new uint64_t[(mFileSize+7)/8] );
+        const bool read = std::fread( mBuffer.get(), 1, mFileSize, file )==mFileSize;
+        std::fclose( file );
+        mFile = reinterpret_cast<const unsigned char*>( mBuffer.get() );
+        if (!read)
+        {
+            Close();
+            return false;
+        }
+#endif
+
+        uint32_t endian, version;
+        uint64_t count, tableOffset;
+        std::memcpy( &endian, mFile+8, 4 );
+        std::memcpy( &version, mFile+12, 4 );
+        std::memcpy( &count, mFile+16, 8 );
+        std::memcpy( &tableOffset, mFile+24, 8 );
+        mNativeEndian = endian==0x01020304;
+        if (!mNativeEndian)
+        {
+            SwapBytes( &endian, 4 );
+            SwapBytes( &version, 4 );
+            SwapBytes( &count, 8 );
+            SwapBytes( &tableOffset, 8 );
+        }
+        if (std::memcmp( mFile, "GEOMBIN", 8 )!=0 || endian!=0x01020304
+            || version==0 || version>BinaryWriter::sVersion
+            || tableOffset<BinaryWriter::sAlignment || tableOffset>mFileSize
+            || count>(mFileSize-tableOffset)/sizeof(BinarySection))
+        {
+            Close();
+            return false;
+        }
+        mVersion = version;
+
+        mSections.resize( size_t(count) );
+        if (count!=0)
+            std::memcpy( mSections.data(), mFile+tableOffset, size_t(count)*sizeof(BinarySection) );
+        for (auto& s : mSections)
+        {
+            if (!mNativeEndian)
+            {
+                SwapBytes( &s.mKind, 4 );
+                SwapBytes( &s.mScalar, 4 );
+                SwapBytes( &s.mDimension, 4 );
+                SwapBytes( &s.mElementSize, 4 );
+                SwapBytes( &s.mCount, 8 );
+                SwapBytes( &s.mOffset, 8 );
+            }
+            s.mName[BinarySection::sNameLength-1] = 0;
+            const uint64_t scalarSize = s.mScalar & 0xff;
+            if (s.mOffset>mFileSize || s.mOffset%BinaryWriter::sAlignment!=0
+                || scalarSize==0 || s.mElementSize%scalarSize!=0
+                || (s.mElementSize!=0 && s.mCount>(mFileSize-s.mOffset)/s.mElementSize))
+            {
+                Close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline void BinaryReader::Close()
+    {
+#ifndef _WIN32
+        if (mFile)
+            ::munmap( const_cast<unsigned char*>( mFile ), mFileSize );
+#endif
+        mBuffer.reset();
+        mFile = nullptr;
+        mFileSize = 0;
+        mSections.clear();
+        mVersion = 0;
+        mNativeEndian = true;
+    }
+
+    inline bool BinaryReader::IsOpen() const
+    {
+        return mFile!=nullptr;
+    }
+
+    inline bool BinaryReader::IsNativeEndian() const
+    {
+        return mNativeEndian;
+    }
+
+    inline uint32_t BinaryReader::GetVersion() const
+    {
+        return mVersion;
+    }
+
+    inline size_t BinaryReader::GetSectionCount() const
+    {
+        return mSections.size();
+    }
+
+    inline const BinarySection& BinaryReader::GetSection(size_t section) const
+    {
+        assert( section<mSections.size() );
+        return mSections[section];
+    }
+
+    inline size_t BinaryReader::FindSection(const char* name) const
+    {
+        for (size_t i=0;i!=mSections.size();++i)
+        {
+            if (std::strncmp( mSections[i].mName, name, BinarySection::sNameLength )==0)
+                return i;
+        }
+        return sNoSection;
+    }
+
+    template< typename T >
+    bool BinaryReader::Holds(size_t section) const
+    {
+        if (section>=mSections.size())
+            return false;
+        const BinarySection& s = mSections[section];
+        const BinarySection expected = GetBinarySection( (const T*)nullptr, 0 );
+        return s.mKind==expected.mKind && s.mScalar==expected.mScalar
+            && s.mDimension==expected.mDimension && s.mElementSize==sizeof(T);
+    }
+
+    template< typename T >
+    ArraySpan<const T> BinaryReader::GetArray(size_t section) const
+    {
+        if (!mNativeEndian || !Holds<T>( section ))
+            return ArraySpan<const T>();
+        const BinarySection& s = mSections[section];
+        assert( reinterpret_cast<uintptr_t>( mFile+s.mOffset ) % alignof(T)==0 );
+        return ArraySpan<const T>( reinterpret_cast<const T*>( mFile+s.mOffset ), size_t(s.mCount) );
+    }
+
+    template< typename T >
+    bool BinaryReader::ComputeArray(size_t section, std::vector<T>& result) const
+    {
+        if (!Holds<T>( section ))
+            return false;
+        const BinarySection& s = mSections[section];
+        // T may have no default constructor, so fill through raw storage
+        std::vector<unsigned char> bytes( mFile+s.mOffset, mFile+s.mOffset+s.mCount*s.mElementSize );
+        if (!mNativeEndian)
+            SwapScalars( bytes.data(), s.mScalar & 0xff, bytes.size()/(s.mScalar & 0xff) );
+        result.clear();
+        result.reserve( size_t(s.mCount) );
+        for (size_t i=0;i!=s.mCount;++i)
+        {
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type element;
+            std::memcpy( &element, bytes.data() + i*sizeof(T), sizeof(T) );
+            result.push_back( *reinterpret_cast<const T*>( &element ) );
+        }
+        return true;
+    }
+
+    inline void BinaryReader::SwapBytes(void* data, size_t size) const
+    {
+        unsigned char* bytes = static_cast<unsigned char*>( data );
+        std::reverse( bytes, bytes+size );
+    }
+
+    inline void BinaryReader::SwapScalars(void* data, size_t scalarSize, size_t count) const
+    {
+        unsigned char* bytes = static_cast<unsigned char*>( data );
+        for (size_t i=0;i!=count;++i)
+            SwapBytes( bytes + i*scalarSize, scalarSize );
+    }
+}
+
+#endif//GEOMETRY_BINARY_FILE_H_INCLUDED_
@@ -0,0 +1,331 @@
+#ifndef GEOMETRY_BVH_H_INCLUDED_
+#define GEOMETRY_BVH_H_INCLUDED_
+
+#include "triangle3d.h"
+#include "aabb3d.h"
+#include "ray3d.h"
+#include "mesh.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // bounding volume hierarchy over triangles, split at the centroid median
+    // of the widest axis. nodes are stored depth first, the left child follows
+    // its parent directly, and leaves hold one TriangleBlock
+    template <typename Scalar>
+    class TriangleBVH
+    {
+        public:
+            typedef Triangle3d<Scalar> TriangleType;
+            typedef AxisAlignedBoundingBox3d<Scalar> BoundsType;
+            typedef Ray3d<Scalar> RayType;
+            typedef RayHit<Scalar> HitType;
+            typedef TriangleBlock<Scalar, 4> BlockType;
+
+            // hit triangle ids are the index into triangles
+            explicit TriangleBVH(const std::vector<TriangleType>& triangles);
+
+            // hit triangle ids are face indices
+            explicit TriangleBVH(const IndexedMesh<Scalar>& mesh);
+
+            size_t GetNodeCount() const;
+            const BoundsType& GetBounds() const;
+
+            // bytes held by the node array, not counting the triangle blocks
+            size_t GetNodeMemory() const;
+
+            // read access to the node graph, for building other layouts from
+            // this one. node 0 is the root
+            const BoundsType& GetNodeBounds(size_t node) const;
+            bool IsLeaf(size_t node) const;
+            size_t GetLeftChild(size_t node) const;
+            size_t GetRightChild(size_t node) const;
+            const BlockType& GetLeafBlock(size_t node) const;
+
+            // nearest hit closer than hit->mDistance, which should be set to the
+            // maximum distance of interest (the default is unbounded)
+            bool ClosestHit(const RayType& ray, HitType* hit) const;
+
+            // true as soon as any hit closer than tMax is found
+            bool AnyHit(const RayType& ray, Scalar tMax) const;
+
+        private:
+            class Node
+            {
+                public:
+                    Node(const BoundsType& bounds)
+                        : mBounds(bounds), mOffset(0), mCount(0)
+                    { }
+
+                    BoundsType mBounds;
+                    // leaf: block index, inner: right child index
+                    uint32_t mOffset;
+                    // leaf: triangle count, inner: 0
+                    uint32_t mCount;
+            };
+
+            void Build(const std::vector<TriangleType>& triangles);
+            uint32_t BuildNode(
+                const std::vector<TriangleType>& triangles,
+                const std::vector<BoundsType>& bounds,
+                uint32_t* ids, size_t count);
+
+            std::vector<Node> mNodes;
+            std::vector<BlockType> mBlocks;
+    };
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template <typename Scalar>
+    TriangleBVH<Scalar>::TriangleBVH(const std::vector<TriangleType>& triangles)
+    {
+        Build( triangles );
+    }
+
+    template <typename Scalar>
+    TriangleBVH<Scalar>::TriangleBVH(const IndexedMesh<Scalar>& mesh)
+    {
+        std::vector<TriangleType> triangles;
+        triangles.reserve( mesh.GetFaceCount() );
+        for (size_t f=0;f!=mesh.GetFaceCount();++f)
+            triangles.push_back( mesh.GetFace(f) );
+        Build( triangles );
+    }
+
+    template <typename Scalar>
+    size_t TriangleBVH<Scalar>::GetNodeCount() const
+    {
+        return mNodes.size();
+    }
+
+    template <typename Scalar>
+    const typename TriangleBVH<Scalar>::BoundsType& TriangleBVH<Scalar>::GetBounds() const
+    {
+        assert( !mNodes.empty() );
+        return mNodes[0].mBounds;
+    }
+
+    template <typename Scalar>
+    size_t TriangleBVH<Scalar>::GetNodeMemory() const
+    {
+        return mNodes.size() * sizeof(Node);
+    }
+
+    template <typename Scalar>
+    const typename TriangleBVH<Scalar>::BoundsType& TriangleBVH<Scalar>::GetNodeBounds(size_t node) const
+    {
+        assert( node<mNodes.size() );
+        return mNodes[node].mBounds;
+    }
+
+    template <typename Scalar>
+    bool TriangleBVH<Scalar>::IsLeaf(size_t node) const
+    {
+        assert( node<mNodes.size() );
+        return mNodes[node].mCount!=0;
+    }
+
+    template <typename Scalar>
+    size_t TriangleBVH<Scalar>::GetLeftChild(size_t node) const
+    {
+        assert( !IsLeaf(node) );
+        return node+1;
+    }
+
+    template <typename Scalar>
+    size_t TriangleBVH<Scalar>::GetRightChild(size_t node) const
+    {
+        assert( !IsLeaf(node) );
+        return mNodes[node].mOffset;
+    }
+
+    template <typename Scalar>
+    const typename TriangleBVH<Scalar>::BlockType& TriangleBVH<Scalar>::GetLeafBlock(size_t node) const
+    {
+        assert( IsLeaf(node) );
+        return mBlocks[mNodes[node].mOffset];
+    }
+
+    template <typename Scalar>
+    void TriangleBVH<Scalar>::Build(const std::vector<TriangleType>& triangles)
+    {
+        if (triangles.empty()) return;
+
+        std::vector<BoundsType> bounds;
+        std::vector<uint32_t> ids;
+        bounds.reserve( triangles.size() );
+        ids.reserve( triangles.size() );
+        for (size_t i=0;i!=triangles.size();++i)
+        {
+            BoundsType b( triangles[i].GetA() );
+            b.ExpandToContain( triangles[i].GetB() );
+            b.ExpandToContain( triangles[i].GetC() );
+            bounds.push_back( b );
+            ids.push_back( uint32_t(i) );
+        }
+
+        mNodes.reserve( 2 * (triangles.size() / BlockType::sWidth + 1) );
+        mBlocks.reserve( triangles.size() / BlockType::sWidth + 1 );
+        BuildNode( triangles, bounds, ids.data(), ids.size() );
+    }
+
+    template <typename Scalar>
+    uint32_t TriangleBVH<Scalar>::BuildNode(
+        const std::vector<TriangleType>& triangles,
+        const std::vector<BoundsType>& bounds,
+        uint32_t* ids, size_t count)
+    {
+        assert( count > 0 );
+        BoundsType nodeBounds( bounds[ids[0]] );
+        BoundsType centroidBounds( bounds[ids[0]].GetCenter() );
+        for (size_t i=1;i!=count;++i)
+        {
+            nodeBounds.ExpandToContain( bounds[ids[i]] );
+            centroidBounds.ExpandToContain( bounds[ids[i]].GetCenter() );
+        }
+
+        const uint32_t index = uint32_t(mNodes.size());
+        mNodes.push_back( Node(nodeBounds) );
+
+        if (count <= BlockType::sWidth)
+        {
+            BlockType block;
+            for (size_t i=0;i!=count;++i)
+                block.Add( triangles[ids[i]], ids[i] );
+            mNodes[index].mOffset = uint32_t(mBlocks.size());
+            mNodes[index].mCount = uint32_t(count);
+            mBlocks.push_back( block );
+            return index;
+        }
+
+        size_t axis = 0;
+        for (size_t d=1;d!=3;++d)
+        {
+            if (centroidBounds.GetAxisExtent(d) > centroidBounds.GetAxisExtent(axis))
+                axis = d;
+        }
+
+        const size_t mid = count / 2;
+        std::nth_element( ids, ids+mid, ids+count,
+            [&bounds, axis](uint32_t a, uint32_t b) {
+                return bounds[a].GetCenter()[axis] < bounds[b].GetCenter()[axis];
+            } );
+
+        BuildNode( triangles, bounds, ids, mid );
+        const uint32_t right = BuildNode( triangles, bounds, ids+mid, count-mid );
+        mNodes[index].mOffset = right;
+        return index;
+    }
+
+    template <typename Scalar>
+    bool TriangleBVH<Scalar>::ClosestHit(const RayType& ray, HitType* hit) const
+    {
+        assert( hit );
+        Scalar tEntry;
+        if (mNodes.empty() || !ray.Intersection( mNodes[0].mBounds, hit->mDistance, &tEntry ))
+            return false;
+
+        // median splits keep the depth well under this for any 32 bit triangle count
+        uint32_t stack[64];
+        Scalar stackDistance[64];
+        size_t top = 0;
+        stack[top] = 0;
+        stackDistance[top++] = tEntry;
+
+        bool result = false;
+        while (top)
+        {
+            --top;
+            const uint32_t index = stack[top];
+            // the hit may have moved closer since this was pushed
+            if (stackDistance[top] > hit->mDistance)
+                continue;
+
+            const Node& node = mNodes[index];
+            if (node.mCount)
+            {
+                result |= mBlocks[node.mOffset].Intersection( ray, hit );
+                continue;
+            }
+
+            // visit the nearer child first so the far one is more likely to be culled
+            const uint32_t left = index + 1;
+            const uint32_t right = node.mOffset;
+            Scalar tLeft, tRight;
+            const bool hitLeft = ray.Intersection( mNodes[left].mBounds, hit->mDistance, &tLeft );
+            const bool hitRight = ray.Intersection( mNodes[right].mBounds, hit->mDistance, &tRight );
+            if (hitLeft && hitRight)
+            {
+                if (tLeft < tRight)
+                {
+                    stack[top] = right;
+                    stackDistance[top++] = tRight;
+                    stack[top] = left;
+                    stackDistance[top++] = tLeft;
+                }
+                else
+                {
+                    stack[top] = left;
+                    stackDistance[top++] = tLeft;
+                    stack[top] = right;
+                    stackDistance[top++] = tRight;
+                }
+            }
+            else if (hitLeft)
+            {
+                stack[top] = left;
+                stackDistance[top++] = tLeft;
+            }
+            else if (hitRight)
+            {
+                stack[top] = right;
+                stackDistance[top++] = tRight;
+            }
+            assert( top <= 64 );
+        }
+        return result;
+    }
+
+    template <typename Scalar>
+    bool TriangleBVH<Scalar>::AnyHit(const RayType& ray, Scalar tMax) const
+    {
+        if (mNodes.empty()) return false;
+
+        uint32_t stack[64];
+        size_t top = 0;
+        stack[top++] = 0;
+
+        while (top)
+        {
+            const uint32_t index = stack[--top];
+            const Node& node = mNodes[index];
+            if (!ray.Intersects( node.mBounds, tMax ))
+                continue;
+
+            if (node.mCount)
+            {
+                if (mBlocks[node.mOffset].Intersects( ray, tMax ))
+                    return true;
+                continue;
+            }
+
+            stack[top++] = node.mOffset;
+            stack[top++] = index + 1;
+            assert( top <= 64 );
+        }
+        return false;
+    }
+}
+
+#endif//GEOMETRY_BVH_H_INCLUDED_
@@ -0,0 +1,307 @@
+#ifndef GEOMETRY_CONVEX_HULL_H_INCLUDED_
+#define GEOMETRY_CONVEX_HULL_H_INCLUDED_
+
+#include "vector2d.h"
+#include "parallel.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Free-functions
+    //
+
+    // twice the signed area of abc, positive when c is left of a->b as with
+    // Line2d::Side, evaluated exactly from the coordinates as doubles.
+    // ax*by - ax*cy - ay*bx + ay*cx + bx*cy - by*cx, each product split into
+    // its rounded value and error and the twelve terms summed as a
+    // nonoverlapping expansion (Shewchuk, "Adaptive precision floating-point
+    // arithmetic and fast robust geometric predicates", 1997). only the sign
+    // and rough magnitude of the result are meaningful
+    inline double Orient2dExact(double ax, double ay, double bx, double by, double cx, double cy)
+    {
+        const double factors[6][2] = {
+            { ax, by }, { -ax, cy }, { -ay, bx }, { ay, cx }, { bx, cy }, { -by, cx } };
+
+        // components in increasing magnitude, zeros left out
+        double e[12];
+        int n = 0;
+        for (int t=0;t!=6;++t)
+        {
+            const double product = factors[t][0] * factors[t][1];
+            const double terms[2] = { std::fma( factors[t][0], factors[t][1], -product ), product };
+            for (int k=0;k!=2;++k)
+            {
+                double q = terms[k];
+                int m = 0;
+                for (int i=0;i!=n;++i)
+                {
+                    const double sum = q + e[i];
+                    const double virtualB = sum - q;
+                    const double error = (q - (sum - virtualB)) + (e[i] - virtualB);
+                    q = sum;
+                    if (error!=0)
+                        e[m++] = error;
+                }
+                if (q!=0)
+                    e[m++] = q;
+                n = m;
+            }
+        }
+        return n ? e[n-1] : 0;
+    }
+
+    // as Orient2dExact, but only falls back on it when the plain determinant
+    // is too close to zero for its sign to be trusted
+    inline double Orient2d(double ax, double ay, double bx, double by, double cx, double cy)
+    {
+        const double left = (bx - ax) * (cy - ay);
+        const double right = (by - ay) * (cx - ax);
+        const double det = left - right;
+        // (3 + 16 epsilon) epsilon, the bound on the error of det
+        const double bound = 3.3306690738754716e-16 * (Fabs( left ) + Fabs( right ));
+        if (det > bound || -det > bound)
+            return det;
+        return Orient2dExact( ax, ay, bx, by, cx, cy );
+    }
+
+    template< typename Scalar >
+    double Orient2d(const VectorN<Scalar, 2>& a, const VectorN<Scalar, 2>& b, const VectorN<Scalar, 2>& c)
+    {
+        return Orient2d(
+            double( a[0] ), double( a[1] ),
+            double( b[0] ), double( b[1] ),
+            double( c[0] ), double( c[1] ) );
+    }
+
+    // Andrew's monotone chain over points[order(0)] ... points[order(count-1)],
+    // which must be sorted by x then y. see ComputeSortedConvexHull
+    template< typename iterator, typename Order >
+    void ComputeMonotoneChain(iterator points, Order order, size_t count, std::vector<uint32_t>& hull)
+    {
+        hull.clear();
+        if (count==0)
+            return;
+        if (count==1)
+        {
+            hull.push_back( uint32_t( order( 0 ) ) );
+            return;
+        }
+
+        auto turnsLeft = [&](uint32_t c) {
+            const size_t n = hull.size();
+            return Orient2d( points[hull[n-2]], points[hull[n-1]], points[c] ) > 0;
+        };
+
+        // lower chain left to right, then the upper one back again
+        for (size_t i=0;i!=count;++i)
+        {
+            const uint32_t c = uint32_t( order( i ) );
+            while (hull.size()>=2 && !turnsLeft( c ))
+                hull.pop_back();
+            hull.push_back( c );
+        }
+        const size_t lower = hull.size() + 1;
+        for (size_t i=count-1;i--!=0;)
+        {
+            const uint32_t c = uint32_t( order( i ) );
+            while (hull.size()>=lower && !turnsLeft( c ))
+                hull.pop_back();
+            hull.push_back( c );
+        }
+        hull.pop_back();
+
+        // every point the same
+        if (hull.size()==2 && points[hull[0]]==points[hull[1]])
+            hull.pop_back();
+    }
+
+    // indices into [first,last) of the convex hull vertices, counterclockwise
+    // from the lowest of the leftmost points. [first,last) must be sorted by
+    // x then y. points on an edge are left out, all points the same leaves
+    // one index and all points on a line its two ends
+    template< typename iterator >
+    void ComputeSortedConvexHull(iterator first, iterator last, std::vector<uint32_t>& hull)
+    {
+        const size_t count = size_t( last - first );
+        assert( count <= size_t( UINT32_MAX ) );
+        ComputeMonotoneChain( first, [](size_t i) { return i; }, count, hull );
+    }
+
+    // as ComputeSortedConvexHull, for points in any order. the points
+    // extreme in x, y, x+y and x-y make an octagon inside the hull, and the
+    // points strictly inside it are dropped in one parallel pass (Akl and
+    // Toussaint, 1978). the rest go to the first octagon edge they are
+    // outside of, and each edge runs quickhull over its own points in a task
+    // of its own. the few vertices found are then sorted and passed through
+    // the monotone chain, which settles ties and collinear points exactly.
+    // the result does not depend on the policy
+    template< typename iterator >
+    void ComputeConvexHull(iterator first, iterator last, std::vector<uint32_t>& hull,
+        const ExecutionPolicy& policy = ExecutionPolicy())
+    {
+        const size_t count = size_t( last - first );
+        assert( count <= size_t( UINT32_MAX ) );
+        hull.clear();
+        if (count==0)
+            return;
+
+        // the octagon counterclockwise from the left: least x, x+y, y, y-x,
+        // -x, -x-y, -y, x-y. the first point wins a tie
+        struct Octagon
+        {
+            uint32_t mIndex[8];
+            double mKey[8];
+        };
+        auto keysOf = [&](size_t i, double key[8]) {
+            const double x = double( first[i][0] );
+            const double y = double( first[i][1] );
+            key[0] = x;      key[1] = x + y;
+            key[2] = y;      key[3] = y - x;
+            key[4] = -x;     key[5] = -x - y;
+            key[6] = -y;     key[7] = x - y;
+        };
+        Octagon identity;
+        keysOf( 0, identity.mKey );
+        std::fill( identity.mIndex, identity.mIndex+8, uint32_t(0) );
+
+        const Octagon extremes = ParallelReduce( policy, 1, count, identity,
+            [&](size_t begin, size_t end) {
+                Octagon o = identity;
+                double key[8];
+                for (size_t i=begin;i!=end;++i)
+                {
+                    keysOf( i, key );
+                    for (int k=0;k!=8;++k)
+                    {
+                        if (key[k] < o.mKey[k])
+                        {
+                            o.mKey[k] = key[k];
+                            o.mIndex[k] = uint32_t( i );
+                        }
+                    }
+                }
+                return o;
+            },
+            [](const Octagon& a, const Octagon& b) {
+                Octagon o = a;
+                for (int k=0;k!=8;++k)
+                {
+                    if (b.mKey[k] < a.mKey[k])
+                    {
+                        o.mKey[k] = b.mKey[k];
+                        o.mIndex[k] = b.mIndex[k];
+                    }
+                }
+                return o;
+            } );
+
+        std::vector<uint32_t> corners;
+        for (int k=0;k!=8;++k)
+        {
+            const uint32_t c = extremes.mIndex[k];
+            if (std::find( corners.begin(), corners.end(), c )==corners.end())
+                corners.push_back( c );
+        }
+        const size_t edges = corners.size();
+
+        // per chunk and edge lists of the points outside that edge
+        const size_t grain = policy.GetGrain();
+        const size_t chunks = (count + grain - 1) / grain;
+        std::vector< std::vector<uint32_t> > outside( chunks*edges );
+        ParallelForChunks( policy, 0, count, [&](size_t chunk, size_t begin, size_t end) {
+            std::vector<uint32_t>* lists = &outside[chunk*edges];
+            for (size_t i=begin;i!=end;++i)
+            {
+                for (size_t e=0;e!=edges;++e)
+                {
+                    const uint32_t a = corners[e];
+                    const uint32_t b = corners[(e+1)%edges];
+                    if (Orient2d( first[a], first[b], first[i] ) < 0)
+                    {
+                        lists[e].push_back( uint32_t( i ) );
+                        break;
+                    }
+                }
+            }
+        } );
+
+        struct Task
+        {
+            uint32_t mA, mB;
+            size_t mBegin, mEnd;
+        };
+        std::vector< std::vector<uint32_t> > found( edges );
+        ParallelForChunks( policy.WithGrain( 1 ), 0, edges, [&](size_t e, size_t, size_t) {
+            std::vector<uint32_t> points;
+            for (size_t chunk=0;chunk!=chunks;++chunk)
+            {
+                const std::vector<uint32_t>& list = outside[chunk*edges+e];
+                points.insert( points.end(), list.begin(), list.end() );
+            }
+
+            // each task holds points strictly right of a->b in its range
+            std::vector<Task> stack;
+            stack.push_back( Task{ corners[e], corners[(e+1)%edges], 0, points.size() } );
+            while (!stack.empty())
+            {
+                const Task task = stack.back();
+                stack.pop_back();
+                if (task.mBegin==task.mEnd)
+                    continue;
+
+                const auto& a = first[task.mA];
+                const auto& b = first[task.mB];
+                uint32_t farthest = points[task.mBegin];
+                double distance = 0;
+                for (size_t i=task.mBegin;i!=task.mEnd;++i)
+                {
+                    const double d = -Orient2d( a, b, first[points[i]] );
+                    if (d > distance)
+                    {
+                        distance = d;
+                        farthest = points[i];
+                    }
+                }
+                found[e].push_back( farthest );
+
+                // those outside a->p to the front, then those outside p->b,
+                // the rest are inside the triangle or on its edges
+                const auto& p = first[farthest];
+                size_t split = task.mBegin;
+                for (size_t i=task.mBegin;i!=task.mEnd;++i)
+                {
+                    if (Orient2d( a, p, first[points[i]] ) < 0)
+                        std::swap( points[i], points[split++] );
+                }
+                size_t end = split;
+                for (size_t i=split;i!=task.mEnd;++i)
+                {
+                    if (Orient2d( p, b, first[points[i]] ) < 0)
+                        std::swap( points[i], points[end++] );
+                }
+                stack.push_back( Task{ task.mA, farthest, task.mBegin, split } );
+                stack.push_back( Task{ farthest, task.mB, split, end } );
+            }
+        } );
+
+        std::vector<uint32_t> candidates( corners );
+        for (size_t e=0;e!=edges;++e)
+            candidates.insert( candidates.end(), found[e].begin(), found[e].end() );
+        std::sort( candidates.begin(), candidates.end(), [&](uint32_t i, uint32_t j) {
+            const auto& p = first[i];
+            const auto& q = first[j];
+            if (p[0]!=q[0]) return p[0] < q[0];
+            if (p[1]!=q[1]) return p[1] < q[1];
+            return i < j;
+        } );
+        ComputeMonotoneChain( first, [&](size_t i) { return candidates[i]; }, candidates.size(), hull );
+    }
+}
+
+#endif//GEOMETRY_CONVEX_HULL_H_INCLUDED_
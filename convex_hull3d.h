@@ -0,0 +1,558 @@
+#ifndef GEOMETRY_CONVEX_HULL3D_H_INCLUDED_
+#define GEOMETRY_CONVEX_HULL3D_H_INCLUDED_
+
+#include "vector3d.h"
+#include "triangle3d.h"
+#include "parallel.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // quickhull in 3D (Barber, Dobkin and Huhdanpaa, 1996). starting from a
+    // tetrahedron of extreme points, each face keeps a conflict list of the
+    // points above it, and the farthest point of some face is added in turn:
+    // the faces it sees are removed and the horizon they leave is fanned to
+    // it. the conflict lists are threaded through one next pointer per
+    // point, and removed faces are reused, so a build allocates nothing once
+    // warmed up. a point within GetTolerance of a face plane counts as on
+    // it, which keeps near coplanar input from folding the hull over; the
+    // faces come out as triangles, coplanar ones are not merged
+    template <typename Scalar>
+    class ConvexHull3d
+    {
+        public:
+            typedef Vector3d<Scalar> VectorType;
+            typedef Triangle3d<Scalar> TriangleType;
+
+            const static uint32_t sNone = 0xffffffffu;
+
+            // empty
+            ConvexHull3d();
+
+            explicit ConvexHull3d(const std::vector<VectorType>& points,
+                const ExecutionPolicy& policy = ExecutionPolicy());
+
+            // false, leaving the hull empty, if the points are too flat to
+            // span a volume, or if rounding on near coplanar input leaves the
+            // faces some point sees without one simple loop round them, which
+            // could not be fanned without breaking the adjacency. the policy
+            // only spreads the first pass over the points
+            bool Build(const std::vector<VectorType>& points,
+                const ExecutionPolicy& policy = ExecutionPolicy());
+
+            size_t GetFaceCount() const;
+
+            // three point indices a face, counterclockwise seen from outside
+            const std::vector<uint32_t>& GetIndices() const;
+
+            // three face indices a face, the one across edge k, which runs
+            // from index k of the face to index k+1
+            const std::vector<uint32_t>& GetAdjacency() const;
+
+            TriangleType GetTriangle(const std::vector<VectorType>& points, size_t face) const;
+
+            // sorted indices of the points used by the faces
+            void ComputeVertices(std::vector<uint32_t>& result) const;
+
+            double GetTolerance() const;
+
+        private:
+            class Face
+            {
+                public:
+                    uint32_t mVertex[3];
+                    uint32_t mAdjacent[3];
+                    double mNormal[3];
+                    double mOffset;
+                    // head of the conflict list and the point farthest above
+                    uint32_t mConflict;
+                    uint32_t mFarthest;
+                    double mFarthestDistance;
+                    bool mAlive;
+                    bool mVisible;
+            };
+
+            class Step
+            {
+                public:
+                    uint32_t mFace;
+                    uint32_t mFirstEdge;
+                    uint32_t mCount;
+            };
+
+            uint32_t AddFace(const std::vector<VectorType>& points, uint32_t a, uint32_t b, uint32_t c);
+            void AddConflict(uint32_t face, uint32_t point, double distance);
+            double Distance(const Face& face, const VectorType& p) const;
+            bool FindSimplex(const std::vector<VectorType>& points, uint32_t simplex[4]) const;
+            bool AddPoint(const std::vector<VectorType>& points, uint32_t face);
+            bool IsHorizonLoop();
+
+            std::vector<Face> mFaces;
+            std::vector<uint32_t> mFreeFaces;
+            std::vector<uint32_t> mNext;
+            double mTolerance;
+
+            // scratch kept between builds
+            std::vector<Step> mStack;
+            std::vector<uint32_t> mVisible;
+            std::vector<uint32_t> mHorizon;
+            std::vector<uint32_t> mNewFaces;
+            std::vector<uint32_t> mPending;
+            std::vector<uint32_t> mLoop;
+
+            std::vector<uint32_t> mIndices;
+            std::vector<uint32_t> mAdjacency;
+    };
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template <typename Scalar>
+    ConvexHull3d<Scalar>::ConvexHull3d()
+        : mTolerance(0)
+    {
+        static_assert( std::is_floating_point<Scalar>::value, "the hull needs a floating point type" );
+    }
+
+    template <typename Scalar>
+    ConvexHull3d<Scalar>::ConvexHull3d(const std::vector<VectorType>& points, const ExecutionPolicy& policy)
+        : mTolerance(0)
+    {
+        Build( points, policy );
+    }
+
+    template <typename Scalar>
+    bool ConvexHull3d<Scalar>::Build(const std::vector<VectorType>& points, const ExecutionPolicy& policy)
+    {
+        assert( points.size() < size_t(sNone) );
+        mFaces.clear();
+        mFreeFaces.clear();
+        mIndices.clear();
+        mAdjacency.clear();
+
+        // rounding in the plane tests grows with the size of the coordinates
+        double extent[3] = { 0, 0, 0 };
+        for (const VectorType& p : points)
+        {
+            for (size_t d=0;d!=3;++d)
+                extent[d] = std::max( extent[d], double( Fabs( p[d] ) ) );
+        }
+        mTolerance = 3 * (extent[0] + extent[1] + extent[2]) * std::numeric_limits<Scalar>::epsilon();
+
+        uint32_t simplex[4] = {};
+        if (!FindSimplex( points, simplex ))
+            return false;
+
+        // d below abc, every face counterclockwise from outside
+        const uint32_t a = simplex[0], b = simplex[1], c = simplex[2], d = simplex[3];
+        AddFace( points, a, b, c );
+        AddFace( points, b, a, d );
+        AddFace( points, c, b, d );
+        AddFace( points, a, c, d );
+        for (uint32_t f=0;f!=4;++f)
+        {
+            for (uint32_t k=0;k!=3;++k)
+            {
+                const uint32_t from = mFaces[f].mVertex[k];
+                const uint32_t to = mFaces[f].mVertex[(k+1)%3];
+                for (uint32_t g=0;g!=4;++g)
+                {
+                    for (uint32_t j=0;j!=3;++j)
+                    {
+                        if (mFaces[g].mVertex[j]==to && mFaces[g].mVertex[(j+1)%3]==from)
+                            mFaces[f].mAdjacent[k] = g;
+                    }
+                }
+            }
+        }
+
+        // each point to the first face it is above, inner points nowhere
+        const size_t count = points.size();
+        std::vector<uint32_t> owner( count );
+        ParallelFor( policy, 0, count, [&](size_t first, size_t last) {
+            for (size_t i=first;i!=last;++i)
+            {
+                owner[i] = sNone;
+                for (uint32_t f=0;f!=4;++f)
+                {
+                    if (Distance( mFaces[f], points[i] ) > mTolerance)
+                    {
+                        owner[i] = f;
+                        break;
+                    }
+                }
+            }
+        } );
+        mNext.assign( count, uint32_t(sNone) );
+        for (size_t i=0;i!=count;++i)
+        {
+            if (owner[i]!=sNone && i!=a && i!=b && i!=c && i!=d)
+                AddConflict( owner[i], uint32_t(i), Distance( mFaces[owner[i]], points[i] ) );
+        }
+
+        mPending.assign( { 0, 1, 2, 3 } );
+        while (!mPending.empty())
+        {
+            const uint32_t f = mPending.back();
+            mPending.pop_back();
+            if (mFaces[f].mAlive && mFaces[f].mConflict!=sNone && !AddPoint( points, f ))
+            {
+                mFaces.clear();
+                mFreeFaces.clear();
+                mPending.clear();
+                return false;
+            }
+        }
+
+        // compact the surviving faces
+        std::vector<uint32_t> remap( mFaces.size(), uint32_t(sNone) );
+        uint32_t faces = 0;
+        for (size_t f=0;f!=mFaces.size();++f)
+        {
+            if (mFaces[f].mAlive)
+                remap[f] = faces++;
+        }
+        mIndices.reserve( faces*3 );
+        mAdjacency.reserve( faces*3 );
+        for (const Face& face : mFaces)
+        {
+            if (!face.mAlive)
+                continue;
+            for (size_t k=0;k!=3;++k)
+            {
+                mIndices.push_back( face.mVertex[k] );
+                mAdjacency.push_back( remap[face.mAdjacent[k]] );
+            }
+        }
+        return true;
+    }
+
+    template <typename Scalar>
+    size_t ConvexHull3d<Scalar>::GetFaceCount() const
+    {
+        return mIndices.size()/3;
+    }
+
+    template <typename Scalar>
+    const std::vector<uint32_t>& ConvexHull3d<Scalar>::GetIndices() const
+    {
+        return mIndices;
+    }
+
+    template <typename Scalar>
+    const std::vector<uint32_t>& ConvexHull3d<Scalar>::GetAdjacency() const
+    {
+        return mAdjacency;
+    }
+
+    template <typename Scalar>
+    typename ConvexHull3d<Scalar>::TriangleType ConvexHull3d<Scalar>::GetTriangle(
+        const std::vector<VectorType>& points, size_t face) const
+    {
+        assert( face < GetFaceCount() );
+        return TriangleType( points[mIndices[face*3]], points[mIndices[face*3+1]], points[mIndices[face*3+2]] );
+    }
+
+    template <typename Scalar>
+    void ConvexHull3d<Scalar>::ComputeVertices(std::vector<uint32_t>& result) const
+    {
+        result = mIndices;
+        std::sort( result.begin(), result.end() );
+        result.erase( std::unique( result.begin(), result.end() ), result.end() );
+    }
+
+    template <typename Scalar>
+    double ConvexHull3d<Scalar>::GetTolerance() const
+    {
+        return mTolerance;
+    }
+
+    template <typename Scalar>
+    uint32_t ConvexHull3d<Scalar>::AddFace(const std::vector<VectorType>& points, uint32_t a, uint32_t b, uint32_t c)
+    {
+        uint32_t f;
+        if (mFreeFaces.empty())
+        {
+            f = uint32_t( mFaces.size() );
+            mFaces.emplace_back();
+        }
+        else
+        {
+            f = mFreeFaces.back();
+            mFreeFaces.pop_back();
+        }
+
+        Face& face = mFaces[f];
+        face.mVertex[0] = a;
+        face.mVertex[1] = b;
+        face.mVertex[2] = c;
+        for (size_t k=0;k!=3;++k)
+            face.mAdjacent[k] = sNone;
+        face.mConflict = sNone;
+        face.mFarthest = sNone;
+        face.mFarthestDistance = 0;
+        face.mAlive = true;
+        face.mVisible = false;
+
+        const VectorType& pa = points[a];
+        const Vector3d<double> ab( double( points[b][0] ) - pa[0], double( points[b][1] ) - pa[1], double( points[b][2] ) - pa[2] );
+        const Vector3d<double> ac( double( points[c][0] ) - pa[0], double( points[c][1] ) - pa[1], double( points[c][2] ) - pa[2] );
+        const Vector3d<double> normal = CrossProduct( ab, ac );
+        const double length = normal.Length();
+        // a sliver with no normal has nothing above it
+        const double scale = length > 0 ? 1/length : 0;
+        face.mOffset = 0;
+        for (size_t d=0;d!=3;++d)
+        {
+            face.mNormal[d] = normal[d] * scale;
+            face.mOffset += face.mNormal[d] * double( pa[d] );
+        }
+        return f;
+    }
+
+    template <typename Scalar>
+    void ConvexHull3d<Scalar>::AddConflict(uint32_t f, uint32_t point, double distance)
+    {
+        Face& face = mFaces[f];
+        mNext[point] = face.mConflict;
+        face.mConflict = point;
+        if (face.mFarthest==sNone || distance > face.mFarthestDistance)
+        {
+            face.mFarthest = point;
+            face.mFarthestDistance = distance;
+        }
+    }
+
+    template <typename Scalar>
+    double ConvexHull3d<Scalar>::Distance(const Face& face, const VectorType& p) const
+    {
+        return face.mNormal[0]*double( p[0] ) + face.mNormal[1]*double( p[1] ) + face.mNormal[2]*double( p[2] ) - face.mOffset;
+    }
+
+    template <typename Scalar>
+    bool ConvexHull3d<Scalar>::FindSimplex(const std::vector<VectorType>& points, uint32_t simplex[4]) const
+    {
+        if (points.size()<4)
+            return false;
+        auto toDouble = [&](uint32_t i) {
+            return Vector3d<double>( double( points[i][0] ), double( points[i][1] ), double( points[i][2] ) );
+        };
+
+        // the two farthest apart of the points extreme along an axis
+        uint32_t extremes[6] = { 0, 0, 0, 0, 0, 0 };
+        for (uint32_t i=1;i!=points.size();++i)
+        {
+            for (size_t d=0;d!=3;++d)
+            {
+                if (points[i][d] < points[extremes[d*2]][d])
+                    extremes[d*2] = i;
+                if (points[i][d] > points[extremes[d*2+1]][d])
+                    extremes[d*2+1] = i;
+            }
+        }
+        double best = 0;
+        for (size_t i=0;i!=6;++i)
+        {
+            for (size_t j=i+1;j!=6;++j)
+            {
+                const double distance = Vector3d<double>( toDouble( extremes[i] ) - toDouble( extremes[j] ) ).LengthSquare();
+                if (distance > best)
+                {
+                    best = distance;
+                    simplex[0] = extremes[i];
+                    simplex[1] = extremes[j];
+                }
+            }
+        }
+        if (!(Sqrt( best ) > mTolerance))
+            return false;
+
+        // then the farthest from their line, and from the plane of all three
+        const Vector3d<double> a = toDouble( simplex[0] );
+        const Vector3d<double> ab( toDouble( simplex[1] ) - a );
+        best = 0;
+        for (uint32_t i=0;i!=points.size();++i)
+        {
+            const double distance = CrossProduct( ab, Vector3d<double>( toDouble( i ) - a ) ).LengthSquare();
+            if (distance > best)
+            {
+                best = distance;
+                simplex[2] = i;
+            }
+        }
+        if (!(Sqrt( best )/ab.Length() > mTolerance))
+            return false;
+
+        Vector3d<double> normal = CrossProduct( ab, Vector3d<double>( toDouble( simplex[2] ) - a ) );
+        normal.Normalise();
+        best = 0;
+        double side = 0;
+        for (uint32_t i=0;i!=points.size();++i)
+        {
+            const double distance = DotProduct( normal, Vector3d<double>( toDouble( i ) - a ) );
+            if (Fabs( distance ) > best)
+            {
+                best = Fabs( distance );
+                side = distance;
+                simplex[3] = i;
+            }
+        }
+        if (!(best > mTolerance))
+            return false;
+        if (side > 0)
+            std::swap( simplex[1], simplex[2] );
+        return true;
+    }
+
+    // the horizon edges, each starting where the last ended and every vertex
+    // met once
+    template <typename Scalar>
+    bool ConvexHull3d<Scalar>::IsHorizonLoop()
+    {
+        const size_t count = mHorizon.size();
+        if (count<3)
+            return false;
+        mLoop.clear();
+        for (size_t i=0;i!=count;++i)
+        {
+            const Face& face = mFaces[mHorizon[i]/3];
+            const uint32_t k = mHorizon[i]%3;
+            const Face& next = mFaces[mHorizon[(i+1)%count]/3];
+            if (face.mVertex[(k+1)%3]!=next.mVertex[mHorizon[(i+1)%count]%3])
+                return false;
+            mLoop.push_back( face.mVertex[k] );
+        }
+        std::sort( mLoop.begin(), mLoop.end() );
+        return std::adjacent_find( mLoop.begin(), mLoop.end() )==mLoop.end();
+    }
+
+    template <typename Scalar>
+    bool ConvexHull3d<Scalar>::AddPoint(const std::vector<VectorType>& points, uint32_t start)
+    {
+        const uint32_t eye = mFaces[start].mFarthest;
+        const VectorType& p = points[eye];
+
+        // depth first over the faces the eye sees. each face's edges are
+        // taken in order from the one it was entered by, so the horizon
+        // edges come out as a loop, each starting where the last ended
+        mVisible.clear();
+        mHorizon.clear();
+        mStack.clear();
+        mFaces[start].mVisible = true;
+        mVisible.push_back( start );
+        mStack.push_back( Step{ start, 0, 0 } );
+        while (!mStack.empty())
+        {
+            Step& step = mStack.back();
+            if (step.mCount==3)
+            {
+                mStack.pop_back();
+                continue;
+            }
+            const uint32_t f = step.mFace;
+            const uint32_t k = (step.mFirstEdge + step.mCount++) % 3;
+            const uint32_t n = mFaces[f].mAdjacent[k];
+            if (mFaces[n].mVisible)
+                continue;
+            if (Distance( mFaces[n], p ) > mTolerance)
+            {
+                mFaces[n].mVisible = true;
+                mVisible.push_back( n );
+                uint32_t back = 0;
+                while (mFaces[n].mAdjacent[back]!=f)
+                    ++back;
+                // step is invalidated by the push
+                mStack.push_back( Step{ n, back, 0 } );
+            }
+            else
+            {
+                mHorizon.push_back( f*3 + k );
+            }
+        }
+
+        // checked before anything is changed, a horizon that is not one
+        // loop would fan to faces that do not close up
+        if (!IsHorizonLoop())
+            return false;
+
+        // fan the horizon to the eye, each new face across its horizon
+        // edge from the face that stays, and between the new faces before
+        // and after it
+        mNewFaces.clear();
+        for (uint32_t edge : mHorizon)
+        {
+            const Face& visible = mFaces[edge/3];
+            const uint32_t k = edge%3;
+            const uint32_t a = visible.mVertex[k];
+            const uint32_t b = visible.mVertex[(k+1)%3];
+            const uint32_t across = visible.mAdjacent[k];
+            // the visible faces are only freed below, so this is a new slot
+            const uint32_t f = AddFace( points, a, b, eye );
+            mFaces[f].mAdjacent[0] = across;
+            Face& other = mFaces[across];
+            for (size_t j=0;j!=3;++j)
+            {
+                if (other.mAdjacent[j]==edge/3 && other.mVertex[j]==b)
+                    other.mAdjacent[j] = f;
+            }
+            mNewFaces.push_back( f );
+        }
+        const size_t fan = mNewFaces.size();
+        for (size_t i=0;i!=fan;++i)
+        {
+            Face& face = mFaces[mNewFaces[i]];
+            face.mAdjacent[1] = mNewFaces[(i+1)%fan];
+            face.mAdjacent[2] = mNewFaces[(i+fan-1)%fan];
+        }
+
+        // hand the points the removed faces saw to the new ones, the eye
+        // and points no longer above anything dropping out
+        for (uint32_t f : mVisible)
+        {
+            Face& face = mFaces[f];
+            for (uint32_t i=face.mConflict;i!=sNone;)
+            {
+                const uint32_t next = mNext[i];
+                if (i!=eye)
+                {
+                    for (uint32_t n : mNewFaces)
+                    {
+                        const double distance = Distance( mFaces[n], points[i] );
+                        if (distance > mTolerance)
+                        {
+                            AddConflict( n, i, distance );
+                            break;
+                        }
+                    }
+                }
+                i = next;
+            }
+            face.mAlive = false;
+            face.mVisible = false;
+            face.mConflict = sNone;
+        }
+        for (uint32_t f : mVisible)
+            mFreeFaces.push_back( f );
+        for (uint32_t n : mNewFaces)
+        {
+            if (mFaces[n].mConflict!=sNone)
+                mPending.push_back( n );
+        }
+        return true;
+    }
+}
+
+#endif//GEOMETRY_CONVEX_HULL3D_H_INCLUDED_
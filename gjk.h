@@ -0,0 +1,779 @@
+#ifndef GEOMETRY_GJK_H_INCLUDED_
+#define GEOMETRY_GJK_H_INCLUDED_
+
+#include "vectorn.h"
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // support mappings: GetSupport(d) is a point of the shape farthest along
+    // d, GetCenter any point inside it. GJK and EPA see shapes only through
+    // these, so anything convex with one can be tested against anything else
+
+    // the box between its min and max bounds
+    template< typename AABB >
+    class BoxSupport
+    {
+        public:
+            typedef typename AABB::VectorBase VectorBase;
+
+            explicit BoxSupport(const AABB& box);
+
+            VectorBase GetSupport(const VectorBase& direction) const;
+            VectorBase GetCenter() const;
+
+        private:
+            VectorBase mMin;
+            VectorBase mMax;
+    };
+
+    template< typename Triangle >
+    class TriangleSupport
+    {
+        public:
+            typedef typename Triangle::VectorType::BaseType VectorBase;
+
+            explicit TriangleSupport(const Triangle& triangle);
+
+            VectorBase GetSupport(const VectorBase& direction) const;
+            VectorBase GetCenter() const;
+
+        private:
+            VectorBase mVertex[3];
+    };
+
+    // the convex hull of points the caller keeps alive, searched linearly,
+    // so best given only the hull's vertices
+    template< typename VectorType >
+    class PointSetSupport
+    {
+        public:
+            typedef typename VectorType::BaseType VectorBase;
+
+            PointSetSupport(const VectorType* points, size_t count);
+
+            VectorBase GetSupport(const VectorBase& direction) const;
+            VectorBase GetCenter() const;
+
+        private:
+            const VectorType* mPoints;
+            size_t mCount;
+    };
+
+    template< typename VectorType >
+    class SphereSupport
+    {
+        public:
+            typedef typename VectorType::BaseType VectorBase;
+            typedef typename VectorBase::ScalarType ScalarType;
+
+            SphereSupport(const VectorType& center, ScalarType radius);
+
+            VectorBase GetSupport(const VectorBase& direction) const;
+            VectorBase GetCenter() const;
+
+        private:
+            VectorBase mCenter;
+            ScalarType mRadius;
+    };
+
+    // a point of the difference A-B with the points of A and B it came from
+    // and the direction it was found along
+    template< typename VectorBase >
+    class GjkVertex
+    {
+        public:
+            GjkVertex()
+                : mA(uninitialised), mB(uninitialised), mW(uninitialised), mDirection(uninitialised)
+            { }
+
+            VectorBase mA;
+            VectorBase mB;
+            VectorBase mW;
+            VectorBase mDirection;
+    };
+
+    // the simplex GJK ends on. passed back in for the same pair next frame,
+    // its vertices are found again along their old directions, which for
+    // shapes that moved a little starts the search next to the answer
+    template< typename VectorBase >
+    class GjkSimplex
+    {
+        public:
+            const static size_t sMaxSize = VectorBase::sDimensions+1;
+
+            GjkSimplex() : mSize(0) { }
+
+            void Clear() { mSize = 0; }
+            size_t GetSize() const { return mSize; }
+
+            GjkVertex<VectorBase> mVertex[sMaxSize];
+            size_t mSize;
+    };
+
+    template< typename VectorBase >
+    class GjkResult
+    {
+        public:
+            typedef typename VectorBase::ScalarType ScalarType;
+
+            GjkResult()
+                : mIntersecting(false), mDistance(0), mPenetration(0)
+                , mPointA(ScalarType(0)), mPointB(ScalarType(0)), mNormal(ScalarType(0))
+                , mIterations(0), mConverged(true)
+            { }
+
+            bool mIntersecting;
+            // between the closest points when apart
+            ScalarType mDistance;
+            // how far B must move along mNormal to come apart, from EPA
+            ScalarType mPenetration;
+            // closest points when apart, deepest points when not
+            VectorBase mPointA;
+            VectorBase mPointB;
+            // unit, from A towards B
+            VectorBase mNormal;
+            size_t mIterations;
+            // false when GJK or EPA stopped at maxIterations, which leaves
+            // the distance or depth an estimate
+            bool mConverged;
+    };
+
+    //
+    // Free-functions
+    //
+
+    // the relative tolerance GJK and EPA stop at
+    template< typename Scalar >
+    Scalar GetGjkTolerance()
+    {
+        return 1000 * std::numeric_limits<Scalar>::epsilon();
+    }
+
+    // the point of A-B farthest along direction
+    template< typename ShapeA, typename ShapeB, typename VectorBase >
+    void ComputeGjkVertex(const ShapeA& a, const ShapeB& b, const VectorBase& direction, GjkVertex<VectorBase>& vertex)
+    {
+        vertex.mDirection = direction;
+        vertex.mA = a.GetSupport( direction );
+        vertex.mB = b.GetSupport( -direction );
+        vertex.mW = vertex.mA - vertex.mB;
+    }
+
+    // reduces the simplex to the face whose relative interior holds the
+    // point of it nearest the origin, writing that point and its
+    // barycentric weights. every face is tried, which for at most four
+    // points is cheap and needs no case analysis per dimension
+    template< typename VectorBase >
+    void ReduceGjkSimplex(GjkSimplex<VectorBase>& simplex, VectorBase& closest, double weights[])
+    {
+        const size_t size = simplex.mSize;
+        const size_t D = VectorBase::sDimensions;
+        static_assert( D==2 || D==3, "GJK is 2D or 3D" );
+        assert( size>0 && size<=D+1 );
+
+        double best = std::numeric_limits<double>::infinity();
+        unsigned bestMask = 0;
+        double bestWeights[4] = { 0, 0, 0, 0 };
+        for (unsigned mask=1;mask!=(1u << size);++mask)
+        {
+            size_t index[4];
+            size_t m = 0;
+            for (size_t i=0;i!=size;++i)
+                if (mask & (1u << i))
+                    index[m++] = i;
+
+            // minimise |w0 + sum t_i (w_i - w0)|, solving the normal
+            // equations by elimination
+            double lambda[4] = { 1, 0, 0, 0 };
+            if (m>1)
+            {
+                const VectorBase& w0 = simplex.mVertex[index[0]].mW;
+                double g[3][4];
+                for (size_t i=1;i!=m;++i)
+                {
+                    const VectorBase ei = simplex.mVertex[index[i]].mW - w0;
+                    for (size_t j=1;j!=m;++j)
+                    {
+                        const VectorBase ej = simplex.mVertex[index[j]].mW - w0;
+                        double dot = 0;
+                        for (size_t d=0;d!=D;++d)
+                            dot += double( ei[d] )*double( ej[d] );
+                        g[i-1][j-1] = dot;
+                    }
+                    double rhs = 0;
+                    for (size_t d=0;d!=D;++d)
+                        rhs -= double( ei[d] )*double( w0[d] );
+                    g[i-1][m-1] = rhs;
+                }
+                const size_t n = m-1;
+                double scale = 0;
+                for (size_t i=0;i!=n;++i)
+                    scale = std::max( scale, g[i][i] );
+                bool singular = scale==0;
+                for (size_t c=0;c!=n && !singular;++c)
+                {
+                    size_t pivot = c;
+                    for (size_t r=c+1;r!=n;++r)
+                        if (std::fabs( g[r][c] ) > std::fabs( g[pivot][c] ))
+                            pivot = r;
+                    if (!(std::fabs( g[pivot][c] ) > 1e-12*scale))
+                    {
+                        singular = true;
+                        break;
+                    }
+                    for (size_t k=0;k!=n+1;++k)
+                        std::swap( g[c][k], g[pivot][k] );
+                    for (size_t r=0;r!=n;++r)
+                    {
+                        if (r==c)
+                            continue;
+                        const double f = g[r][c]/g[c][c];
+                        for (size_t k=c;k!=n+1;++k)
+                            g[r][k] -= f*g[c][k];
+                    }
+                }
+                if (singular)
+                    continue;
+                bool interior = true;
+                for (size_t i=0;i!=n;++i)
+                {
+                    lambda[i+1] = g[i][n]/g[i][i];
+                    lambda[0] -= lambda[i+1];
+                    interior &= lambda[i+1] > 0;
+                }
+                if (!interior || !(lambda[0] > 0))
+                    continue;
+            }
+
+            double point[3] = { 0, 0, 0 };
+            for (size_t i=0;i!=m;++i)
+                for (size_t d=0;d!=D;++d)
+                    point[d] += lambda[i]*double( simplex.mVertex[index[i]].mW[d] );
+            double distance = 0;
+            for (size_t d=0;d!=D;++d)
+                distance += point[d]*point[d];
+            if (distance < best)
+            {
+                best = distance;
+                bestMask = mask;
+                std::copy( lambda, lambda+4, bestWeights );
+            }
+        }
+
+        // keep the face, in order
+        size_t m = 0;
+        for (size_t i=0;i!=size;++i)
+        {
+            if (bestMask & (1u << i))
+            {
+                weights[m] = bestWeights[m];
+                simplex.mVertex[m++] = simplex.mVertex[i];
+            }
+        }
+        simplex.mSize = m;
+        for (size_t d=0;d!=D;++d)
+        {
+            double sum = 0;
+            for (size_t i=0;i!=m;++i)
+                sum += weights[i]*double( simplex.mVertex[i].mW[d] );
+            closest[d] = typename VectorBase::ScalarType( sum );
+        }
+    }
+
+    // Gilbert, Johnson and Keerthi's distance between convex shapes: the
+    // point of A-B nearest the origin, found by walking a simplex towards
+    // it. fills in the distance and closest points when apart, and leaves
+    // the simplex enclosing the origin for ComputePenetration when not.
+    // a non empty simplex is used as a warm start. returns mIntersecting
+    template< typename ShapeA, typename ShapeB, typename VectorBase >
+    bool ComputeGjk(const ShapeA& a, const ShapeB& b, GjkSimplex<VectorBase>& simplex, GjkResult<VectorBase>& result,
+        size_t maxIterations = 64)
+    {
+        typedef typename VectorBase::ScalarType Scalar;
+        const size_t D = VectorBase::sDimensions;
+        static_assert( D==2 || D==3, "GJK is 2D or 3D" );
+        const Scalar tolerance = GetGjkTolerance<Scalar>();
+
+        for (size_t i=0;i!=simplex.mSize;++i)
+            ComputeGjkVertex( a, b, simplex.mVertex[i].mDirection, simplex.mVertex[i] );
+        if (simplex.mSize==0)
+        {
+            VectorBase direction = b.GetCenter() - a.GetCenter();
+            if (direction.LengthSquare()==0)
+                direction[0] = 1;
+            ComputeGjkVertex( a, b, direction, simplex.mVertex[0] );
+            simplex.mSize = 1;
+        }
+
+        result = GjkResult<VectorBase>();
+        VectorBase closest( uninitialised );
+        double weights[4];
+        for (;;)
+        {
+            ReduceGjkSimplex( simplex, closest, weights );
+            const Scalar vv = closest.LengthSquare();
+            Scalar scale = 0;
+            for (size_t i=0;i!=simplex.mSize;++i)
+                scale = std::max( scale, simplex.mVertex[i].mW.LengthSquare() );
+            if (simplex.mSize==D+1 || vv <= tolerance*tolerance*scale)
+            {
+                result.mIntersecting = true;
+                break;
+            }
+            if (result.mIterations==maxIterations)
+            {
+                result.mConverged = false;
+                break;
+            }
+            ++result.mIterations;
+
+            GjkVertex<VectorBase> vertex;
+            ComputeGjkVertex( a, b, -closest, vertex );
+            // no nearer point of A-B along -closest
+            if (vv - DotProduct( closest, vertex.mW ) <= tolerance*vv)
+                break;
+            bool repeated = false;
+            for (size_t i=0;i!=simplex.mSize;++i)
+                repeated |= simplex.mVertex[i].mW==vertex.mW;
+            if (repeated)
+                break;
+            simplex.mVertex[simplex.mSize++] = vertex;
+        }
+
+        if (!result.mIntersecting)
+        {
+            for (size_t d=0;d!=D;++d)
+            {
+                double pa = 0, pb = 0;
+                for (size_t i=0;i!=simplex.mSize;++i)
+                {
+                    pa += weights[i]*double( simplex.mVertex[i].mA[d] );
+                    pb += weights[i]*double( simplex.mVertex[i].mB[d] );
+                }
+                result.mPointA[d] = Scalar( pa );
+                result.mPointB[d] = Scalar( pb );
+            }
+            result.mDistance = Sqrt( closest.LengthSquare() );
+            result.mNormal = -closest;
+            result.mNormal /= result.mDistance;
+        }
+        return result.mIntersecting;
+    }
+
+    // the expanding polytope algorithm for shapes ComputeGjk found
+    // intersecting: the polytope on GJK's simplex grows towards the
+    // boundary of A-B nearest the origin, which gives the depth, normal and
+    // deepest points. false if A-B is flat, as for two coplanar triangles,
+    // and false with mConverged cleared if maxIterations ran out first, in
+    // which case the result holds the nearest face found so far
+    template< typename ShapeA, typename ShapeB, typename VectorBase >
+    bool ComputePenetration(const ShapeA& a, const ShapeB& b, const GjkSimplex<VectorBase>& simplex,
+        GjkResult<VectorBase>& result, size_t maxIterations = 64)
+    {
+        typedef typename VectorBase::ScalarType Scalar;
+        typedef GjkVertex<VectorBase> Vertex;
+        const size_t D = VectorBase::sDimensions;
+        static_assert( D==2 || D==3, "penetration is 2D or 3D" );
+        const Scalar tolerance = GetGjkTolerance<Scalar>();
+        assert( simplex.mSize>0 );
+
+        std::vector<Vertex> vertices( simplex.mVertex, simplex.mVertex+simplex.mSize );
+
+        // the simplex with too few points, when the origin lies on one of
+        // its faces, gets the support points most off that face
+        auto cross = [](const VectorBase& u, const VectorBase& v) {
+            VectorBase r( uninitialised );
+            r[0] = u[1]*v[2] - u[2]*v[1];
+            r[1] = u[2]*v[0] - u[0]*v[2];
+            r[2] = u[0]*v[1] - u[1]*v[0];
+            return r;
+        };
+        while (vertices.size()<D+1)
+        {
+            std::vector<VectorBase> directions;
+            const size_t k = vertices.size();
+            for (size_t axis=0;axis!=D;++axis)
+            {
+                VectorBase e( Scalar(0) );
+                e[axis] = 1;
+                if (k==1)
+                {
+                    directions.push_back( e );
+                }
+                else if constexpr (D==2)
+                {
+                    const VectorBase edge = vertices[1].mW - vertices[0].mW;
+                    VectorBase normal( uninitialised );
+                    normal[0] = -edge[1];
+                    normal[1] = edge[0];
+                    directions.push_back( normal );
+                    break;
+                }
+                else if (k==2)
+                {
+                    directions.push_back( cross( vertices[1].mW - vertices[0].mW, e ) );
+                }
+                else
+                {
+                    directions.push_back( cross( vertices[1].mW - vertices[0].mW, vertices[2].mW - vertices[0].mW ) );
+                    break;
+                }
+            }
+
+            // the farthest off the affine hull of those so far
+            Scalar best = 0;
+            Vertex chosen;
+            for (const VectorBase& direction : directions)
+            {
+                if (!(direction.LengthSquare() > 0))
+                    continue;
+                for (int sign=0;sign!=2;++sign)
+                {
+                    Vertex v;
+                    ComputeGjkVertex( a, b, sign ? -direction : direction, v );
+                    const Scalar off = Fabs( DotProduct( direction, v.mW - vertices[0].mW ) ) / Sqrt( direction.LengthSquare() );
+                    if (off > best)
+                    {
+                        best = off;
+                        chosen = v;
+                    }
+                }
+            }
+            Scalar size = 0;
+            for (const Vertex& v : vertices)
+                size = std::max( size, Sqrt( v.mW.LengthSquare() ) );
+            if (!(best > tolerance*std::max( size, Scalar(1) )))
+                return false;
+            vertices.push_back( chosen );
+        }
+
+        // faces as D indices, counterclockwise in 2D and outward wound in 3D
+        std::vector<size_t> faces;
+        std::vector<VectorBase> normals;
+        std::vector<Scalar> distances;
+        auto addFace = [&](const size_t* index) {
+            VectorBase normal( uninitialised );
+            if constexpr (D==2)
+            {
+                const VectorBase edge = vertices[index[1]].mW - vertices[index[0]].mW;
+                normal[0] = edge[1];
+                normal[1] = -edge[0];
+            }
+            else
+            {
+                normal = cross( vertices[index[1]].mW - vertices[index[0]].mW, vertices[index[2]].mW - vertices[index[0]].mW );
+            }
+            const Scalar length = Sqrt( normal.LengthSquare() );
+            Scalar distance = std::numeric_limits<Scalar>::max();
+            if (length > 0)
+            {
+                normal /= length;
+                distance = DotProduct( normal, vertices[index[0]].mW );
+            }
+            faces.insert( faces.end(), index, index+D );
+            normals.push_back( normal );
+            distances.push_back( distance );
+        };
+
+        // the simplex's faces, turned to face away from its centre
+        {
+            VectorBase centre( Scalar(0) );
+            for (const Vertex& v : vertices)
+                centre += v.mW;
+            centre /= Scalar( D+1 );
+            for (size_t skip=0;skip!=D+1;++skip)
+            {
+                size_t index[3];
+                size_t m = 0;
+                for (size_t i=0;i!=D+1;++i)
+                    if (i!=skip)
+                        index[m++] = i;
+                addFace( index );
+                if (DotProduct( normals.back(), vertices[index[0]].mW - centre ) < 0)
+                {
+                    faces.resize( faces.size()-D );
+                    normals.pop_back();
+                    distances.pop_back();
+                    std::swap( index[0], index[1] );
+                    addFace( index );
+                }
+            }
+        }
+
+        size_t nearest = 0;
+        bool converged = false;
+        for (size_t iteration=0;;++iteration)
+        {
+            nearest = 0;
+            for (size_t f=1;f!=distances.size();++f)
+                if (distances[f] < distances[nearest])
+                    nearest = f;
+            if (iteration==maxIterations)
+                break;
+
+            Vertex w;
+            ComputeGjkVertex( a, b, normals[nearest], w );
+            const Scalar reach = DotProduct( normals[nearest], w.mW );
+            if (reach - distances[nearest] <= tolerance*std::max( Fabs( reach ), Scalar(1) ))
+            {
+                converged = true;
+                break;
+            }
+            result.mIterations++;
+            const size_t added = vertices.size();
+            vertices.push_back( w );
+
+            // remove the faces w sees, keeping the edges only one of them had
+            std::vector<size_t> horizon;
+            std::vector<size_t> keptFaces;
+            std::vector<VectorBase> keptNormals;
+            std::vector<Scalar> keptDistances;
+            for (size_t f=0;f!=distances.size();++f)
+            {
+                const size_t* face = &faces[f*D];
+                const bool visible = f==nearest
+                    || DotProduct( normals[f], w.mW - vertices[face[0]].mW ) > 0;
+                if (!visible)
+                {
+                    keptFaces.insert( keptFaces.end(), face, face+D );
+                    keptNormals.push_back( normals[f] );
+                    keptDistances.push_back( distances[f] );
+                    continue;
+                }
+                if constexpr (D==2)
+                {
+                    horizon.push_back( face[0] );
+                    horizon.push_back( face[1] );
+                }
+                else
+                {
+                    for (size_t k=0;k!=3;++k)
+                    {
+                        const size_t from = face[k], to = face[(k+1)%3];
+                        bool shared = false;
+                        for (size_t e=0;e<horizon.size();e+=2)
+                        {
+                            if (horizon[e]==to && horizon[e+1]==from)
+                            {
+                                horizon.erase( horizon.begin()+e, horizon.begin()+e+2 );
+                                shared = true;
+                                break;
+                            }
+                        }
+                        if (!shared)
+                        {
+                            horizon.push_back( from );
+                            horizon.push_back( to );
+                        }
+                    }
+                }
+            }
+            faces.swap( keptFaces );
+            normals.swap( keptNormals );
+            distances.swap( keptDistances );
+
+            if constexpr (D==2)
+            {
+                // one visible edge or a run of them, split at w
+                size_t first = horizon[0], last = horizon[1];
+                for (size_t e=0;e<horizon.size();e+=2)
+                {
+                    bool startsRun = true;
+                    bool endsRun = true;
+                    for (size_t g=0;g<horizon.size();g+=2)
+                    {
+                        startsRun &= horizon[g+1]!=horizon[e];
+                        endsRun &= horizon[g]!=horizon[e+1];
+                    }
+                    if (startsRun)
+                        first = horizon[e];
+                    if (endsRun)
+                        last = horizon[e+1];
+                }
+                const size_t left[2] = { first, added };
+                const size_t right[2] = { added, last };
+                addFace( left );
+                addFace( right );
+            }
+            else
+            {
+                for (size_t e=0;e<horizon.size();e+=2)
+                {
+                    const size_t index[3] = { horizon[e], horizon[e+1], added };
+                    addFace( index );
+                }
+            }
+        }
+
+        // the origin projected on the nearest face, in its barycentric terms
+        const size_t* face = &faces[nearest*D];
+        const VectorBase normal = normals[nearest];
+        VectorBase p = normal;
+        p *= distances[nearest];
+        double weights[3] = { 1, 0, 0 };
+        if constexpr (D==2)
+        {
+            const VectorBase edge = vertices[face[1]].mW - vertices[face[0]].mW;
+            const Scalar length = edge.LengthSquare();
+            const double t = length > 0 ? double( DotProduct( p - vertices[face[0]].mW, edge ) / length ) : 0;
+            weights[1] = std::min( std::max( t, 0.0 ), 1.0 );
+            weights[0] = 1 - weights[1];
+        }
+        else
+        {
+            const VectorBase& w0 = vertices[face[0]].mW;
+            const VectorBase& w1 = vertices[face[1]].mW;
+            const VectorBase& w2 = vertices[face[2]].mW;
+            const double area = DotProduct( cross( w1 - w0, w2 - w0 ), normal );
+            if (area > 0)
+            {
+                weights[0] = DotProduct( cross( w1 - p, w2 - p ), normal ) / area;
+                weights[1] = DotProduct( cross( w2 - p, w0 - p ), normal ) / area;
+                weights[2] = 1 - weights[0] - weights[1];
+            }
+        }
+        for (size_t d=0;d!=D;++d)
+        {
+            double pa = 0, pb = 0;
+            for (size_t i=0;i!=D;++i)
+            {
+                pa += weights[i]*double( vertices[face[i]].mA[d] );
+                pb += weights[i]*double( vertices[face[i]].mB[d] );
+            }
+            result.mPointA[d] = Scalar( pa );
+            result.mPointB[d] = Scalar( pb );
+        }
+        result.mIntersecting = true;
+        result.mDistance = 0;
+        result.mPenetration = std::max( distances[nearest], Scalar(0) );
+        result.mNormal = normal;
+        result.mConverged = converged;
+        return converged;
+    }
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template< typename AABB >
+    BoxSupport<AABB>::BoxSupport(const AABB& box)
+        : mMin(box.GetMinBound()), mMax(box.GetMaxBound())
+    {
+    }
+
+    template< typename AABB >
+    typename BoxSupport<AABB>::VectorBase BoxSupport<AABB>::GetSupport(const VectorBase& direction) const
+    {
+        VectorBase result( uninitialised );
+        for (size_t d=0;d!=VectorBase::sDimensions;++d)
+            result[d] = direction[d] < 0 ? mMin[d] : mMax[d];
+        return result;
+    }
+
+    template< typename AABB >
+    typename BoxSupport<AABB>::VectorBase BoxSupport<AABB>::GetCenter() const
+    {
+        return GetMidpoint( mMin, mMax );
+    }
+
+    template< typename Triangle >
+    TriangleSupport<Triangle>::TriangleSupport(const Triangle& triangle)
+        : mVertex{ triangle.GetA(), triangle.GetB(), triangle.GetC() }
+    {
+    }
+
+    template< typename Triangle >
+    typename TriangleSupport<Triangle>::VectorBase TriangleSupport<Triangle>::GetSupport(const VectorBase& direction) const
+    {
+        size_t best = 0;
+        for (size_t i=1;i!=3;++i)
+            if (DotProduct( mVertex[i], direction ) > DotProduct( mVertex[best], direction ))
+                best = i;
+        return mVertex[best];
+    }
+
+    template< typename Triangle >
+    typename TriangleSupport<Triangle>::VectorBase TriangleSupport<Triangle>::GetCenter() const
+    {
+        VectorBase result = mVertex[0] + mVertex[1] + mVertex[2];
+        result /= typename VectorBase::ScalarType(3);
+        return result;
+    }
+
+    template< typename VectorType >
+    PointSetSupport<VectorType>::PointSetSupport(const VectorType* points, size_t count)
+        : mPoints(points), mCount(count)
+    {
+        assert( count>0 );
+    }
+
+    template< typename VectorType >
+    typename PointSetSupport<VectorType>::VectorBase PointSetSupport<VectorType>::GetSupport(const VectorBase& direction) const
+    {
+        size_t best = 0;
+        typename VectorBase::ScalarType bestDot = DotProduct( VectorBase( mPoints[0] ), direction );
+        for (size_t i=1;i!=mCount;++i)
+        {
+            const typename VectorBase::ScalarType dot = DotProduct( VectorBase( mPoints[i] ), direction );
+            if (dot > bestDot)
+            {
+                bestDot = dot;
+                best = i;
+            }
+        }
+        return mPoints[best];
+    }
+
+    template< typename VectorType >
+    typename PointSetSupport<VectorType>::VectorBase PointSetSupport<VectorType>::GetCenter() const
+    {
+        VectorBase result( typename VectorBase::ScalarType(0) );
+        for (size_t i=0;i!=mCount;++i)
+            result += mPoints[i];
+        result /= typename VectorBase::ScalarType( mCount );
+        return result;
+    }
+
+    template< typename VectorType >
+    SphereSupport<VectorType>::SphereSupport(const VectorType& center, ScalarType radius)
+        : mCenter(center), mRadius(radius)
+    {
+    }
+
+    template< typename VectorType >
+    typename SphereSupport<VectorType>::VectorBase SphereSupport<VectorType>::GetSupport(const VectorBase& direction) const
+    {
+        const ScalarType length = Sqrt( direction.LengthSquare() );
+        VectorBase result( mCenter );
+        if (length > 0)
+        {
+            VectorBase offset( direction );
+            offset *= mRadius/length;
+            result += offset;
+        }
+        else
+        {
+            result[0] += mRadius;
+        }
+        return result;
+    }
+
+    template< typename VectorType >
+    typename SphereSupport<VectorType>::VectorBase SphereSupport<VectorType>::GetCenter() const
+    {
+        return mCenter;
+    }
+}
+
+#endif//GEOMETRY_GJK_H_INCLUDED_
@@ -0,0 +1,389 @@
+#ifndef GEOMETRY_LBVH_H_INCLUDED_
+#define GEOMETRY_LBVH_H_INCLUDED_
+
+#include "aabb3d.h"
+#include "aabb_fn.h"
+#include "ray3d.h"
+#include "parallel.h"
+#include "space_filling_curve.h"
+#include "radix_sort.h"
+
+#include <cassert>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // linear bounding volume hierarchy over boxes (Karras, "Maximizing
+    // parallelism in the construction of BVHs, octrees, and k-d trees", 2012).
+    // box centres are sorted along a Morton curve, each of the n-1 inner
+    // nodes finds its own range of the sorted keys independently, and the
+    // bounds are filled in from the leaves up, a node being finished by
+    // whichever of its children arrives second. every step is a flat
+    // parallel loop, so rebuilding a million boxes each frame is cheap.
+    // the tree is poorer than a SAH or median split one for queries
+    template <typename Scalar>
+    class LinearBVH
+    {
+        public:
+            typedef AxisAlignedBoundingBox3d<Scalar> BoundsType;
+            typedef Ray3d<Scalar> RayType;
+
+            // marks a child index as a leaf, the rest being its sorted position
+            const static uint32_t sLeaf = 0x80000000u;
+
+            // empty
+            LinearBVH();
+
+            explicit LinearBVH(const std::vector<BoundsType>& boxes,
+                const ExecutionPolicy& policy = ExecutionPolicy());
+
+            // replaces the tree, keeping the storage of the last one and the
+            // scratch it was built in. a rebuild no larger than the last
+            // allocates nothing per box, only the per-chunk bookkeeping of
+            // the parallel loops
+            void Build(const std::vector<BoundsType>& boxes,
+                const ExecutionPolicy& policy = ExecutionPolicy());
+
+            size_t GetPrimitiveCount() const;
+            const BoundsType& GetBounds() const;
+
+            // read access to the tree. inner nodes are 0 to count-2, 0 the
+            // root; children are inner node indices or sLeaf | position.
+            // with a single box the root is that leaf
+            uint32_t GetRoot() const;
+            const BoundsType& GetNodeBounds(uint32_t child) const;
+            uint32_t GetLeftChild(uint32_t node) const;
+            uint32_t GetRightChild(uint32_t node) const;
+            // the index into boxes of the leaf
+            uint32_t GetPrimitive(uint32_t leaf) const;
+
+            // fn(index into boxes) for every box overlapping box
+            template< typename Fn >
+            void QueryOverlaps(const BoundsType& box, Fn fn) const;
+
+            // fn(index into boxes) for every box the ray enters before tMax
+            template< typename Fn >
+            void QueryRay(const RayType& ray, Scalar tMax, Fn fn) const;
+
+        private:
+            class Node
+            {
+                public:
+                    explicit Node(const Uninitialised&)
+                        : mBounds(uninitialised)
+                    { }
+
+                    explicit Node(const BoundsType& bounds)
+                        : mBounds(bounds), mLeft(0), mRight(0)
+                    { }
+
+                    BoundsType mBounds;
+                    uint32_t mLeft;
+                    uint32_t mRight;
+            };
+
+            // length of the prefix shared by sorted keys i and j, ties broken
+            // by position so equal keys still make a binary tree. -1 outside
+            int Delta(const std::vector<uint64_t>& keys, int64_t i, int64_t j) const;
+
+            // two children's bounds, unioned without moving their exclusive max bounds
+            BoundsType Union(const BoundsType& a, const BoundsType& b) const;
+
+            std::vector<Node> mNodes;
+            std::vector<BoundsType> mLeafBounds;
+            std::vector<uint32_t> mPrimitives;
+            // of inner nodes then leaves
+            std::vector<uint32_t> mParents;
+            std::unique_ptr< std::atomic<uint32_t>[] > mVisits;
+            size_t mVisitCapacity;
+
+            // scratch kept between builds
+            std::vector< Vector3d<Scalar> > mCentres;
+            std::vector<uint64_t> mKeys;
+            RadixSortScratch<uint32_t> mSortScratch;
+    };
+
+    //
+    // Free-functions
+    //
+
+    inline int CountLeadingZeros(uint64_t v)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return v ? __builtin_clzll( v ) : 64;
+#else
+        int n = 0;
+        for (uint64_t bit=uint64_t(1)<<63;bit && !(v & bit);bit>>=1)
+            ++n;
+        return n;
+#endif
+    }
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template <typename Scalar>
+    LinearBVH<Scalar>::LinearBVH()
+        : mVisitCapacity(0)
+    {
+    }
+
+    template <typename Scalar>
+    LinearBVH<Scalar>::LinearBVH(const std::vector<BoundsType>& boxes, const ExecutionPolicy& policy)
+        : mVisitCapacity(0)
+    {
+        Build( boxes, policy );
+    }
+
+    template <typename Scalar>
+    void LinearBVH<Scalar>::Build(const std::vector<BoundsType>& boxes, const ExecutionPolicy& policy)
+    {
+        const size_t count = boxes.size();
+        assert( count < sLeaf );
+        mNodes.clear();
+        mLeafBounds.clear();
+        mPrimitives.clear();
+        mParents.clear();
+        if (count==0)
+            return;
+
+        // Morton keys of the box centres, relative to the bounds of the centres
+        std::vector< Vector3d<Scalar> >& centres = mCentres;
+        std::vector<uint64_t>& keys = mKeys;
+        centres.resize( count, Vector3d<Scalar>(0,0,0) );
+        ParallelFor( policy, 0, count, [&](size_t first, size_t last) {
+            for (size_t i=first;i!=last;++i)
+                centres[i] = boxes[i].GetCenter();
+        } );
+        BoundsType centreBounds(uninitialised);
+        AABB_ComputeBounds( centres.begin(), centres.end(), centreBounds, policy );
+        ComputeMortonKeys( centreBounds, centres.begin(), centres.end(), keys, policy );
+
+        // the top 11 bits of each axis are plenty to order boxes by, and
+        // make three radix passes rather than six
+        const unsigned keyBits = 33;
+        ParallelFor( policy, 0, count, [&](size_t first, size_t last) {
+            for (size_t i=first;i!=last;++i)
+                keys[i] >>= 63 - keyBits;
+        } );
+
+        mPrimitives.resize( count );
+        for (size_t i=0;i!=count;++i)
+            mPrimitives[i] = uint32_t(i);
+        RadixSort( keys, mPrimitives, mSortScratch, policy, keyBits );
+
+        // every entry is written below, the fill only keeps the copies defined
+        const BoundsType blank( Vector3d<Scalar>(0,0,0) );
+        mLeafBounds.resize( count, blank );
+        mNodes.resize( count-1, Node( blank ) );
+        mParents.resize( 2*count-1 );
+        ParallelFor( policy, 0, count, [&](size_t first, size_t last) {
+            for (size_t i=first;i!=last;++i)
+                mLeafBounds[i] = boxes[mPrimitives[i]];
+        } );
+        if (count==1)
+            return;
+
+        // each inner node i covers the sorted range with i at one end: the
+        // direction is toward the neighbour sharing the longer prefix, the
+        // far end is found by doubling then bisecting, and the split is where
+        // the prefix shared with i drops below the prefix of the whole range
+        ParallelFor( policy, 0, count-1, [&](size_t first, size_t last) {
+            for (size_t n=first;n!=last;++n)
+            {
+                const int64_t i = int64_t(n);
+                const int64_t d = Delta( keys, i, i+1 ) > Delta( keys, i, i-1 ) ? 1 : -1;
+                const int minimum = Delta( keys, i, i-d );
+                int64_t lengthMax = 2;
+                while (Delta( keys, i, i+lengthMax*d ) > minimum)
+                    lengthMax *= 2;
+                int64_t length = 0;
+                for (int64_t t=lengthMax/2;t>=1;t/=2)
+                {
+                    if (Delta( keys, i, i+(length+t)*d ) > minimum)
+                        length += t;
+                }
+                const int64_t j = i + length*d;
+
+                const int prefix = Delta( keys, i, j );
+                int64_t split = 0;
+                int64_t t = length;
+                do
+                {
+                    t = (t+1)/2;
+                    if (Delta( keys, i, i+(split+t)*d ) > prefix)
+                        split += t;
+                } while (t>1);
+                const int64_t gamma = i + split*d + std::min( d, int64_t(0) );
+
+                Node& node = mNodes[n];
+                node.mLeft = std::min( i, j )==gamma ? (sLeaf | uint32_t(gamma)) : uint32_t(gamma);
+                node.mRight = std::max( i, j )==gamma+1 ? (sLeaf | uint32_t(gamma+1)) : uint32_t(gamma+1);
+                mParents[node.mLeft & sLeaf ? count-1 + (node.mLeft & ~sLeaf) : node.mLeft] = uint32_t(n);
+                mParents[node.mRight & sLeaf ? count-1 + (node.mRight & ~sLeaf) : node.mRight] = uint32_t(n);
+            }
+        } );
+
+        if (mVisitCapacity < count-1)
+        {
+            mVisits.reset( new std::atomic<uint32_t>[count-1] );
+            mVisitCapacity = count-1;
+        }
+        std::atomic<uint32_t>* visits = mVisits.get();
+        ParallelFor( policy, 0, count-1, [&](size_t first, size_t last) {
+            for (size_t i=first;i!=last;++i)
+                visits[i].store( 0, std::memory_order_relaxed );
+        } );
+
+        // walk up from every leaf, the first child to reach a node stops and
+        // the second, seeing the first's bounds through acq_rel, fills it in
+        ParallelFor( policy, 0, count, [&](size_t first, size_t last) {
+            for (size_t i=first;i!=last;++i)
+            {
+                uint32_t node = mParents[count-1 + i];
+                while (visits[node].fetch_add( 1, std::memory_order_acq_rel )!=0)
+                {
+                    Node& inner = mNodes[node];
+                    inner.mBounds = Union( GetNodeBounds( inner.mLeft ), GetNodeBounds( inner.mRight ) );
+                    if (node==0)
+                        break;
+                    node = mParents[node];
+                }
+            }
+        } );
+    }
+
+    template <typename Scalar>
+    size_t LinearBVH<Scalar>::GetPrimitiveCount() const
+    {
+        return mPrimitives.size();
+    }
+
+    template <typename Scalar>
+    const typename LinearBVH<Scalar>::BoundsType& LinearBVH<Scalar>::GetBounds() const
+    {
+        assert( !mPrimitives.empty() );
+        return GetNodeBounds( GetRoot() );
+    }
+
+    template <typename Scalar>
+    uint32_t LinearBVH<Scalar>::GetRoot() const
+    {
+        assert( !mPrimitives.empty() );
+        return mNodes.empty() ? sLeaf : 0;
+    }
+
+    template <typename Scalar>
+    const typename LinearBVH<Scalar>::BoundsType& LinearBVH<Scalar>::GetNodeBounds(uint32_t child) const
+    {
+        return child & sLeaf ? mLeafBounds[child & ~sLeaf] : mNodes[child].mBounds;
+    }
+
+    template <typename Scalar>
+    uint32_t LinearBVH<Scalar>::GetLeftChild(uint32_t node) const
+    {
+        assert( node<mNodes.size() );
+        return mNodes[node].mLeft;
+    }
+
+    template <typename Scalar>
+    uint32_t LinearBVH<Scalar>::GetRightChild(uint32_t node) const
+    {
+        assert( node<mNodes.size() );
+        return mNodes[node].mRight;
+    }
+
+    template <typename Scalar>
+    uint32_t LinearBVH<Scalar>::GetPrimitive(uint32_t leaf) const
+    {
+        assert( (leaf & sLeaf) && (leaf & ~sLeaf)<mPrimitives.size() );
+        return mPrimitives[leaf & ~sLeaf];
+    }
+
+    template <typename Scalar>
+    template< typename Fn >
+    void LinearBVH<Scalar>::QueryOverlaps(const BoundsType& box, Fn fn) const
+    {
+        if (mPrimitives.empty())
+            return;
+
+        // 33 bits of key then 32 of position bound the depth
+        uint32_t stack[128];
+        size_t top = 0;
+        stack[top++] = GetRoot();
+        while (top)
+        {
+            const uint32_t child = stack[--top];
+            if (!GetNodeBounds( child ).Overlaps( box ))
+                continue;
+            if (child & sLeaf)
+            {
+                fn( mPrimitives[child & ~sLeaf] );
+                continue;
+            }
+            stack[top++] = mNodes[child].mRight;
+            stack[top++] = mNodes[child].mLeft;
+        }
+    }
+
+    template <typename Scalar>
+    template< typename Fn >
+    void LinearBVH<Scalar>::QueryRay(const RayType& ray, Scalar tMax, Fn fn) const
+    {
+        if (mPrimitives.empty())
+            return;
+
+        uint32_t stack[128];
+        size_t top = 0;
+        stack[top++] = GetRoot();
+        while (top)
+        {
+            const uint32_t child = stack[--top];
+            if (!ray.Intersects( GetNodeBounds( child ), tMax ))
+                continue;
+            if (child & sLeaf)
+            {
+                fn( mPrimitives[child & ~sLeaf] );
+                continue;
+            }
+            stack[top++] = mNodes[child].mRight;
+            stack[top++] = mNodes[child].mLeft;
+        }
+    }
+
+    template <typename Scalar>
+    int LinearBVH<Scalar>::Delta(const std::vector<uint64_t>& keys, int64_t i, int64_t j) const
+    {
+        if (j<0 || j>=int64_t(keys.size()))
+            return -1;
+        const uint64_t a = keys[size_t(i)];
+        const uint64_t b = keys[size_t(j)];
+        if (a==b)
+            return 64 + CountLeadingZeros( uint64_t(i ^ j) ) - 32;
+        return CountLeadingZeros( a ^ b );
+    }
+
+    template <typename Scalar>
+    typename LinearBVH<Scalar>::BoundsType LinearBVH<Scalar>::Union(const BoundsType& a, const BoundsType& b) const
+    {
+        Vector3d<Scalar> minBound( a.GetMinBound() ), maxBound( a.GetMaxBound() );
+        for (size_t d=0;d!=3;++d)
+        {
+            minBound[d] = std::min( minBound[d], b.GetMinBound()[d] );
+            maxBound[d] = std::max( maxBound[d], b.GetMaxBound()[d] );
+        }
+        return BoundsType( minBound, maxBound );
+    }
+}
+
+#endif//GEOMETRY_LBVH_H_INCLUDED_
@@ -0,0 +1,321 @@
+#ifndef GEOMETRY_LINEAR_SOLVE_H_INCLUDED_
+#define GEOMETRY_LINEAR_SOLVE_H_INCLUDED_
+
+#include "base_maths.h"
+#include "matrixx.h"
+#include "vectorx.h"
+#include "parallel.h"
+
+#include <cassert>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // PA = LU with partial pivoting, for solving square systems.
+    // the elimination below each pivot is split across the policy by rows
+    template< typename Scalar >
+    class LUDecomposition
+    {
+    public:
+        typedef MatrixX<Scalar> MatrixType;
+        typedef VectorX<Scalar> VectorType;
+
+        // elements of work per parallel chunk, rows are grouped up to this
+        const static size_t sChunkWork = 16*1024;
+
+        explicit LUDecomposition(const MatrixType& m, const ExecutionPolicy& policy = ExecutionPolicy());
+
+        // a pivot came out exactly zero, the solve functions must not be called
+        bool IsSingular() const;
+
+        Scalar GetDeterminant() const;
+
+        // x such that m x = b
+        void ComputeSolution(const VectorType& b, VectorType& x) const;
+        VectorType GetSolution(const VectorType& b) const;
+
+        void ComputeInverse(MatrixType& result) const;
+
+    private:
+        // L below the diagonal (its unit diagonal implied), U on and above
+        MatrixType mLU;
+        // row swapped with row k at step k
+        std::vector<size_t> mPivot;
+        Scalar mSign;
+        bool mSingular;
+    };
+
+    // m = L L^T for symmetric positive definite m, half the work of LU and
+    // no pivoting. only the lower triangle of m is read
+    template< typename Scalar >
+    class CholeskyDecomposition
+    {
+    public:
+        typedef MatrixX<Scalar> MatrixType;
+        typedef VectorX<Scalar> VectorType;
+
+        // elements of work per parallel chunk, rows are grouped up to this
+        const static size_t sChunkWork = 16*1024;
+
+        explicit CholeskyDecomposition(const MatrixType& m, const ExecutionPolicy& policy = ExecutionPolicy());
+
+        // false if a diagonal came out non-positive, the solve functions must not be called
+        bool IsPositiveDefinite() const;
+
+        // L, with zeros above the diagonal
+        const MatrixType& GetLower() const;
+
+        // x such that m x = b
+        void ComputeSolution(const VectorType& b, VectorType& x) const;
+        VectorType GetSolution(const VectorType& b) const;
+
+    private:
+        MatrixType mL;
+        bool mPositiveDefinite;
+    };
+
+    //
+    // Free-functions
+    //
+
+    // the x minimising |a x - b| for a with at least as many rows as columns,
+    // through the normal equations a^T a x = a^T b. fine for the well
+    // conditioned fits this is meant for, it squares the condition number.
+    // false if a does not have full column rank
+    template< typename Scalar >
+    bool ComputeLeastSquares(const MatrixX<Scalar>& a, const VectorX<Scalar>& b, VectorX<Scalar>& x,
+        const ExecutionPolicy& policy = ExecutionPolicy())
+    {
+        assert( a.GetRows()==b.GetSize() && a.GetRows()>=a.GetColumns() );
+        const MatrixX<Scalar> at = a.GetTranspose();
+        MatrixX<Scalar> ata;
+        VectorX<Scalar> atb;
+        Multiply( at, a, ata, policy );
+        MultiplyColumn( at, b, atb, policy );
+
+        const CholeskyDecomposition<Scalar> cholesky( ata, policy );
+        if (!cholesky.IsPositiveDefinite())
+            return false;
+        cholesky.ComputeSolution( atb, x );
+        return true;
+    }
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template< typename Scalar >
+    LUDecomposition<Scalar>::LUDecomposition(const MatrixType& m, const ExecutionPolicy& policy)
+        : mLU(m)
+        , mPivot(m.GetRows())
+        , mSign(1)
+        , mSingular(false)
+    {
+        assert( m.GetRows()==m.GetColumns() );
+        const size_t n = m.GetRows();
+        MatrixType& a = mLU;
+
+        for (size_t k=0;k!=n;++k)
+        {
+            size_t p = k;
+            for (size_t i=k+1;i!=n;++i)
+            {
+                if (Abs(a[i][k]) > Abs(a[p][k]))
+                    p = i;
+            }
+            mPivot[k] = p;
+            if (p!=k)
+            {
+                std::swap_ranges( a[k], a[k]+n, a[p] );
+                mSign = -mSign;
+            }
+
+            const Scalar pivot = a[k][k];
+            if (pivot == 0)
+            {
+                // the column is already zero below the diagonal, nothing to eliminate
+                mSingular = true;
+                continue;
+            }
+
+            const Scalar* rowK = a[k];
+            ParallelFor( policy.WithGrain( sChunkWork/(n-k) + 1 ), k+1, n, [&](size_t first, size_t last) {
+                for (size_t i=first;i!=last;++i)
+                {
+                    Scalar* rowI = a[i];
+                    const Scalar l = rowI[k] / pivot;
+                    rowI[k] = l;
+                    for (size_t j=k+1;j!=n;++j)
+                        rowI[j] -= l * rowK[j];
+                }
+            } );
+        }
+    }
+
+    template< typename Scalar >
+    bool LUDecomposition<Scalar>::IsSingular() const
+    {
+        return mSingular;
+    }
+
+    template< typename Scalar >
+    Scalar LUDecomposition<Scalar>::GetDeterminant() const
+    {
+        Scalar result = mSign;
+        for (size_t i=0;i!=mLU.GetRows();++i)
+            result *= mLU[i][i];
+        return result;
+    }
+
+    template< typename Scalar >
+    void LUDecomposition<Scalar>::ComputeSolution(const VectorType& b, VectorType& x) const
+    {
+        assert( !mSingular );
+        const size_t n = mLU.GetRows();
+        assert( b.GetSize()==n );
+        x = b;
+
+        for (size_t k=0;k!=n;++k)
+            std::swap( x[k], x[mPivot[k]] );
+
+        // L y = Pb, unit diagonal
+        for (size_t i=1;i<n;++i)
+        {
+            const Scalar* row = mLU[i];
+            Scalar sum = x[i];
+            for (size_t j=0;j!=i;++j)
+                sum -= row[j] * x[j];
+            x[i] = sum;
+        }
+
+        // U x = y
+        for (size_t i=n;i--!=0;)
+        {
+            const Scalar* row = mLU[i];
+            Scalar sum = x[i];
+            for (size_t j=i+1;j<n;++j)
+                sum -= row[j] * x[j];
+            x[i] = sum / row[i];
+        }
+    }
+
+    template< typename Scalar >
+    typename LUDecomposition<Scalar>::VectorType LUDecomposition<Scalar>::GetSolution(const VectorType& b) const
+    {
+        VectorType x;
+        ComputeSolution( b, x );
+        return x;
+    }
+
+    template< typename Scalar >
+    void LUDecomposition<Scalar>::ComputeInverse(MatrixType& result) const
+    {
+        const size_t n = mLU.GetRows();
+        result = MatrixType( n, n );
+        VectorType e( n ), x;
+        for (size_t c=0;c!=n;++c)
+        {
+            e[c] = 1;
+            ComputeSolution( e, x );
+            e[c] = 0;
+            for (size_t r=0;r!=n;++r)
+                result[r][c] = x[r];
+        }
+    }
+
+    // Cholesky-Crout, a column at a time. every entry below the diagonal is
+    // a dot product of two rows already computed, so they run in parallel
+    template< typename Scalar >
+    CholeskyDecomposition<Scalar>::CholeskyDecomposition(const MatrixType& m, const ExecutionPolicy& policy)
+        : mL(m.GetRows(), m.GetColumns())
+        , mPositiveDefinite(true)
+    {
+        assert( m.GetRows()==m.GetColumns() );
+        const size_t n = m.GetRows();
+        MatrixType& l = mL;
+
+        for (size_t j=0;j!=n;++j)
+        {
+            const Scalar* rowJ = l[j];
+            Scalar d = m[j][j];
+            for (size_t k=0;k!=j;++k)
+                d -= rowJ[k] * rowJ[k];
+            if (!(d > 0))
+            {
+                mPositiveDefinite = false;
+                return;
+            }
+            const Scalar ljj = Sqrt( d );
+            l[j][j] = ljj;
+
+            ParallelFor( policy.WithGrain( sChunkWork/(j+1) + 1 ), j+1, n, [&](size_t first, size_t last) {
+                for (size_t i=first;i!=last;++i)
+                {
+                    const Scalar* rowI = l[i];
+                    Scalar sum = m[i][j];
+                    for (size_t k=0;k!=j;++k)
+                        sum -= rowI[k] * rowJ[k];
+                    l[i][j] = sum / ljj;
+                }
+            } );
+        }
+    }
+
+    template< typename Scalar >
+    bool CholeskyDecomposition<Scalar>::IsPositiveDefinite() const
+    {
+        return mPositiveDefinite;
+    }
+
+    template< typename Scalar >
+    const typename CholeskyDecomposition<Scalar>::MatrixType& CholeskyDecomposition<Scalar>::GetLower() const
+    {
+        return mL;
+    }
+
+    template< typename Scalar >
+    void CholeskyDecomposition<Scalar>::ComputeSolution(const VectorType& b, VectorType& x) const
+    {
+        assert( mPositiveDefinite );
+        const size_t n = mL.GetRows();
+        assert( b.GetSize()==n );
+        x = b;
+
+        // L y = b
+        for (size_t i=0;i!=n;++i)
+        {
+            const Scalar* row = mL[i];
+            Scalar sum = x[i];
+            for (size_t k=0;k!=i;++k)
+                sum -= row[k] * x[k];
+            x[i] = sum / row[i];
+        }
+
+        // L^T x = y, scattering each solved value back along its row of L
+        // so the reads stay contiguous
+        for (size_t i=n;i--!=0;)
+        {
+            const Scalar* row = mL[i];
+            x[i] /= row[i];
+            const Scalar xi = x[i];
+            for (size_t k=0;k!=i;++k)
+                x[k] -= row[k] * xi;
+        }
+    }
+
+    template< typename Scalar >
+    typename CholeskyDecomposition<Scalar>::VectorType CholeskyDecomposition<Scalar>::GetSolution(const VectorType& b) const
+    {
+        VectorType x;
+        ComputeSolution( b, x );
+        return x;
+    }
+}
+
+#endif//GEOMETRY_LINEAR_SOLVE_H_INCLUDED_
@@ -67,13 +67,122 @@ namespace Geometry
     
         static Matrix4 RotationAlign(const Vector3d<Scalar>& v1, const Vector3d<Scalar>& v2);
         void BecomeRotationAlign( const Vector3d<Scalar>& v1, const Vector3d<Scalar>& v2);
+
+        // batch builders, result[i] is built from the i'th input(s).
+        // Output is Matrix4, or MatrixNM<Scalar,4,3> for the affine layout
+        // (the first three columns, dropping the constant 0,0,0,1).
+        // the sines and cosines are computed a block at a time with SinCos<A>,
+        // exact by default so they match the single builders, an approximate
+        // tier can be asked for where speed matters more
+        template< Accuracy A = accuracy_exact, typename Output >
+        static void RotationFromEuler(const VectorN<Scalar,3>* r, Output* result, size_t count);
+
+        template< Accuracy A = accuracy_exact, typename Output >
+        static void RotationAround(const VectorN<Scalar,3>* axis, const Scalar* r, Output* result, size_t count);
+
+        template< typename Output >
+        static void RotationAlign(const Vector3d<Scalar>* v1, const Vector3d<Scalar>* v2, Output* result, size_t count);
     };
     
     //
     // Free-functions
     //
 
-    // ---
+    // writes the 3x3 rotation r into the upper left of m,
+    // the remainder of m becomes identity
+    template< typename Scalar >
+    void SetRotation(MatrixNM<Scalar,4,4>& m, const Scalar r[3][3])
+    {
+        for (int n=0;n!=3;++n)
+        {
+            m[n][0] = r[n][0];
+            m[n][1] = r[n][1];
+            m[n][2] = r[n][2];
+            m[n][3] = 0;
+        }
+        m[3][0] = 0;
+        m[3][1] = 0;
+        m[3][2] = 0;
+        m[3][3] = 1;
+    }
+
+    // as above, for the 4x3 affine layout
+    template< typename Scalar >
+    void SetRotation(MatrixNM<Scalar,4,3>& m, const Scalar r[3][3])
+    {
+        for (int n=0;n!=3;++n)
+        {
+            m[n][0] = r[n][0];
+            m[n][1] = r[n][1];
+            m[n][2] = r[n][2];
+        }
+        m[3][0] = 0;
+        m[3][1] = 0;
+        m[3][2] = 0;
+    }
+
+    // rotation from the sines and cosines of the three euler angles
+    template< typename Scalar >
+    void ComputeEulerRotation(const Scalar s[3], const Scalar c[3], Scalar r[3][3])
+    {
+        const Scalar A = c[0], B = s[0];
+        const Scalar C = c[1], D = s[1];
+        const Scalar E = c[2], F = s[2];
+
+        const Scalar AD = A * D;
+        const Scalar BD = B * D;
+
+        r[0][0] =   C * E;
+        r[0][1] =  -C * F;
+        r[0][2] =   D;
+        r[1][0] =  BD * E + A * F;
+        r[1][1] = -BD * F + A * E;
+        r[1][2] =  -B * C;
+        r[2][0] = -AD * E + B * F;
+        r[2][1] =  AD * F + B * E;
+        r[2][2] =   A * C;
+    }
+
+    // rotation about a unit axis from the sine and cosine of the angle
+    template< typename Scalar >
+    void ComputeAxisRotation(const VectorN<Scalar,3>& axis, Scalar rsin, Scalar rcos, Scalar r[3][3])
+    {
+        const Scalar rcosr = 1-rcos;
+        r[0][0] =            rcos + axis[0]*axis[0]*rcosr;
+        r[1][0] =  axis[2] * rsin + axis[1]*axis[0]*rcosr;
+        r[2][0] = -axis[1] * rsin + axis[2]*axis[0]*rcosr;
+        r[0][1] = -axis[2] * rsin + axis[0]*axis[1]*rcosr;
+        r[1][1] =            rcos + axis[1]*axis[1]*rcosr;
+        r[2][1] =  axis[0] * rsin + axis[2]*axis[1]*rcosr;
+        r[0][2] =  axis[1] * rsin + axis[0]*axis[2]*rcosr;
+        r[1][2] = -axis[0] * rsin + axis[1]*axis[2]*rcosr;
+        r[2][2] =            rcos + axis[2]*axis[2]*rcosr;
+    }
+
+    // rotation taking unit vector v1 onto unit vector v2
+    template< typename Scalar >
+    void ComputeAlignRotation(const Vector3d<Scalar>& v1, const Vector3d<Scalar>& v2, Scalar r[3][3])
+    {
+        // vec3 axis = cross( v1, v2 );
+        auto axis = CrossProduct( v1, v2 );
+
+        // const float cosA = dot( v1, v2 );
+        auto cosA = Vector3d<Scalar>::DotProduct( v1, v2 );
+        
+        // const float k = 1.0f / (1.0f + cosA);
+        const double k = 1.0 / (1.0 + cosA);
+
+        const int x=0; const int y=1; const int z=2;    
+        r[0][0] = (axis[x] * axis[x] * k) + cosA;
+        r[0][1] = (axis[y] * axis[x] * k) - axis[z]; 
+        r[0][2] = (axis[z] * axis[x] * k) + axis[y];
+        r[1][0] = (axis[x] * axis[y] * k) + axis[z];
+        r[1][1] = (axis[y] * axis[y] * k) + cosA;
+        r[1][2] = (axis[z] * axis[y] * k) - axis[x];
+        r[2][0] = (axis[x] * axis[z] * k) - axis[y];
+        r[2][1] = (axis[y] * axis[z] * k) + axis[x];
+        r[2][2] = (axis[z] * axis[z] * k) + cosA;
+    }
 
     //
     // Member Functions
@@ -234,35 +343,21 @@ namespace Geometry
     Matrix4<Scalar> Matrix4<Scalar>::RotationFromEuler(const VectorN<Scalar,3>& r)
     {
         Matrix4<Scalar> result(uninitialised);
-        result.RotationFromEuler(r);
+        result.BecomeRotationFromEuler(r);
         return result;
     }
 
     template< typename Scalar>
     void Matrix4<Scalar>::BecomeRotationFromEuler(const VectorN<Scalar,3>& r)
     {
-        Scalar A = Cos(r.Get(0));
-        Scalar B = Sin(r.Get(0));
-        Scalar C = Cos(r.Get(1));
-        Scalar D = Sin(r.Get(1));
-        Scalar E = Cos(r.Get(2));
-        Scalar F = Sin(r.Get(2));
-
-        Scalar AD      =   A * D;
-        Scalar BD      =   B * D;
-
-        this->mData[0]  =   C * E;
-        this->mData[1]  =  -C * F;
-        this->mData[2]  =   D;
-        this->mData[4]  =  BD * E + A * F;
-        this->mData[5]  = -BD * F + A * E;
-        this->mData[6]  =  -B * C;
-        this->mData[8]  = -AD * E + B * F;
-        this->mData[9]  =  AD * F + B * E;
-        this->mData[10] =   A * C;
-
-        this->mData[3]  =  this->mData[7] = this->mData[11] = this->mData[12] = this->mData[13] = this->mData[14] = 0;
-        this->mData[15] =  1;
+        Scalar s[3], c[3];
+        SinCos( r.Get(0), &s[0], &c[0] );
+        SinCos( r.Get(1), &s[1], &c[1] );
+        SinCos( r.Get(2), &s[2], &c[2] );
+
+        Scalar m[3][3];
+        ComputeEulerRotation( s, c, m );
+        SetRotation( *this, m );
     }
 
     // static
@@ -277,25 +372,12 @@ namespace Geometry
     template< typename Scalar>
     void Matrix4<Scalar>::BecomeRotationAround(const VectorN<Scalar,3>& axis, Scalar r)
     {
-        const Scalar rcos = Cos(r);
-        const Scalar rsin = Sin(r);
-        const Scalar rcosr = 1-rcos;
-        (*this)[0][0] =            rcos + axis[0]*axis[0]*rcosr;
-        (*this)[1][0] =  axis[2] * rsin + axis[1]*axis[0]*rcosr;
-        //(*this)[2][0] = -axis[1] * rsin + axis[2]*axis[0]*rcosr;
-        (*this)[2][0] = 0;
-        (*this)[0][1] = -axis[2] * rsin + axis[0]*axis[1]*rcosr;
-        (*this)[1][1] =            rcos + axis[1]*axis[1]*rcosr;
-        //(*this)[2][1] =  axis[0] * rsin + axis[2]*axis[1]*rcosr;
-        (*this)[2][1] = 0;
-        (*this)[0][2] =  axis[1] * rsin + axis[0]*axis[2]*rcosr;
-        (*this)[1][2] = -axis[0] * rsin + axis[1]*axis[2]*rcosr;
-        (*this)[2][2] =            rcos + axis[2]*axis[2]*rcosr;
-        (*this)[2][3] = 0;
-        (*this)[0][3] = 0;
-        (*this)[1][3] = 0;
-        (*this)[2][3] = 0;
-        (*this)[3][3] = 1;
+        Scalar rsin, rcos;
+        SinCos( r, &rsin, &rcos );
+
+        Scalar m[3][3];
+        ComputeAxisRotation( axis, rsin, rcos, m );
+        SetRotation( *this, m );
     }
     
     // thanks to the incredible work here:
@@ -317,32 +399,72 @@ namespace Geometry
         const Vector3d<Scalar>& v1, 
         const Vector3d<Scalar>& v2)
     {
-        // vec3 axis = cross( v1, v2 );
-        auto axis = CrossProduct( v1, v2 );
+        Scalar m[3][3];
+        ComputeAlignRotation( v1, v2, m );
+        SetRotation( *this, m );
+    }
 
-        // const float cosA = dot( v1, v2 );
-        auto cosA = Vector3d<Scalar>::DotProduct( v1, v2 );
-        
-        // const float k = 1.0f / (1.0f + cosA);
-        const double k = 1.0 / (1.0 + cosA);
+    // static
+    template< typename Scalar>
+    template< Accuracy A, typename Output >
+    void Matrix4<Scalar>::RotationFromEuler(const VectorN<Scalar,3>* r, Output* result, size_t count)
+    {
+        const size_t block = 64;
+        Scalar angle[3][block], s[3][block], c[3][block];
+        for (size_t first=0;first<count;first+=block)
+        {
+            const size_t n = std::min( block, count-first );
+            for (size_t i=0;i!=n;++i)
+            {
+                angle[0][i] = r[first+i][0];
+                angle[1][i] = r[first+i][1];
+                angle[2][i] = r[first+i][2];
+            }
+            for (size_t k=0;k!=3;++k)
+                SinCos<A>( angle[k], s[k], c[k], n );
+
+            for (size_t i=0;i!=n;++i)
+            {
+                const Scalar si[3] = { s[0][i], s[1][i], s[2][i] };
+                const Scalar ci[3] = { c[0][i], c[1][i], c[2][i] };
+                Scalar m[3][3];
+                ComputeEulerRotation( si, ci, m );
+                SetRotation( result[first+i], m );
+            }
+        }
+    }
 
-        const int x=0; const int y=1; const int z=2;    
-        (*this)[0][0] = (axis[x] * axis[x] * k) + cosA;
-        (*this)[0][1] = (axis[y] * axis[x] * k) - axis[z]; 
-        (*this)[0][2] = (axis[z] * axis[x] * k) + axis[y];
-        (*this)[0][3] = 0;
-        (*this)[1][0] = (axis[x] * axis[y] * k) + axis[z];
-        (*this)[1][1] = (axis[y] * axis[y] * k) + cosA;
-        (*this)[1][2] = (axis[z] * axis[y] * k) - axis[x];
-        (*this)[1][3] = 0;
-        (*this)[2][0] = (axis[x] * axis[z] * k) - axis[y];
-        (*this)[2][1] = (axis[y] * axis[z] * k) + axis[x];
-        (*this)[2][2] = (axis[z] * axis[z] * k) + cosA;
-        (*this)[2][3] = 0;
-        (*this)[3][0] = 0;
-        (*this)[3][1] = 0;
-        (*this)[3][2] = 0;
-        (*this)[3][3] = 1;
+    // static
+    template< typename Scalar>
+    template< Accuracy A, typename Output >
+    void Matrix4<Scalar>::RotationAround(const VectorN<Scalar,3>* axis, const Scalar* r, Output* result, size_t count)
+    {
+        const size_t block = 64;
+        Scalar s[block], c[block];
+        for (size_t first=0;first<count;first+=block)
+        {
+            const size_t n = std::min( block, count-first );
+            SinCos<A>( r+first, s, c, n );
+            for (size_t i=0;i!=n;++i)
+            {
+                Scalar m[3][3];
+                ComputeAxisRotation( axis[first+i], s[i], c[i], m );
+                SetRotation( result[first+i], m );
+            }
+        }
+    }
+
+    // static
+    template< typename Scalar>
+    template< typename Output >
+    void Matrix4<Scalar>::RotationAlign(const Vector3d<Scalar>* v1, const Vector3d<Scalar>* v2, Output* result, size_t count)
+    {
+        for (size_t i=0;i!=count;++i)
+        {
+            Scalar m[3][3];
+            ComputeAlignRotation( v1[i], v2[i], m );
+            SetRotation( result[i], m );
+        }
     }
 
 }//namespace Geometry
@@ -0,0 +1,298 @@
+#ifndef GEOMETRY_MATRIX_CHAIN_H_INCLUDED_
+#define GEOMETRY_MATRIX_CHAIN_H_INCLUDED_
+
+#include "geometry_uninitialised.h"
+#include "matrixnm.h"
+#include "matrixx.h"
+#include "parallel.h"
+
+#include <cassert>
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // the cheapest order to multiply k matrices, matrix i being
+    // dims[i] x dims[i+1]. solved once per shape of chain, at compile time
+    template< size_t K >
+    class MatrixChainOrder
+    {
+    public:
+        // scalar multiplies for the product of matrices first..last inclusive
+        size_t mCost[K][K];
+        // (first..split) * (split+1..last) is the cheapest last multiply
+        size_t mSplit[K][K];
+
+        constexpr explicit MatrixChainOrder(const std::array<size_t, K+1>& dims);
+    };
+
+    // the plan for a chain of the given dimensions, one instance per shape
+    template< size_t... Dims >
+    class MatrixChain
+    {
+    public:
+        const static size_t sCount = sizeof...(Dims) - 1;
+        static constexpr std::array<size_t, sizeof...(Dims)> sDims = {{ Dims... }};
+        static constexpr MatrixChainOrder<sCount> sOrder = MatrixChainOrder<sCount>( sDims );
+
+        // scalar multiplies in the best order
+        static constexpr size_t GetCost() { return sOrder.mCost[0][sCount-1]; }
+        // scalar multiplies evaluated left to right, for comparison
+        static constexpr size_t GetLeftToRightCost();
+    };
+
+    //
+    // Free-functions
+    //
+
+    // result = lhs * rhs with the textbook shapes, (N x K) * (K x M) gives N x M.
+    // operator* on MatrixNM keeps its own shape rules, this is what the chains use
+    template< typename Scalar, size_t N, size_t K, size_t M >
+    void Multiply(const MatrixNM<Scalar, N, K>& lhs, const MatrixNM<Scalar, K, M>& rhs, MatrixNM<Scalar, N, M>& result)
+    {
+        for (size_t n=0;n!=N;++n)
+        {
+            Scalar* r = result[n];
+            const Scalar* l = lhs[n];
+            for (size_t m=0;m!=M;++m)
+                r[m] = l[0]*rhs[0][m];
+            for (size_t k=1;k!=K;++k)
+            {
+                const Scalar* rk = rhs[k];
+                for (size_t m=0;m!=M;++m)
+                    r[m] += l[k]*rk[m];
+            }
+        }
+    }
+
+    // evaluates the matrices first..last of a chain in the order the plan chose
+    template< size_t First, size_t Last, typename Chain, typename Tuple >
+    decltype(auto) MultiplyChainRange(const Tuple& matrices)
+    {
+        if constexpr (First==Last)
+        {
+            return (std::get<First>( matrices ));
+        }
+        else
+        {
+            constexpr size_t split = Chain::sOrder.mSplit[First][Last];
+            const auto& lhs = MultiplyChainRange<First, split, Chain>( matrices );
+            const auto& rhs = MultiplyChainRange<split+1, Last, Chain>( matrices );
+            typedef typename std::decay<typename std::tuple_element<First, Tuple>::type>::type FirstType;
+            typedef typename std::decay<typename std::tuple_element<Last, Tuple>::type>::type LastType;
+            MatrixNM<typename FirstType::ScalarType, FirstType::sRows, LastType::sColumns> result( uninitialised );
+            Multiply( lhs, rhs, result );
+            return result;
+        }
+    }
+
+    // m0 * m1 * ... with the textbook shapes, each matrix having as many rows
+    // as the one before has columns, parenthesised to do the fewest multiplies
+    template< typename... Matrices >
+    auto MultiplyChain(const Matrices&... matrices)
+    {
+        static_assert( sizeof...(Matrices) >= 2, "a chain needs at least two matrices" );
+        static_assert( []() {
+            constexpr size_t rows[] = { Matrices::sRows... };
+            constexpr size_t columns[] = { Matrices::sColumns... };
+            for (size_t i=1;i!=sizeof...(Matrices);++i)
+            {
+                if (columns[i-1]!=rows[i])
+                    return false;
+            }
+            return true;
+        }(), "each matrix needs as many rows as the one before has columns" );
+
+        typedef typename std::tuple_element<0, std::tuple<Matrices...>>::type FirstType;
+        typedef MatrixChain<FirstType::sRows, Matrices::sColumns...> Chain;
+        const std::tuple<const Matrices&...> tuple( matrices... );
+        return MultiplyChainRange<0, Chain::sCount-1, Chain>( tuple );
+    }
+
+    // result = lhs * rhs for square matrices by Winograd's form of Strassen,
+    // seven half size products and fifteen additions a level rather than
+    // eight products. it recurses until the halves are at most cutoff, below
+    // which the blocked Multiply is faster, so the cutoff wants tuning to the
+    // machine; a few hundred is typical for doubles. odd sizes are padded with
+    // zeros once at the top. the policy runs the seven top level products
+    // side by side. results differ from Multiply by rounding, the extra
+    // additions make it slightly less accurate
+    template< typename Scalar >
+    void MultiplyStrassen(const MatrixX<Scalar>& lhs, const MatrixX<Scalar>& rhs, MatrixX<Scalar>& result,
+        size_t cutoff = 256, const ExecutionPolicy& policy = ExecutionPolicy());
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    // the usual O(k^3) dynamic program, over chains of increasing length
+    template< size_t K >
+    constexpr MatrixChainOrder<K>::MatrixChainOrder(const std::array<size_t, K+1>& dims)
+        : mCost(), mSplit()
+    {
+        for (size_t length=2;length<=K;++length)
+        {
+            for (size_t first=0;first+length<=K;++first)
+            {
+                const size_t last = first + length - 1;
+                mCost[first][last] = ~size_t(0);
+                for (size_t split=first;split!=last;++split)
+                {
+                    const size_t cost = mCost[first][split] + mCost[split+1][last]
+                        + dims[first]*dims[split+1]*dims[last+1];
+                    if (cost < mCost[first][last])
+                    {
+                        mCost[first][last] = cost;
+                        mSplit[first][last] = split;
+                    }
+                }
+            }
+        }
+    }
+
+    // static
+    template< size_t... Dims >
+    constexpr size_t MatrixChain<Dims...>::GetLeftToRightCost()
+    {
+        size_t cost = 0;
+        for (size_t i=1;i!=sCount;++i)
+            cost += sDims[0]*sDims[i]*sDims[i+1];
+        return cost;
+    }
+
+    // one level of Strassen-Winograd on a matrix of even size
+    template< typename Scalar >
+    void MultiplyStrassenLevel(const MatrixX<Scalar>& a, const MatrixX<Scalar>& b, MatrixX<Scalar>& c,
+        size_t cutoff, const ExecutionPolicy& policy)
+    {
+        const size_t n = a.GetRows();
+        if (n<=cutoff || n%2!=0)
+        {
+            Multiply( a, b, c );
+            return;
+        }
+
+        const size_t h = n/2;
+        MatrixX<Scalar> quarters[8];
+        for (size_t q=0;q!=8;++q)
+            quarters[q] = MatrixX<Scalar>( h, h );
+        MatrixX<Scalar>& a11 = quarters[0];
+        MatrixX<Scalar>& a12 = quarters[1];
+        MatrixX<Scalar>& a21 = quarters[2];
+        MatrixX<Scalar>& a22 = quarters[3];
+        MatrixX<Scalar>& b11 = quarters[4];
+        MatrixX<Scalar>& b12 = quarters[5];
+        MatrixX<Scalar>& b21 = quarters[6];
+        MatrixX<Scalar>& b22 = quarters[7];
+        for (size_t i=0;i!=h;++i)
+        {
+            std::copy( a[i], a[i]+h, a11[i] );
+            std::copy( a[i]+h, a[i]+n, a12[i] );
+            std::copy( a[i+h], a[i+h]+h, a21[i] );
+            std::copy( a[i+h]+h, a[i+h]+n, a22[i] );
+            std::copy( b[i], b[i]+h, b11[i] );
+            std::copy( b[i]+h, b[i]+n, b12[i] );
+            std::copy( b[i+h], b[i+h]+h, b21[i] );
+            std::copy( b[i+h]+h, b[i+h]+n, b22[i] );
+        }
+
+        const MatrixX<Scalar> s1 = a21 + a22;
+        const MatrixX<Scalar> s2 = s1 - a11;
+        const MatrixX<Scalar> s3 = a11 - a21;
+        const MatrixX<Scalar> s4 = a12 - s2;
+        const MatrixX<Scalar> t1 = b12 - b11;
+        const MatrixX<Scalar> t2 = b22 - t1;
+        const MatrixX<Scalar> t3 = b22 - b12;
+        const MatrixX<Scalar> t4 = t2 - b21;
+
+        const MatrixX<Scalar>* lhs[7] = { &a11, &a12, &s4, &a22, &s1, &s2, &s3 };
+        const MatrixX<Scalar>* rhs[7] = { &b11, &b21, &b22, &t4, &t1, &t2, &t3 };
+        MatrixX<Scalar> m[7];
+        ParallelFor( policy.WithGrain(1), 0, 7, [&](size_t first, size_t last) {
+            for (size_t i=first;i!=last;++i)
+                MultiplyStrassenLevel( *lhs[i], *rhs[i], m[i], cutoff, ExecutionPolicy() );
+        } );
+
+        // u2 = m1 + m6, u3 = u2 + m7, u4 = u2 + m5
+        // c11 = m1 + m2, c12 = u4 + m3, c21 = u3 - m4, c22 = u3 + m5
+        if (c.GetRows()!=n || c.GetColumns()!=n)
+            c = MatrixX<Scalar>( n, n );
+        for (size_t i=0;i!=h;++i)
+        {
+            const Scalar* m1 = m[0][i];
+            const Scalar* m2 = m[1][i];
+            const Scalar* m3 = m[2][i];
+            const Scalar* m4 = m[3][i];
+            const Scalar* m5 = m[4][i];
+            const Scalar* m6 = m[5][i];
+            const Scalar* m7 = m[6][i];
+            Scalar* c1 = c[i];
+            Scalar* c2 = c[i+h];
+            for (size_t j=0;j!=h;++j)
+            {
+                const Scalar u2 = m1[j] + m6[j];
+                const Scalar u3 = u2 + m7[j];
+                c1[j] = m1[j] + m2[j];
+                c1[j+h] = u2 + m5[j] + m3[j];
+                c2[j] = u3 - m4[j];
+                c2[j+h] = u3 + m5[j];
+            }
+        }
+    }
+
+    template< typename Scalar >
+    void MultiplyStrassen(const MatrixX<Scalar>& lhs, const MatrixX<Scalar>& rhs, MatrixX<Scalar>& result,
+        size_t cutoff, const ExecutionPolicy& policy)
+    {
+        assert( lhs.GetRows()==lhs.GetColumns() && rhs.GetRows()==rhs.GetColumns() );
+        assert( lhs.GetRows()==rhs.GetRows() );
+        assert( &result!=&lhs && &result!=&rhs );
+        assert( cutoff>0 );
+        const size_t n = lhs.GetRows();
+        if (n<=cutoff)
+        {
+            Multiply( lhs, rhs, result, policy );
+            return;
+        }
+
+        // round up so every level halves evenly down to the cutoff
+        size_t levels = 0;
+        size_t base = n;
+        while (base>cutoff)
+        {
+            base = (base+1)/2;
+            ++levels;
+        }
+        const size_t padded = base << levels;
+        if (padded==n)
+        {
+            MultiplyStrassenLevel( lhs, rhs, result, cutoff, policy );
+            return;
+        }
+
+        MatrixX<Scalar> a( padded, padded );
+        MatrixX<Scalar> b( padded, padded );
+        for (size_t i=0;i!=n;++i)
+        {
+            std::copy( lhs[i], lhs[i]+n, a[i] );
+            std::copy( rhs[i], rhs[i]+n, b[i] );
+        }
+        MatrixX<Scalar> c;
+        MultiplyStrassenLevel( a, b, c, cutoff, policy );
+
+        if (result.GetRows()!=n || result.GetColumns()!=n)
+            result = MatrixX<Scalar>( n, n );
+        for (size_t i=0;i!=n;++i)
+            std::copy( c[i], c[i]+n, result[i] );
+    }
+}
+
+#endif//GEOMETRY_MATRIX_CHAIN_H_INCLUDED_
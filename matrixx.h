@@ -0,0 +1,384 @@
+#ifndef GEOMETRY_MATRIXX_H_INCLUDED_
+#define GEOMETRY_MATRIXX_H_INCLUDED_
+
+#include "matrixnm.h"
+#include "vectorx.h"
+#include "parallel.h"
+
+#include <cassert>
+#include <initializer_list>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // MatrixNM with its size chosen at runtime: N rows of M columns stored
+    // row-major, [n][m] / [row][column], (N x K) * (K x M) gives N x M.
+    // as with MatrixN, matrix * vector treats the vector as a row,
+    // MultiplyColumn is there for the textbook column product.
+    // conversion to and from the fixed size types copies
+    template< typename Scalar >
+    class MatrixX
+    {
+    public:
+        typedef Scalar ScalarType;
+        typedef MatrixX<Scalar> MatrixType;
+        typedef VectorX<Scalar> VectorType;
+
+        // tile edge for the blocked multiply, three tiles of doubles fit in L1
+        const static size_t sBlockSize = 48;
+
+        // empty
+        MatrixX();
+
+        // zero filled. there is no uninitialised form, std::vector
+        // value-initialises whatever it is asked for
+        MatrixX(size_t rows, size_t columns);
+
+        // row-major data, rows*columns values
+        MatrixX(size_t rows, size_t columns, std::initializer_list<Scalar> data);
+
+        // from a fixed size matrix
+        template< size_t N, size_t M >
+        explicit MatrixX(const MatrixNM<Scalar, N, M>& rhs);
+
+        static MatrixX Identity(size_t size);
+
+        size_t GetRows() const;
+        size_t GetColumns() const;
+
+        // copies out to a fixed size matrix of the same size
+        template< size_t N, size_t M >
+        void ComputeFixed(MatrixNM<Scalar, N, M>& result) const;
+
+        // simple accessors
+        void Set (size_t n, size_t m, Scalar value);
+        Scalar* operator[] (size_t n);
+
+        Scalar Get (size_t n, size_t m) const;
+        const Scalar* operator[] (size_t n) const;
+
+        Scalar* GetData();
+        const Scalar* GetData() const;
+
+        // binary operators
+        MatrixX& operator += (const MatrixX& rhs);
+        MatrixX& operator -= (const MatrixX& rhs);
+        MatrixX& operator *= (const Scalar rhs);
+        bool operator == (const MatrixX& rhs) const;
+        bool operator != (const MatrixX& rhs) const;
+        bool Equals (const MatrixX& rhs, Scalar epsilon) const;
+
+        MatrixX GetTranspose() const;
+
+    private:
+        size_t mRows;
+        size_t mColumns;
+        std::vector<Scalar> mData;
+    };
+
+    //
+    // Free-functions
+    //
+
+    // result = lhs * rhs, tiled so each tile of rhs is reused from cache
+    // across a tile of lhs rows. the policy splits the work by bands of
+    // result rows, each element is summed in the same order either way.
+    // result must not alias either input
+    template< typename Scalar >
+    void Multiply(const MatrixX<Scalar>& lhs, const MatrixX<Scalar>& rhs, MatrixX<Scalar>& result,
+        const ExecutionPolicy& policy = ExecutionPolicy())
+    {
+        assert( lhs.GetColumns()==rhs.GetRows() );
+        assert( &result!=&lhs && &result!=&rhs );
+        const size_t rows = lhs.GetRows();
+        const size_t columns = rhs.GetColumns();
+        const size_t inner = lhs.GetColumns();
+        const size_t block = MatrixX<Scalar>::sBlockSize;
+
+        if (result.GetRows()!=rows || result.GetColumns()!=columns)
+            result = MatrixX<Scalar>( rows, columns );
+
+        const Scalar* a = lhs.GetData();
+        const Scalar* b = rhs.GetData();
+        Scalar* c = result.GetData();
+        ParallelFor( policy.WithGrain(block), 0, rows, [=](size_t first, size_t last) {
+            std::fill( c + first*columns, c + last*columns, Scalar(0) );
+            for (size_t kk=0;kk<inner;kk+=block)
+            {
+                const size_t kEnd = std::min( kk+block, inner );
+                for (size_t jj=0;jj<columns;jj+=block)
+                {
+                    const size_t jEnd = std::min( jj+block, columns );
+                    for (size_t i=first;i!=last;++i)
+                    {
+                        // i-k-j order, the innermost loop streams along rows of rhs and result
+                        Scalar* ci = c + i*columns;
+                        for (size_t k=kk;k!=kEnd;++k)
+                        {
+                            const Scalar aik = a[i*inner+k];
+                            const Scalar* bk = b + k*columns;
+                            for (size_t j=jj;j!=jEnd;++j)
+                                ci[j] += aik * bk[j];
+                        }
+                    }
+                }
+            }
+        } );
+    }
+
+    // result = lhs * rhs with rhs as a column, result[n] = sum lhs[n][m]*rhs[m]
+    template< typename Scalar >
+    void MultiplyColumn(const MatrixX<Scalar>& lhs, const VectorX<Scalar>& rhs, VectorX<Scalar>& result,
+        const ExecutionPolicy& policy = ExecutionPolicy())
+    {
+        assert( lhs.GetColumns()==rhs.GetSize() );
+        assert( &result!=&rhs );
+        if (result.GetSize()!=lhs.GetRows())
+            result = VectorX<Scalar>( lhs.GetRows() );
+
+        const size_t columns = lhs.GetColumns();
+        ParallelFor( policy.WithGrain(MatrixX<Scalar>::sBlockSize), 0, lhs.GetRows(),
+            [&](size_t first, size_t last) {
+                for (size_t n=first;n!=last;++n)
+                {
+                    const Scalar* row = lhs[n];
+                    Scalar sum = 0;
+                    for (size_t m=0;m!=columns;++m)
+                        sum += row[m] * rhs[m];
+                    result[n] = sum;
+                }
+            } );
+    }
+
+    // rhs as a row, result[m] = sum lhs[n][m]*rhs[n], the MatrixN * VectorN product.
+    // the policy splits by bands of result elements, each band walks down the rows
+    template< typename Scalar >
+    void MultiplyRow(const MatrixX<Scalar>& lhs, const VectorX<Scalar>& rhs, VectorX<Scalar>& result,
+        const ExecutionPolicy& policy = ExecutionPolicy())
+    {
+        assert( lhs.GetRows()==rhs.GetSize() );
+        assert( &result!=&rhs );
+        if (result.GetSize()!=lhs.GetColumns())
+            result = VectorX<Scalar>( lhs.GetColumns() );
+
+        const size_t rows = lhs.GetRows();
+        Scalar* r = result.GetData();
+        ParallelFor( policy.WithGrain(MatrixX<Scalar>::sBlockSize), 0, lhs.GetColumns(),
+            [&, r](size_t first, size_t last) {
+                std::fill( r + first, r + last, Scalar(0) );
+                for (size_t n=0;n!=rows;++n)
+                {
+                    const Scalar* row = lhs[n];
+                    const Scalar v = rhs[n];
+                    for (size_t m=first;m!=last;++m)
+                        r[m] += row[m] * v;
+                }
+            } );
+    }
+
+    template< typename Scalar >
+    MatrixX<Scalar> operator* (const MatrixX<Scalar>& lhs, const MatrixX<Scalar>& rhs)
+    {
+        MatrixX<Scalar> result;
+        Multiply( lhs, rhs, result );
+        return result;
+    }
+
+    // rhs as a row, as MatrixN * VectorN
+    template< typename Scalar >
+    VectorX<Scalar> operator* (const MatrixX<Scalar>& lhs, const VectorX<Scalar>& rhs)
+    {
+        VectorX<Scalar> result;
+        MultiplyRow( lhs, rhs, result );
+        return result;
+    }
+
+    template< typename Scalar >
+    MatrixX<Scalar> operator+ (MatrixX<Scalar> lhs, const MatrixX<Scalar>& rhs)
+    {
+        lhs += rhs;
+        return lhs;
+    }
+
+    template< typename Scalar >
+    MatrixX<Scalar> operator- (MatrixX<Scalar> lhs, const MatrixX<Scalar>& rhs)
+    {
+        lhs -= rhs;
+        return lhs;
+    }
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template< typename Scalar >
+    MatrixX<Scalar>::MatrixX()
+        : mRows(0), mColumns(0)
+    {
+    }
+
+    template< typename Scalar >
+    MatrixX<Scalar>::MatrixX(size_t rows, size_t columns)
+        : mRows(rows), mColumns(columns), mData(rows*columns, Scalar(0))
+    {
+    }
+
+    template< typename Scalar >
+    MatrixX<Scalar>::MatrixX(size_t rows, size_t columns, std::initializer_list<Scalar> data)
+        : mRows(rows), mColumns(columns), mData(data)
+    {
+        assert( data.size()==rows*columns );
+    }
+
+    template< typename Scalar >
+    template< size_t N, size_t M >
+    MatrixX<Scalar>::MatrixX(const MatrixNM<Scalar, N, M>& rhs)
+        : mRows(N), mColumns(M), mData(rhs[0], rhs[0]+N*M)
+    {
+    }
+
+    // static
+    template< typename Scalar >
+    MatrixX<Scalar> MatrixX<Scalar>::Identity(size_t size)
+    {
+        MatrixX result(size, size);
+        for (size_t i=0;i!=size;++i)
+            result[i][i] = 1;
+        return result;
+    }
+
+    template< typename Scalar >
+    size_t MatrixX<Scalar>::GetRows() const
+    {
+        return mRows;
+    }
+
+    template< typename Scalar >
+    size_t MatrixX<Scalar>::GetColumns() const
+    {
+        return mColumns;
+    }
+
+    template< typename Scalar >
+    template< size_t N, size_t M >
+    void MatrixX<Scalar>::ComputeFixed(MatrixNM<Scalar, N, M>& result) const
+    {
+        assert( mRows==N && mColumns==M );
+        std::copy( mData.begin(), mData.end(), result[0] );
+    }
+
+    template< typename Scalar >
+    void MatrixX<Scalar>::Set(size_t n, size_t m, Scalar value)
+    {
+        assert( n<mRows );
+        assert( m<mColumns );
+        mData[n*mColumns+m]=value;
+    }
+
+    template< typename Scalar >
+    Scalar* MatrixX<Scalar>::operator[] (size_t n)
+    {
+        assert( n<mRows );
+        return &mData[n*mColumns];
+    }
+
+    template< typename Scalar >
+    Scalar MatrixX<Scalar>::Get(size_t n, size_t m) const
+    {
+        assert( n<mRows );
+        assert( m<mColumns );
+        return mData[n*mColumns+m];
+    }
+
+    template< typename Scalar >
+    const Scalar* MatrixX<Scalar>::operator[] (size_t n) const
+    {
+        assert( n<mRows );
+        return &mData[n*mColumns];
+    }
+
+    template< typename Scalar >
+    Scalar* MatrixX<Scalar>::GetData()
+    {
+        return mData.data();
+    }
+
+    template< typename Scalar >
+    const Scalar* MatrixX<Scalar>::GetData() const
+    {
+        return mData.data();
+    }
+
+    template< typename Scalar >
+    MatrixX<Scalar>& MatrixX<Scalar>::operator += (const MatrixX& rhs)
+    {
+        assert( mRows==rhs.mRows && mColumns==rhs.mColumns );
+        for (size_t i=0;i!=mData.size();++i)
+            mData[i] += rhs.mData[i];
+        return *this;
+    }
+
+    template< typename Scalar >
+    MatrixX<Scalar>& MatrixX<Scalar>::operator -= (const MatrixX& rhs)
+    {
+        assert( mRows==rhs.mRows && mColumns==rhs.mColumns );
+        for (size_t i=0;i!=mData.size();++i)
+            mData[i] -= rhs.mData[i];
+        return *this;
+    }
+
+    template< typename Scalar >
+    MatrixX<Scalar>& MatrixX<Scalar>::operator *= (const Scalar rhs)
+    {
+        for (auto& d : mData)
+            d *= rhs;
+        return *this;
+    }
+
+    template< typename Scalar >
+    bool MatrixX<Scalar>::operator == (const MatrixX& rhs) const
+    {
+        return mRows==rhs.mRows && mColumns==rhs.mColumns && mData==rhs.mData;
+    }
+
+    template< typename Scalar >
+    bool MatrixX<Scalar>::operator != (const MatrixX& rhs) const
+    {
+        return !(*this==rhs);
+    }
+
+    // as MatrixNM::Equals, the squared distance between the element arrays
+    template< typename Scalar >
+    bool MatrixX<Scalar>::Equals (const MatrixX& rhs, Scalar epsilon) const
+    {
+        assert( mRows==rhs.mRows && mColumns==rhs.mColumns );
+        Scalar l2 = 0;
+        for (size_t i=0;i!=mData.size();++i)
+        {
+            const Scalar d = rhs.mData[i] - mData[i];
+            l2 += d*d;
+        }
+        return l2 < epsilon;
+    }
+
+    template< typename Scalar >
+    MatrixX<Scalar> MatrixX<Scalar>::GetTranspose() const
+    {
+        MatrixX r(mColumns, mRows);
+        // in tiles so neither side strides through memory a whole row at a time
+        for (size_t nn=0;nn<mRows;nn+=sBlockSize)
+            for (size_t mm=0;mm<mColumns;mm+=sBlockSize)
+                for (size_t n=nn;n!=std::min(nn+sBlockSize, mRows);++n)
+                    for (size_t m=mm;m!=std::min(mm+sBlockSize, mColumns);++m)
+                        r.mData[m*mRows+n] = mData[n*mColumns+m];
+        return r;
+    }
+}
+
+#endif//GEOMETRY_MATRIXX_H_INCLUDED_
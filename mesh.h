@@ -0,0 +1,331 @@
+#ifndef GEOMETRY_MESH_H_INCLUDED_
+#define GEOMETRY_MESH_H_INCLUDED_
+
+#include "vector3d.h"
+#include "triangle3d.h"
+#include "aabb3d.h"
+#include "parallel.h"
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // triangle mesh with a shared vertex buffer and a flat index buffer,
+    // three indices per face. batch functions take a [first,last) face range
+    // so callers can split the work across threads.
+    template <typename Scalar>
+    class IndexedMesh
+    {
+        public:
+            typedef Vector3d<Scalar> VectorType;
+            typedef typename VectorType::BaseType VectorBase;
+            typedef Triangle3d<Scalar> TriangleType;
+            typedef AxisAlignedBoundingBox3d<Scalar> BoundsType;
+            typedef uint32_t IndexType;
+
+            IndexedMesh();
+            IndexedMesh(const std::vector<VectorType>& vertices, const std::vector<IndexType>& indices);
+
+            size_t GetVertexCount() const;
+            size_t GetFaceCount() const;
+
+            const VectorType& GetVertex(size_t v) const;
+            void SetVertex(size_t v, const VectorBase& p);
+            const std::vector<VectorType>& GetVertices() const;
+            const std::vector<IndexType>& GetIndices() const;
+
+            IndexType AddVertex(const VectorBase& p);
+            void AddFace(IndexType a, IndexType b, IndexType c);
+
+            // builds a stand-alone copy of a face
+            TriangleType GetFace(size_t f) const;
+
+            // unit face normals for faces [first,last), written to result[0..last-first)
+            void ComputeFaceNormals(size_t first, size_t last, VectorType* result) const;
+            void ComputeFaceNormals(std::vector<VectorType>& result) const;
+            void ComputeFaceNormals(std::vector<VectorType>& result, const ExecutionPolicy& policy) const;
+
+            // face areas for faces [first,last), written to result[0..last-first)
+            void ComputeFaceAreas(size_t first, size_t last, Scalar* result) const;
+
+            // adds the area weighted (unnormalised) normal of faces [first,last)
+            // to the vertex normals in result, which must hold GetVertexCount() entries
+            void AccumulateVertexNormals(size_t first, size_t last, VectorType* result) const;
+
+            // area weighted unit vertex normals, unreferenced vertices get a zero normal
+            void ComputeVertexNormals(std::vector<VectorType>& result) const;
+
+            Scalar ComputeSurfaceArea(size_t first, size_t last) const;
+            Scalar GetSurfaceArea() const;
+
+            // summed per chunk of faces, so the result depends on the policy's
+            // grain but not on the thread count; may differ from GetSurfaceArea()
+            // in the last bits
+            Scalar GetSurfaceArea(const ExecutionPolicy& policy) const;
+
+            // bounds of the vertices referenced by faces [first,last). an
+            // empty range gives the inverted box, min bound at the largest
+            // Scalar and max bound at the lowest, and returns false
+            bool ComputeBounds(size_t first, size_t last, BoundsType& result) const;
+            // the inverted box for a mesh with no faces
+            BoundsType GetBounds() const;
+
+            // identical to GetBounds() for any policy
+            BoundsType GetBounds(const ExecutionPolicy& policy) const;
+
+        private:
+            // twice the area, in the direction of the face normal
+            VectorType GetFaceCross(size_t f) const;
+
+            std::vector<VectorType> mVertices;
+            std::vector<IndexType> mIndices;
+    };
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template <typename Scalar>
+    IndexedMesh<Scalar>::IndexedMesh()
+    {
+    }
+
+    template <typename Scalar>
+    IndexedMesh<Scalar>::IndexedMesh(const std::vector<VectorType>& vertices, const std::vector<IndexType>& indices)
+        : mVertices(vertices)
+        , mIndices(indices)
+    {
+        assert( mIndices.size()%3 == 0 );
+    }
+
+    template <typename Scalar>
+    size_t IndexedMesh<Scalar>::GetVertexCount() const
+    {
+        return mVertices.size();
+    }
+
+    template <typename Scalar>
+    size_t IndexedMesh<Scalar>::GetFaceCount() const
+    {
+        return mIndices.size()/3;
+    }
+
+    template <typename Scalar>
+    const typename IndexedMesh<Scalar>::VectorType& IndexedMesh<Scalar>::GetVertex(size_t v) const
+    {
+        assert( v<mVertices.size() );
+        return mVertices[v];
+    }
+
+    template <typename Scalar>
+    void IndexedMesh<Scalar>::SetVertex(size_t v, const VectorBase& p)
+    {
+        assert( v<mVertices.size() );
+        mVertices[v] = p;
+    }
+
+    template <typename Scalar>
+    const std::vector<typename IndexedMesh<Scalar>::VectorType>& IndexedMesh<Scalar>::GetVertices() const
+    {
+        return mVertices;
+    }
+
+    template <typename Scalar>
+    const std::vector<typename IndexedMesh<Scalar>::IndexType>& IndexedMesh<Scalar>::GetIndices() const
+    {
+        return mIndices;
+    }
+
+    template <typename Scalar>
+    typename IndexedMesh<Scalar>::IndexType IndexedMesh<Scalar>::AddVertex(const VectorBase& p)
+    {
+        mVertices.push_back( VectorType(p) );
+        return IndexType(mVertices.size()-1);
+    }
+
+    template <typename Scalar>
+    void IndexedMesh<Scalar>::AddFace(IndexType a, IndexType b, IndexType c)
+    {
+        assert( a<mVertices.size() && b<mVertices.size() && c<mVertices.size() );
+        mIndices.push_back(a);
+        mIndices.push_back(b);
+        mIndices.push_back(c);
+    }
+
+    template <typename Scalar>
+    typename IndexedMesh<Scalar>::TriangleType IndexedMesh<Scalar>::GetFace(size_t f) const
+    {
+        assert( f<GetFaceCount() );
+        return TriangleType(
+            mVertices[mIndices[f*3+0]],
+            mVertices[mIndices[f*3+1]],
+            mVertices[mIndices[f*3+2]] );
+    }
+
+    template <typename Scalar>
+    typename IndexedMesh<Scalar>::VectorType IndexedMesh<Scalar>::GetFaceCross(size_t f) const
+    {
+        const VectorType& a = mVertices[mIndices[f*3+0]];
+        const VectorType& b = mVertices[mIndices[f*3+1]];
+        const VectorType& c = mVertices[mIndices[f*3+2]];
+        return CrossProduct( VectorType(b - a), VectorType(c - a) );
+    }
+
+    template <typename Scalar>
+    void IndexedMesh<Scalar>::ComputeFaceNormals(size_t first, size_t last, VectorType* result) const
+    {
+        assert( first<=last && last<=GetFaceCount() );
+        for (size_t f=first;f!=last;++f)
+        {
+            VectorType n = GetFaceCross(f);
+            n.Normalise();
+            result[f-first] = n;
+        }
+    }
+
+    template <typename Scalar>
+    void IndexedMesh<Scalar>::ComputeFaceNormals(std::vector<VectorType>& result) const
+    {
+        result.resize( GetFaceCount(), VectorType(0,0,0) );
+        ComputeFaceNormals( 0, GetFaceCount(), result.data() );
+    }
+
+    template <typename Scalar>
+    void IndexedMesh<Scalar>::ComputeFaceNormals(std::vector<VectorType>& result, const ExecutionPolicy& policy) const
+    {
+        result.resize( GetFaceCount(), VectorType(0,0,0) );
+        VectorType* out = result.data();
+        ParallelFor( policy, 0, GetFaceCount(),
+            [this, out](size_t begin, size_t end) { ComputeFaceNormals( begin, end, out+begin ); } );
+    }
+
+    template <typename Scalar>
+    void IndexedMesh<Scalar>::ComputeFaceAreas(size_t first, size_t last, Scalar* result) const
+    {
+        assert( first<=last && last<=GetFaceCount() );
+        for (size_t f=first;f!=last;++f)
+        {
+            result[f-first] = GetFaceCross(f).Length() / 2;
+        }
+    }
+
+    template <typename Scalar>
+    void IndexedMesh<Scalar>::AccumulateVertexNormals(size_t first, size_t last, VectorType* result) const
+    {
+        assert( first<=last && last<=GetFaceCount() );
+        for (size_t f=first;f!=last;++f)
+        {
+            // the cross product length is proportional to the face area,
+            // so summing them unnormalised gives the area weighting for free
+            const VectorType n = GetFaceCross(f);
+            result[mIndices[f*3+0]] += n;
+            result[mIndices[f*3+1]] += n;
+            result[mIndices[f*3+2]] += n;
+        }
+    }
+
+    template <typename Scalar>
+    void IndexedMesh<Scalar>::ComputeVertexNormals(std::vector<VectorType>& result) const
+    {
+        result.assign( GetVertexCount(), VectorType(0,0,0) );
+        AccumulateVertexNormals( 0, GetFaceCount(), result.data() );
+        for (auto& n : result)
+        {
+            if (n.LengthSquare() > 0)
+                n.Normalise();
+        }
+    }
+
+    template <typename Scalar>
+    Scalar IndexedMesh<Scalar>::ComputeSurfaceArea(size_t first, size_t last) const
+    {
+        assert( first<=last && last<=GetFaceCount() );
+        Scalar result = 0;
+        for (size_t f=first;f!=last;++f)
+        {
+            result += GetFaceCross(f).Length();
+        }
+        return result / 2;
+    }
+
+    template <typename Scalar>
+    Scalar IndexedMesh<Scalar>::GetSurfaceArea() const
+    {
+        return ComputeSurfaceArea( 0, GetFaceCount() );
+    }
+
+    template <typename Scalar>
+    Scalar IndexedMesh<Scalar>::GetSurfaceArea(const ExecutionPolicy& policy) const
+    {
+        return ParallelReduce( policy, 0, GetFaceCount(), Scalar(0),
+            [this](size_t begin, size_t end) { return ComputeSurfaceArea( begin, end ); },
+            [](Scalar a, Scalar b) { return a + b; } );
+    }
+
+    template <typename Scalar>
+    bool IndexedMesh<Scalar>::ComputeBounds(size_t first, size_t last, BoundsType& result) const
+    {
+        assert( first<=last && last<=GetFaceCount() );
+        if (first==last)
+        {
+            // lowest rather than -max, which would wrap for an unsigned Scalar
+            const Scalar big = std::numeric_limits<Scalar>::max();
+            const Scalar small = std::numeric_limits<Scalar>::lowest();
+            result = BoundsType( VectorType( big, big, big ), VectorType( small, small, small ) );
+            return false;
+        }
+        result = BoundsType( mVertices[mIndices[first*3]] );
+        for (size_t i=first*3;i!=last*3;++i)
+        {
+            result.ExpandToContain( mVertices[mIndices[i]] );
+        }
+        return true;
+    }
+
+    template <typename Scalar>
+    typename IndexedMesh<Scalar>::BoundsType IndexedMesh<Scalar>::GetBounds() const
+    {
+        BoundsType result(uninitialised);
+        ComputeBounds( 0, GetFaceCount(), result );
+        return result;
+    }
+
+    template <typename Scalar>
+    typename IndexedMesh<Scalar>::BoundsType IndexedMesh<Scalar>::GetBounds(const ExecutionPolicy& policy) const
+    {
+        const Scalar big = std::numeric_limits<Scalar>::max();
+        const Scalar small = std::numeric_limits<Scalar>::lowest();
+        const VectorType lo( big, big, big );
+        const VectorType hi( small, small, small );
+
+        // every chunk's max bound is already nudged past its largest vertex,
+        // and the nudge is monotonic, so plain min/max of the chunk boxes
+        // lands on exactly the box a single sequential pass builds. no faces
+        // leaves the identity, the same inverted box
+        return ParallelReduce( policy, 0, GetFaceCount(), BoundsType( lo, hi ),
+            [this](size_t begin, size_t end) {
+                BoundsType box(uninitialised);
+                ComputeBounds( begin, end, box );
+                return box;
+            },
+            [](const BoundsType& a, const BoundsType& b) {
+                VectorType minBound( a.GetMinBound() ), maxBound( a.GetMaxBound() );
+                for (size_t d=0;d!=3;++d)
+                {
+                    minBound[d] = std::min( minBound[d], b.GetMinBound()[d] );
+                    maxBound[d] = std::max( maxBound[d], b.GetMaxBound()[d] );
+                }
+                return BoundsType( minBound, maxBound );
+            } );
+    }
+}
+
+#endif//GEOMETRY_MESH_H_INCLUDED_
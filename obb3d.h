@@ -0,0 +1,599 @@
+#ifndef GEOMETRY_OBB3D_H_INCLUDED_
+#define GEOMETRY_OBB3D_H_INCLUDED_
+
+#include "vector3d.h"
+#include "matrixn.h"
+#include "matrix4.h"
+#include "aabb3d.h"
+#include "parallel.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // a box about mCenter spanning +-mHalfExtents[k] along its k'th axis.
+    // the axes are the rows of the rotation, as Matrix4( x, y, z ) lays
+    // them out, and should be orthonormal
+    template <typename Scalar>
+    class OrientedBoundingBox3d
+    {
+        public:
+            typedef Vector3d<Scalar> VectorType;
+            typedef typename VectorType::BaseType VectorBase;
+            typedef MatrixN<Scalar,3> RotationType;
+            typedef AxisAlignedBoundingBox3d<Scalar> BoundsType;
+
+            // center, half extents, rotation then the box packed as scalars,
+            // as the batch functions read them
+            const static size_t sPackedSize = 15;
+
+            OrientedBoundingBox3d( const Uninitialised& )
+                : mCenter(uninitialised), mHalfExtents(uninitialised), mRotation(uninitialised)
+            { }
+
+            OrientedBoundingBox3d(const VectorBase& center, const VectorBase& halfExtents, const RotationType& rotation);
+            // the rotation in the upper left of a Matrix4, the rest ignored
+            OrientedBoundingBox3d(const VectorBase& center, const VectorBase& halfExtents, const Matrix4<Scalar>& rotation);
+            explicit OrientedBoundingBox3d(const BoundsType& box);
+
+            const VectorType& GetCenter() const;
+            const VectorType& GetHalfExtents() const;
+            const RotationType& GetRotation() const;
+            VectorType GetAxis(size_t k) const;
+            Scalar GetVolume() const;
+
+            bool Contains(const VectorBase& p) const;
+
+            // separating axis test over the three face normals of each box
+            // and the nine cross products of their edges. touching counts
+            bool Intersects(const OrientedBoundingBox3d& rhs) const;
+
+            // the smallest axis aligned box holding this one
+            void ComputeBounds(BoundsType& result) const;
+            BoundsType GetBounds() const;
+
+            void Pack(Scalar packed[sPackedSize]) const;
+
+        private:
+            VectorType mCenter;
+            VectorType mHalfExtents;
+            RotationType mRotation;
+    };
+
+    // oriented boxes structure-of-arrays: one contiguous array per packed
+    // scalar, so the batch tests read straight lines of them
+    template <typename Scalar>
+    class OrientedBoundingBoxArray
+    {
+        public:
+            typedef OrientedBoundingBox3d<Scalar> BoxType;
+            const static size_t sPackedSize = BoxType::sPackedSize;
+
+            OrientedBoundingBoxArray();
+
+            size_t GetSize() const;
+            void Reserve(size_t count);
+
+            void Add(const BoxType& box);
+            BoxType Get(size_t i) const;
+
+            // packed scalar k of every box, see OrientedBoundingBox3d::Pack
+            const Scalar* GetPacked(size_t k) const;
+
+        private:
+            std::vector<Scalar> mData[sPackedSize];
+    };
+
+    //
+    // Free-functions
+    //
+
+    // the separating axis test on two packed boxes. no early out, so it
+    // costs the same for every pair and runs branch free inside a loop
+    template <typename Scalar>
+    inline bool OBB_IsSeparated(const Scalar a[15], const Scalar b[15])
+    {
+        // Gottschalk, Lin and Manocha, "OBBTree", 1996, as laid out in
+        // Ericson's Real-Time Collision Detection 4.4.1. everything in the
+        // frame of a, the slack keeps near parallel edges from giving a
+        // cross product axis made of rounding
+        const Scalar slack = 16 * std::numeric_limits<Scalar>::epsilon();
+        const Scalar* ea = a+3;
+        const Scalar* eb = b+3;
+        const Scalar* ua = a+6;
+        const Scalar* ub = b+6;
+
+        Scalar r[3][3], ar[3][3], t[3];
+        for (int i=0;i!=3;++i)
+        {
+            for (int j=0;j!=3;++j)
+            {
+                r[i][j] = ua[3*i]*ub[3*j] + ua[3*i+1]*ub[3*j+1] + ua[3*i+2]*ub[3*j+2];
+                ar[i][j] = Fabs( r[i][j] ) + slack;
+            }
+        }
+        const Scalar d[3] = { b[0]-a[0], b[1]-a[1], b[2]-a[2] };
+        for (int i=0;i!=3;++i)
+            t[i] = d[0]*ua[3*i] + d[1]*ua[3*i+1] + d[2]*ua[3*i+2];
+
+        bool separated = false;
+        for (int i=0;i!=3;++i)
+        {
+            const Scalar rb = eb[0]*ar[i][0] + eb[1]*ar[i][1] + eb[2]*ar[i][2];
+            separated |= Fabs( t[i] ) > ea[i] + rb;
+        }
+        for (int j=0;j!=3;++j)
+        {
+            const Scalar ra = ea[0]*ar[0][j] + ea[1]*ar[1][j] + ea[2]*ar[2][j];
+            const Scalar tb = t[0]*r[0][j] + t[1]*r[1][j] + t[2]*r[2][j];
+            separated |= Fabs( tb ) > ra + eb[j];
+        }
+        for (int i=0;i!=3;++i)
+        {
+            const int i1 = (i+1)%3, i2 = (i+2)%3;
+            for (int j=0;j!=3;++j)
+            {
+                const int j1 = (j+1)%3, j2 = (j+2)%3;
+                const Scalar ra = ea[i1]*ar[i2][j] + ea[i2]*ar[i1][j];
+                const Scalar rb = eb[j1]*ar[i][j2] + eb[j2]*ar[i][j1];
+                const Scalar tl = t[i2]*r[i1][j] - t[i1]*r[i2][j];
+                separated |= Fabs( tl ) > ra + rb;
+            }
+        }
+        return separated;
+    }
+
+    // result[i] is 1 if box first+i of boxes intersects query, 0 otherwise.
+    // the same axes as OBB_IsSeparated, but worked a block of boxes at a
+    // time and an axis at a time, reading the packed arrays in straight
+    // lines, so every inner loop is one the compiler can vectorise
+    template <typename Scalar>
+    void ComputeIntersections(const OrientedBoundingBoxArray<Scalar>& boxes, size_t first, size_t last,
+        const OrientedBoundingBox3d<Scalar>& query, uint8_t* result)
+    {
+        const size_t P = OrientedBoundingBox3d<Scalar>::sPackedSize;
+        const size_t block = 128;
+        assert( first<=last && last<=boxes.GetSize() );
+        const Scalar slack = 16 * std::numeric_limits<Scalar>::epsilon();
+        Scalar a[P];
+        query.Pack( a );
+        const Scalar* ea = a+3;
+        const Scalar* ua = a+6;
+
+        // r[i][j] is query axis i against box axis j, t the offset of the
+        // centres in the query's frame
+        Scalar r[3][3][block], t[3][block];
+        uint8_t separated[block];
+        for (size_t begin=first;begin<last;begin+=block)
+        {
+            const size_t n = std::min( block, last-begin );
+            const Scalar* b[P];
+            for (size_t k=0;k!=P;++k)
+                b[k] = boxes.GetPacked( k ) + begin;
+            const Scalar* const* eb = b+3;
+            const Scalar* const* ub = b+6;
+
+            for (int i=0;i!=3;++i)
+            {
+                const Scalar u0 = ua[3*i], u1 = ua[3*i+1], u2 = ua[3*i+2];
+                for (size_t k=0;k!=n;++k)
+                    t[i][k] = (b[0][k] - a[0])*u0 + (b[1][k] - a[1])*u1 + (b[2][k] - a[2])*u2;
+                for (int j=0;j!=3;++j)
+                {
+                    for (size_t k=0;k!=n;++k)
+                        r[i][j][k] = u0*ub[3*j][k] + u1*ub[3*j+1][k] + u2*ub[3*j+2][k];
+                }
+            }
+
+            std::fill( separated, separated+n, uint8_t(0) );
+            for (int i=0;i!=3;++i)
+            {
+                for (size_t k=0;k!=n;++k)
+                {
+                    const Scalar rb = eb[0][k]*(Fabs( r[i][0][k] ) + slack)
+                        + eb[1][k]*(Fabs( r[i][1][k] ) + slack)
+                        + eb[2][k]*(Fabs( r[i][2][k] ) + slack);
+                    separated[k] |= uint8_t( Fabs( t[i][k] ) > ea[i] + rb );
+                }
+            }
+            for (int j=0;j!=3;++j)
+            {
+                for (size_t k=0;k!=n;++k)
+                {
+                    const Scalar ra = ea[0]*(Fabs( r[0][j][k] ) + slack)
+                        + ea[1]*(Fabs( r[1][j][k] ) + slack)
+                        + ea[2]*(Fabs( r[2][j][k] ) + slack);
+                    const Scalar tb = t[0][k]*r[0][j][k] + t[1][k]*r[1][j][k] + t[2][k]*r[2][j][k];
+                    separated[k] |= uint8_t( Fabs( tb ) > ra + eb[j][k] );
+                }
+            }
+            for (int i=0;i!=3;++i)
+            {
+                const int i1 = (i+1)%3, i2 = (i+2)%3;
+                for (int j=0;j!=3;++j)
+                {
+                    const int j1 = (j+1)%3, j2 = (j+2)%3;
+                    for (size_t k=0;k!=n;++k)
+                    {
+                        const Scalar ra = ea[i1]*(Fabs( r[i2][j][k] ) + slack) + ea[i2]*(Fabs( r[i1][j][k] ) + slack);
+                        const Scalar rb = eb[j1][k]*(Fabs( r[i][j2][k] ) + slack) + eb[j2][k]*(Fabs( r[i][j1][k] ) + slack);
+                        const Scalar tl = t[i2][k]*r[i1][j][k] - t[i1][k]*r[i2][j][k];
+                        separated[k] |= uint8_t( Fabs( tl ) > ra + rb );
+                    }
+                }
+            }
+
+            for (size_t k=0;k!=n;++k)
+                result[begin-first+k] = uint8_t( !separated[k] );
+        }
+    }
+
+    // the eigenvalues of the symmetric m, largest first, and their unit
+    // eigenvectors as the rows of vectors, by cyclic Jacobi rotations
+    inline void ComputeSymmetricEigen3(const double m[3][3], double values[3], double vectors[3][3])
+    {
+        double a[3][3], v[3][3];
+        for (int i=0;i!=3;++i)
+        {
+            for (int j=0;j!=3;++j)
+            {
+                a[i][j] = m[i][j];
+                v[i][j] = i==j;
+            }
+        }
+        for (int sweep=0;sweep!=50;++sweep)
+        {
+            const double off = a[0][1]*a[0][1] + a[0][2]*a[0][2] + a[1][2]*a[1][2];
+            const double diagonal = a[0][0]*a[0][0] + a[1][1]*a[1][1] + a[2][2]*a[2][2];
+            if (!(off > 1e-30*diagonal))
+                break;
+            for (int p=0;p!=2;++p)
+            {
+                for (int q=p+1;q!=3;++q)
+                {
+                    if (a[p][q]==0)
+                        continue;
+                    // the rotation zeroing a[p][q]
+                    const double theta = (a[q][q] - a[p][p]) / (2*a[p][q]);
+                    const double t = (theta >= 0 ? 1 : -1) / (std::fabs( theta ) + std::sqrt( theta*theta + 1 ));
+                    const double c = 1 / std::sqrt( t*t + 1 );
+                    const double s = t*c;
+                    for (int k=0;k!=3;++k)
+                    {
+                        const double akp = a[k][p], akq = a[k][q];
+                        a[k][p] = c*akp - s*akq;
+                        a[k][q] = s*akp + c*akq;
+                    }
+                    for (int k=0;k!=3;++k)
+                    {
+                        const double apk = a[p][k], aqk = a[q][k];
+                        a[p][k] = c*apk - s*aqk;
+                        a[q][k] = s*apk + c*aqk;
+                    }
+                    for (int k=0;k!=3;++k)
+                    {
+                        const double vkp = v[k][p], vkq = v[k][q];
+                        v[k][p] = c*vkp - s*vkq;
+                        v[k][q] = s*vkp + c*vkq;
+                    }
+                }
+            }
+        }
+
+        int order[3] = { 0, 1, 2 };
+        std::sort( order, order+3, [&](int i, int j) { return a[i][i] > a[j][j]; } );
+        for (int k=0;k!=3;++k)
+        {
+            values[k] = a[order[k]][order[k]];
+            for (int d=0;d!=3;++d)
+                vectors[k][d] = v[d][order[k]];
+        }
+    }
+
+    // fits an oriented box to the points of [first,last): its axes are the
+    // principal axes of their covariance, largest spread first, and it is
+    // then grown to hold every point. tight for elongated and rotated
+    // clusters, though no better than an AABB for points spread evenly over
+    // a cube. the sums run in double across the policy, so the result
+    // depends only on the grain
+    template <typename Scalar, typename iterator>
+    void ComputeOrientedBoundingBox(iterator first, iterator last, OrientedBoundingBox3d<Scalar>& result,
+        const ExecutionPolicy& policy = ExecutionPolicy())
+    {
+        typedef VectorN<Scalar,3> VectorBase;
+        assert( first!=last );
+        const size_t count = size_t( last - first );
+
+        struct Sums
+        {
+            double mValue[6];
+        };
+        auto add = [](const Sums& a, const Sums& b) {
+            Sums s;
+            for (int k=0;k!=6;++k)
+                s.mValue[k] = a.mValue[k] + b.mValue[k];
+            return s;
+        };
+        const Sums zero = { { 0, 0, 0, 0, 0, 0 } };
+
+        const Sums total = ParallelReduce( policy, 0, count, zero,
+            [&](size_t begin, size_t end) {
+                Sums s = zero;
+                for (size_t i=begin;i!=end;++i)
+                {
+                    const VectorBase& p = first[i];
+                    for (int d=0;d!=3;++d)
+                        s.mValue[d] += double( p[d] );
+                }
+                return s;
+            }, add );
+        const double mean[3] = {
+            total.mValue[0] / double( count ),
+            total.mValue[1] / double( count ),
+            total.mValue[2] / double( count ) };
+
+        // xx, yy, zz, xy, xz, yz about the mean
+        const Sums moments = ParallelReduce( policy, 0, count, zero,
+            [&](size_t begin, size_t end) {
+                Sums s = zero;
+                for (size_t i=begin;i!=end;++i)
+                {
+                    const VectorBase& p = first[i];
+                    const double x = double( p[0] ) - mean[0];
+                    const double y = double( p[1] ) - mean[1];
+                    const double z = double( p[2] ) - mean[2];
+                    s.mValue[0] += x*x; s.mValue[1] += y*y; s.mValue[2] += z*z;
+                    s.mValue[3] += x*y; s.mValue[4] += x*z; s.mValue[5] += y*z;
+                }
+                return s;
+            }, add );
+        const double covariance[3][3] = {
+            { moments.mValue[0], moments.mValue[3], moments.mValue[4] },
+            { moments.mValue[3], moments.mValue[1], moments.mValue[5] },
+            { moments.mValue[4], moments.mValue[5], moments.mValue[2] } };
+        double values[3], axes[3][3];
+        ComputeSymmetricEigen3( covariance, values, axes );
+        // right handed
+        axes[2][0] = axes[0][1]*axes[1][2] - axes[0][2]*axes[1][1];
+        axes[2][1] = axes[0][2]*axes[1][0] - axes[0][0]*axes[1][2];
+        axes[2][2] = axes[0][0]*axes[1][1] - axes[0][1]*axes[1][0];
+
+        // the extent along each axis, relative to the mean
+        const Sums lowest = { { HUGE_VAL, HUGE_VAL, HUGE_VAL, -HUGE_VAL, -HUGE_VAL, -HUGE_VAL } };
+        const Sums extent = ParallelReduce( policy, 0, count, lowest,
+            [&](size_t begin, size_t end) {
+                Sums s = lowest;
+                for (size_t i=begin;i!=end;++i)
+                {
+                    const VectorBase& p = first[i];
+                    const double x = double( p[0] ) - mean[0];
+                    const double y = double( p[1] ) - mean[1];
+                    const double z = double( p[2] ) - mean[2];
+                    for (int k=0;k!=3;++k)
+                    {
+                        const double along = x*axes[k][0] + y*axes[k][1] + z*axes[k][2];
+                        s.mValue[k] = std::min( s.mValue[k], along );
+                        s.mValue[k+3] = std::max( s.mValue[k+3], along );
+                    }
+                }
+                return s;
+            },
+            [](const Sums& a, const Sums& b) {
+                Sums s;
+                for (int k=0;k!=3;++k)
+                {
+                    s.mValue[k] = std::min( a.mValue[k], b.mValue[k] );
+                    s.mValue[k+3] = std::max( a.mValue[k+3], b.mValue[k+3] );
+                }
+                return s;
+            } );
+
+        double center[3] = { mean[0], mean[1], mean[2] };
+        double reach = 0;
+        for (int k=0;k!=3;++k)
+        {
+            const double middle = (extent.mValue[k] + extent.mValue[k+3]) / 2;
+            for (int d=0;d!=3;++d)
+                center[d] += middle*axes[k][d];
+            reach = std::max( reach, extent.mValue[k+3] - extent.mValue[k] );
+        }
+        for (int d=0;d!=3;++d)
+            reach += std::fabs( center[d] );
+
+        // grown by a little more than Contains can round by in Scalar
+        const double slack = 8 * std::numeric_limits<Scalar>::epsilon() * reach;
+        VectorBase halfExtents( uninitialised );
+        typename OrientedBoundingBox3d<Scalar>::RotationType rotation( uninitialised );
+        for (int k=0;k!=3;++k)
+        {
+            halfExtents[k] = Scalar( (extent.mValue[k+3] - extent.mValue[k]) / 2 + slack );
+            for (int d=0;d!=3;++d)
+                rotation[k][d] = Scalar( axes[k][d] );
+        }
+        const VectorBase middle( { Scalar( center[0] ), Scalar( center[1] ), Scalar( center[2] ) } );
+        result = OrientedBoundingBox3d<Scalar>( middle, halfExtents, rotation );
+    }
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template <typename Scalar>
+    OrientedBoundingBox3d<Scalar>::OrientedBoundingBox3d(const VectorBase& center, const VectorBase& halfExtents,
+        const RotationType& rotation)
+        : mCenter(center), mHalfExtents(halfExtents), mRotation(rotation)
+    {
+        assert( halfExtents[0]>=0 && halfExtents[1]>=0 && halfExtents[2]>=0 );
+    }
+
+    template <typename Scalar>
+    OrientedBoundingBox3d<Scalar>::OrientedBoundingBox3d(const VectorBase& center, const VectorBase& halfExtents,
+        const Matrix4<Scalar>& rotation)
+        : mCenter(center), mHalfExtents(halfExtents), mRotation(uninitialised)
+    {
+        assert( halfExtents[0]>=0 && halfExtents[1]>=0 && halfExtents[2]>=0 );
+        for (size_t k=0;k!=3;++k)
+            for (size_t d=0;d!=3;++d)
+                mRotation[k][d] = rotation[k][d];
+    }
+
+    template <typename Scalar>
+    OrientedBoundingBox3d<Scalar>::OrientedBoundingBox3d(const BoundsType& box)
+        : mCenter(GetMidpoint( box.GetMinBound(), box.GetMaxBound() ))
+        , mHalfExtents(uninitialised)
+        , mRotation()
+    {
+        for (size_t d=0;d!=3;++d)
+            mHalfExtents[d] = (box.GetMaxBound()[d] - box.GetMinBound()[d]) / 2;
+    }
+
+    template <typename Scalar>
+    const typename OrientedBoundingBox3d<Scalar>::VectorType& OrientedBoundingBox3d<Scalar>::GetCenter() const
+    {
+        return mCenter;
+    }
+
+    template <typename Scalar>
+    const typename OrientedBoundingBox3d<Scalar>::VectorType& OrientedBoundingBox3d<Scalar>::GetHalfExtents() const
+    {
+        return mHalfExtents;
+    }
+
+    template <typename Scalar>
+    const typename OrientedBoundingBox3d<Scalar>::RotationType& OrientedBoundingBox3d<Scalar>::GetRotation() const
+    {
+        return mRotation;
+    }
+
+    template <typename Scalar>
+    typename OrientedBoundingBox3d<Scalar>::VectorType OrientedBoundingBox3d<Scalar>::GetAxis(size_t k) const
+    {
+        assert( k<3 );
+        return VectorType( mRotation[k][0], mRotation[k][1], mRotation[k][2] );
+    }
+
+    template <typename Scalar>
+    Scalar OrientedBoundingBox3d<Scalar>::GetVolume() const
+    {
+        return 8 * mHalfExtents[0] * mHalfExtents[1] * mHalfExtents[2];
+    }
+
+    template <typename Scalar>
+    bool OrientedBoundingBox3d<Scalar>::Contains(const VectorBase& p) const
+    {
+        const VectorBase d = p - mCenter;
+        for (size_t k=0;k!=3;++k)
+        {
+            const Scalar along = d[0]*mRotation[k][0] + d[1]*mRotation[k][1] + d[2]*mRotation[k][2];
+            if (Fabs( along ) > mHalfExtents[k])
+                return false;
+        }
+        return true;
+    }
+
+    template <typename Scalar>
+    bool OrientedBoundingBox3d<Scalar>::Intersects(const OrientedBoundingBox3d& rhs) const
+    {
+        Scalar a[sPackedSize], b[sPackedSize];
+        Pack( a );
+        rhs.Pack( b );
+        return !OBB_IsSeparated( a, b );
+    }
+
+    template <typename Scalar>
+    void OrientedBoundingBox3d<Scalar>::ComputeBounds(BoundsType& result) const
+    {
+        VectorType lo( uninitialised ), hi( uninitialised );
+        for (size_t d=0;d!=3;++d)
+        {
+            const Scalar reach = mHalfExtents[0]*Fabs( mRotation[0][d] )
+                + mHalfExtents[1]*Fabs( mRotation[1][d] )
+                + mHalfExtents[2]*Fabs( mRotation[2][d] );
+            lo[d] = mCenter[d] - reach;
+            hi[d] = mCenter[d] + reach;
+        }
+        // through ExpandToContain, so the max bound is exclusive as usual
+        result = BoundsType( lo );
+        result.ExpandToContain( hi );
+    }
+
+    template <typename Scalar>
+    typename OrientedBoundingBox3d<Scalar>::BoundsType OrientedBoundingBox3d<Scalar>::GetBounds() const
+    {
+        BoundsType result( uninitialised );
+        ComputeBounds( result );
+        return result;
+    }
+
+    template <typename Scalar>
+    void OrientedBoundingBox3d<Scalar>::Pack(Scalar packed[sPackedSize]) const
+    {
+        for (size_t d=0;d!=3;++d)
+        {
+            packed[d] = mCenter[d];
+            packed[3+d] = mHalfExtents[d];
+            for (size_t k=0;k!=3;++k)
+                packed[6+3*k+d] = mRotation[k][d];
+        }
+    }
+
+    template <typename Scalar>
+    OrientedBoundingBoxArray<Scalar>::OrientedBoundingBoxArray()
+    {
+    }
+
+    template <typename Scalar>
+    size_t OrientedBoundingBoxArray<Scalar>::GetSize() const
+    {
+        return mData[0].size();
+    }
+
+    template <typename Scalar>
+    void OrientedBoundingBoxArray<Scalar>::Reserve(size_t count)
+    {
+        for (size_t k=0;k!=sPackedSize;++k)
+            mData[k].reserve( count );
+    }
+
+    template <typename Scalar>
+    void OrientedBoundingBoxArray<Scalar>::Add(const BoxType& box)
+    {
+        Scalar packed[sPackedSize];
+        box.Pack( packed );
+        for (size_t k=0;k!=sPackedSize;++k)
+            mData[k].push_back( packed[k] );
+    }
+
+    template <typename Scalar>
+    typename OrientedBoundingBoxArray<Scalar>::BoxType OrientedBoundingBoxArray<Scalar>::Get(size_t i) const
+    {
+        assert( i<GetSize() );
+        typename BoxType::RotationType rotation( uninitialised );
+        for (size_t k=0;k!=3;++k)
+            for (size_t d=0;d!=3;++d)
+                rotation[k][d] = mData[6+3*k+d][i];
+        return BoxType(
+            VectorN<Scalar,3>( { mData[0][i], mData[1][i], mData[2][i] } ),
+            VectorN<Scalar,3>( { mData[3][i], mData[4][i], mData[5][i] } ),
+            rotation );
+    }
+
+    template <typename Scalar>
+    const Scalar* OrientedBoundingBoxArray<Scalar>::GetPacked(size_t k) const
+    {
+        assert( k<sPackedSize );
+        return mData[k].data();
+    }
+}
+
+#endif//GEOMETRY_OBB3D_H_INCLUDED_
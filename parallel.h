@@ -0,0 +1,358 @@
+#ifndef GEOMETRY_PARALLEL_H_INCLUDED_
+#define GEOMETRY_PARALLEL_H_INCLUDED_
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // fixed set of worker threads, each with its own task deque. a worker
+    // takes new work from the back of its own deque and, when that is empty,
+    // steals from the front of the others. a thread waiting on a parallel
+    // loop runs queued tasks itself, so loops nest without deadlocking
+    class ThreadPool
+    {
+        public:
+            typedef std::function<void()> TaskType;
+
+            // threadCount 0 uses one worker per hardware thread, less the caller's
+            explicit ThreadPool(size_t threadCount = 0);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            // worker threads, not counting callers that help while they wait
+            size_t GetThreadCount() const;
+
+            // tasks run bare on a worker and must not throw, the parallel
+            // loops below catch for their own tasks and rethrow to the caller
+            void Submit(TaskType task);
+
+            // runs one queued task on the calling thread, false if there were none
+            bool RunPending();
+
+            // shared pool used by ExecutionPolicy::Parallel()
+            static ThreadPool& GetDefault();
+
+        private:
+            class Queue
+            {
+                public:
+                    std::mutex mMutex;
+                    std::deque<TaskType> mTasks;
+            };
+
+            bool Take(size_t index, TaskType& task);
+            bool Steal(size_t index, TaskType& task);
+            void WorkerLoop(size_t index);
+
+            // the pool and queue the current thread works for, if any
+            static ThreadPool*& CurrentPool();
+            static size_t& CurrentIndex();
+
+            std::vector< std::unique_ptr<Queue> > mQueues;
+            std::vector< std::thread > mThreads;
+            std::atomic<size_t> mPending;
+            std::atomic<size_t> mNextQueue;
+            std::atomic<bool> mStop;
+            std::mutex mSleepMutex;
+            std::condition_variable mWake;
+    };
+
+    // how a batch operation should run: sequentially on the calling thread
+    // (the default) or split across a pool. work is cut into chunks of
+    // grain items, independent of the thread count, so reductions combine
+    // the same partial results in the same order whatever runs them
+    class ExecutionPolicy
+    {
+        public:
+            const static size_t sDefaultGrain = 2048;
+
+            // sequential
+            ExecutionPolicy()
+                : mPool(nullptr), mGrain(sDefaultGrain)
+            { }
+
+            explicit ExecutionPolicy(ThreadPool& pool, size_t grain = sDefaultGrain)
+                : mPool(&pool), mGrain(grain)
+            {
+                assert( grain>0 );
+            }
+
+            static ExecutionPolicy Sequential()
+            {
+                return ExecutionPolicy();
+            }
+
+            static ExecutionPolicy Parallel(size_t grain = sDefaultGrain)
+            {
+                return ExecutionPolicy( ThreadPool::GetDefault(), grain );
+            }
+
+            bool IsParallel() const { return mPool!=nullptr; }
+            ThreadPool* GetPool() const { return mPool; }
+            size_t GetGrain() const { return mGrain; }
+
+            // the same policy with a different chunk size
+            ExecutionPolicy WithGrain(size_t grain) const
+            {
+                assert( grain>0 );
+                ExecutionPolicy result(*this);
+                result.mGrain = grain;
+                return result;
+            }
+
+        private:
+            ThreadPool* mPool;
+            size_t mGrain;
+    };
+
+    //
+    // Free-functions
+    //
+
+    // calls fn(chunk, begin, end) for every grain sized chunk of [first,last).
+    // chunks are handed out through a shared counter by a handful of tasks,
+    // rather than one task per chunk, which keeps queue traffic independent of size.
+    // if fn throws no further chunks are started and, once every task has
+    // finished, the first exception is rethrown on the calling thread
+    template<typename Function>
+    void ParallelForChunks(const ExecutionPolicy& policy, size_t first, size_t last, Function fn)
+    {
+        if (last<=first) return;
+        const size_t grain = policy.GetGrain();
+        const size_t chunks = (last - first + grain - 1) / grain;
+
+        if (!policy.IsParallel() || chunks==1)
+        {
+            for (size_t c=0;c!=chunks;++c)
+                fn( c, first + c*grain, std::min( last, first + (c+1)*grain ) );
+            return;
+        }
+
+        ThreadPool& pool = *policy.GetPool();
+        std::atomic<size_t> next(0);
+        std::atomic<size_t> done(0);
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        auto work = [&]() {
+            try
+            {
+                for (size_t c=next++;c<chunks;c=next++)
+                {
+                    fn( c, first + c*grain, std::min( last, first + (c+1)*grain ) );
+                    ++done;
+                }
+            }
+            catch (...)
+            {
+                // push the counter past the end so the other tasks stop
+                next = chunks;
+                std::lock_guard<std::mutex> lock( errorMutex );
+                if (!error)
+                    error = std::current_exception();
+            }
+        };
+
+        // one task per worker at most, the caller takes a share too
+        const size_t tasks = std::min( chunks-1, pool.GetThreadCount() );
+        std::atomic<size_t> running( tasks );
+        for (size_t t=0;t!=tasks;++t)
+        {
+            pool.Submit( [&]() { work(); --running; } );
+        }
+        work();
+
+        // the tasks reference this frame, wait for all of them to leave it
+        while (running.load()!=0)
+        {
+            if (!pool.RunPending())
+                std::this_thread::yield();
+        }
+        if (error)
+            std::rethrow_exception( error );
+        assert( done.load()==chunks );
+    }
+
+    // calls fn(begin, end) over [first,last) in grain sized pieces
+    template<typename Function>
+    void ParallelFor(const ExecutionPolicy& policy, size_t first, size_t last, Function fn)
+    {
+        ParallelForChunks( policy, first, last,
+            [&fn](size_t, size_t begin, size_t end) { fn( begin, end ); } );
+    }
+
+    // fn(begin, end) returns the partial result for a chunk, the partials are
+    // then folded left to right with combine, starting from identity.
+    // the result is the same for every policy with the same grain
+    template<typename T, typename Function, typename Combine>
+    T ParallelReduce(const ExecutionPolicy& policy, size_t first, size_t last,
+        const T& identity, Function fn, Combine combine)
+    {
+        if (last<=first) return identity;
+        const size_t grain = policy.GetGrain();
+        const size_t chunks = (last - first + grain - 1) / grain;
+
+        std::vector<T> partial( chunks, identity );
+        ParallelForChunks( policy, first, last,
+            [&](size_t c, size_t begin, size_t end) { partial[c] = fn( begin, end ); } );
+
+        T result = identity;
+        for (size_t c=0;c!=chunks;++c)
+            result = combine( result, partial[c] );
+        return result;
+    }
+
+    //
+    // Class Implementation
+    //
+
+    inline ThreadPool::ThreadPool(size_t threadCount)
+        : mPending(0)
+        , mNextQueue(0)
+        , mStop(false)
+    {
+        if (threadCount==0)
+        {
+            const size_t hardware = std::thread::hardware_concurrency();
+            threadCount = hardware>1 ? hardware-1 : 1;
+        }
+
+        for (size_t i=0;i!=threadCount;++i)
+            mQueues.emplace_back( new Queue );
+        for (size_t i=0;i!=threadCount;++i)
+            mThreads.emplace_back( [this, i]() { WorkerLoop(i); } );
+    }
+
+    inline ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mSleepMutex );
+            mStop = true;
+        }
+        mWake.notify_all();
+        for (auto& thread : mThreads)
+            thread.join();
+    }
+
+    inline size_t ThreadPool::GetThreadCount() const
+    {
+        return mThreads.size();
+    }
+
+    inline ThreadPool*& ThreadPool::CurrentPool()
+    {
+        static thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    inline size_t& ThreadPool::CurrentIndex()
+    {
+        static thread_local size_t index = 0;
+        return index;
+    }
+
+    inline void ThreadPool::Submit(TaskType task)
+    {
+        // workers push to their own deque, everyone else spreads round robin
+        const size_t index = CurrentPool()==this
+            ? CurrentIndex()
+            : mNextQueue++ % mQueues.size();
+
+        // count the task before it can be taken, Take and Steal decrement
+        // as soon as they see it and the count must not wrap below zero
+        ++mPending;
+        {
+            std::lock_guard<std::mutex> lock( mQueues[index]->mMutex );
+            mQueues[index]->mTasks.push_back( std::move(task) );
+        }
+        {
+            // pairs with the predicate check in WorkerLoop so the wake up can't be lost
+            std::lock_guard<std::mutex> lock( mSleepMutex );
+        }
+        mWake.notify_one();
+    }
+
+    inline bool ThreadPool::Take(size_t index, TaskType& task)
+    {
+        Queue& queue = *mQueues[index];
+        std::lock_guard<std::mutex> lock( queue.mMutex );
+        if (queue.mTasks.empty()) return false;
+        task = std::move( queue.mTasks.back() );
+        queue.mTasks.pop_back();
+        --mPending;
+        return true;
+    }
+
+    inline bool ThreadPool::Steal(size_t index, TaskType& task)
+    {
+        const size_t count = mQueues.size();
+        for (size_t n=1;n<=count;++n)
+        {
+            Queue& queue = *mQueues[(index + n) % count];
+            std::lock_guard<std::mutex> lock( queue.mMutex );
+            if (queue.mTasks.empty()) continue;
+            task = std::move( queue.mTasks.front() );
+            queue.mTasks.pop_front();
+            --mPending;
+            return true;
+        }
+        return false;
+    }
+
+    inline bool ThreadPool::RunPending()
+    {
+        TaskType task;
+        const bool own = CurrentPool()==this;
+        if ((own && Take( CurrentIndex(), task )) || Steal( own ? CurrentIndex() : 0, task ))
+        {
+            task();
+            return true;
+        }
+        return false;
+    }
+
+    inline void ThreadPool::WorkerLoop(size_t index)
+    {
+        CurrentPool() = this;
+        CurrentIndex() = index;
+
+        TaskType task;
+        for (;;)
+        {
+            if (Take( index, task ) || Steal( index, task ))
+            {
+                task();
+                task = nullptr;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock( mSleepMutex );
+            mWake.wait( lock, [this]() { return mStop.load() || mPending.load()!=0; } );
+            if (mStop.load() && mPending.load()==0)
+                return;
+        }
+    }
+
+    inline ThreadPool& ThreadPool::GetDefault()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+}
+
+#endif//GEOMETRY_PARALLEL_H_INCLUDED_
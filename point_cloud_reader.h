@@ -0,0 +1,714 @@
+#ifndef GEOMETRY_POINT_CLOUD_READER_H_INCLUDED_
+#define GEOMETRY_POINT_CLOUD_READER_H_INCLUDED_
+
+#include "geometry_uninitialised.h"
+#include "vector3d.h"
+#include "aabb3d.h"
+#include "parallel.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <algorithm>
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+#if !defined(__cpp_lib_to_chars)
+#include <sstream>
+#include <locale>
+#endif
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    enum class PointCloudFormat
+    {
+        none,
+        // whitespace or comma separated x y z per line, later columns ignored
+        xyz,
+        plyAscii,
+        plyBinary
+    };
+
+    // a run of consecutive points from the file, as separate x, y and z
+    // arrays, with their bounds found while they were parsed
+    template< typename Scalar >
+    class PointCloudChunk
+    {
+    public:
+        typedef AxisAlignedBoundingBox3d<Scalar> AABB;
+
+        PointCloudChunk();
+
+        size_t GetSize() const;
+        // offset of the chunk's first point in the file
+        size_t GetFirstPoint() const;
+        // only meaningful when the chunk is not empty
+        const AABB& GetBounds() const;
+
+        const std::vector<Scalar>& GetX() const;
+        const std::vector<Scalar>& GetY() const;
+        const std::vector<Scalar>& GetZ() const;
+
+        Vector3d<Scalar> GetPoint(size_t i) const;
+
+    private:
+        template< typename > friend class PointCloudReader;
+
+        void Clear();
+        void Add(Scalar x, Scalar y, Scalar z);
+        // keeps the first count points, with their bounds
+        void Truncate(size_t count);
+
+        std::vector<Scalar> mX, mY, mZ;
+        AABB mBounds;
+        size_t mFirstPoint;
+        // points parsed before a line that was not one, ~0 if every line was
+        size_t mErrorLine;
+    };
+
+    // reads XYZ and PLY (ascii or binary, either byte order) point clouds a
+    // chunk at a time. the file is read in blocks of about chunkBytes on the
+    // calling thread and the policy parses a block per worker, so memory
+    // stays at a few blocks per thread however large the file. chunks are
+    // handed back in file order on the calling thread
+    template< typename Scalar >
+    class PointCloudReader
+    {
+    public:
+        typedef PointCloudChunk<Scalar> Chunk;
+
+        const static size_t sDefaultChunkBytes = 1 << 20;
+
+        explicit PointCloudReader(size_t chunkBytes = sDefaultChunkBytes);
+        ~PointCloudReader();
+        PointCloudReader(const PointCloudReader&) = delete;
+        PointCloudReader& operator=(const PointCloudReader&) = delete;
+
+        // reads the PLY header if there is one, anything without one is taken
+        // as XYZ. false if the file cannot be opened or the PLY header has no
+        // vertex x, y and z, has other elements before the vertices, or has
+        // a list property on the vertices
+        bool Open(const char* path);
+        void Close();
+
+        PointCloudFormat GetFormat() const;
+        // the PLY vertex count, unknown (zero) for XYZ until it is read
+        size_t GetDeclaredCount() const;
+
+        // fn(const Chunk&) for each non-empty chunk in order. false on a read
+        // error, a line that is not a point or a line longer than chunkBytes.
+        // a file can be read once per Open
+        template< typename Fn >
+        bool Read(Fn fn, const ExecutionPolicy& policy = ExecutionPolicy());
+
+    private:
+        // PLY scalar property types
+        enum class Property
+        {
+            int8, uint8, int16, uint16, int32, uint32, float32, float64
+        };
+
+        template< typename Fn >
+        bool ReadText(Fn fn, const ExecutionPolicy& policy);
+        template< typename Fn >
+        bool ReadBinary(Fn fn, const ExecutionPolicy& policy);
+
+        void ParseText(const char* first, const char* last, Chunk& chunk) const;
+        void ParseBinary(const unsigned char* first, size_t count, Chunk& chunk) const;
+        Scalar ReadProperty(const unsigned char* data, size_t axis) const;
+
+        size_t mChunkBytes;
+        std::FILE* mFile;
+        PointCloudFormat mFormat;
+        size_t mDeclaredCount;
+        // field or byte offset and type of x, y and z
+        size_t mField[3];
+        size_t mFieldCount;
+        size_t mOffset[3];
+        Property mProperty[3];
+        size_t mVertexSize;
+        bool mSwap;
+    };
+
+    //
+    // Free-functions
+    //
+
+    // parses a decimal number at cursor, which moves past it. false, with
+    // cursor unchanged, if there is none. digits that fit 53 bits with an
+    // exponent within +/-22 take Clinger's fast path, one exact integer times
+    // or divided by an exact power of ten and so correctly rounded, which
+    // covers what point cloud files hold. anything else falls back to a full
+    // parse in the "C" locale, strtod would take a comma as the decimal point
+    // under some locales. no inf or nan
+    inline bool ParseDouble(const char*& cursor, const char* end, double& result)
+    {
+        static const double sPow10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+        const char* p = cursor;
+        bool negative = false;
+        if (p!=end && (*p=='-' || *p=='+'))
+        {
+            negative = *p=='-';
+            ++p;
+        }
+
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        bool any = false;
+        bool dropped = false;
+        for (;p!=end && unsigned(*p-'0')<10;++p)
+        {
+            any = true;
+            if (digits<19)
+            {
+                mantissa = mantissa*10 + unsigned(*p-'0');
+                digits += mantissa!=0;
+            }
+            else
+            {
+                dropped |= *p!='0';
+                ++exponent;
+            }
+        }
+        if (p!=end && *p=='.')
+        {
+            for (++p;p!=end && unsigned(*p-'0')<10;++p)
+            {
+                any = true;
+                if (digits<19)
+                {
+                    mantissa = mantissa*10 + unsigned(*p-'0');
+                    digits += mantissa!=0;
+                    --exponent;
+                }
+                else
+                {
+                    dropped |= *p!='0';
+                }
+            }
+        }
+        if (!any)
+            return false;
+
+        if (p!=end && (*p=='e' || *p=='E'))
+        {
+            const char* e = p+1;
+            bool negativeExponent = false;
+            if (e!=end && (*e=='-' || *e=='+'))
+            {
+                negativeExponent = *e=='-';
+                ++e;
+            }
+            if (e!=end && unsigned(*e-'0')<10)
+            {
+                int value = 0;
+                for (;e!=end && unsigned(*e-'0')<10;++e)
+                    value = std::min( value*10 + int(*e-'0'), 100000 );
+                exponent += negativeExponent ? -value : value;
+                p = e;
+            }
+        }
+
+        if (mantissa==0)
+        {
+            result = negative ? -0.0 : 0.0;
+        }
+        else if (!dropped && mantissa<=(uint64_t(1)<<53) && exponent>=-22 && exponent<=22)
+        {
+            const double m = double(mantissa);
+            result = exponent<0 ? m / sPow10[-exponent] : m * sPow10[exponent];
+            if (negative)
+                result = -result;
+        }
+        else
+        {
+            // from_chars takes no leading +
+            const char* first = *cursor=='+' ? cursor+1 : cursor;
+#if defined(__cpp_lib_to_chars)
+            const std::from_chars_result chars = std::from_chars( first, p, result );
+            const bool parsed = chars.ec==std::errc() && chars.ptr==p;
+#else
+            std::istringstream in( std::string( first, p ) );
+            in.imbue( std::locale::classic() );
+            in >> result;
+            const bool parsed = !in.fail();
+#endif
+            // out of range, overflowing to inf or underflowing to zero
+            if (!parsed)
+            {
+                result = double(mantissa) * std::pow( 10.0, double(exponent) );
+                if (negative)
+                    result = -result;
+            }
+        }
+        cursor = p;
+        return true;
+    }
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template< typename Scalar >
+    PointCloudChunk<Scalar>::PointCloudChunk()
+        : mBounds(uninitialised), mFirstPoint(0), mErrorLine(~size_t(0))
+    {
+    }
+
+    template< typename Scalar >
+    size_t PointCloudChunk<Scalar>::GetSize() const
+    {
+        return mX.size();
+    }
+
+    template< typename Scalar >
+    size_t PointCloudChunk<Scalar>::GetFirstPoint() const
+    {
+        return mFirstPoint;
+    }
+
+    template< typename Scalar >
+    const typename PointCloudChunk<Scalar>::AABB& PointCloudChunk<Scalar>::GetBounds() const
+    {
+        assert( !mX.empty() );
+        return mBounds;
+    }
+
+    template< typename Scalar >
+    const std::vector<Scalar>& PointCloudChunk<Scalar>::GetX() const
+    {
+        return mX;
+    }
+
+    template< typename Scalar >
+    const std::vector<Scalar>& PointCloudChunk<Scalar>::GetY() const
+    {
+        return mY;
+    }
+
+    template< typename Scalar >
+    const std::vector<Scalar>& PointCloudChunk<Scalar>::GetZ() const
+    {
+        return mZ;
+    }
+
+    template< typename Scalar >
+    Vector3d<Scalar> PointCloudChunk<Scalar>::GetPoint(size_t i) const
+    {
+        assert( i<mX.size() );
+        return Vector3d<Scalar>( mX[i], mY[i], mZ[i] );
+    }
+
+    template< typename Scalar >
+    void PointCloudChunk<Scalar>::Clear()
+    {
+        // keeps the capacity, chunks are reused from block to block
+        mX.clear();
+        mY.clear();
+        mZ.clear();
+        mErrorLine = ~size_t(0);
+    }
+
+    template< typename Scalar >
+    void PointCloudChunk<Scalar>::Add(Scalar x, Scalar y, Scalar z)
+    {
+        if (mX.empty())
+        {
+            mBounds = AABB( Vector3d<Scalar>( x, y, z ) );
+        }
+        else
+        {
+            mBounds.ExpandToContain( Vector3d<Scalar>( x, y, z ) );
+        }
+        mX.push_back( x );
+        mY.push_back( y );
+        mZ.push_back( z );
+    }
+
+    template< typename Scalar >
+    void PointCloudChunk<Scalar>::Truncate(size_t count)
+    {
+        assert( count<=mX.size() );
+        std::vector<Scalar> x, y, z;
+        mX.swap( x );
+        mY.swap( y );
+        mZ.swap( z );
+        mX.reserve( count );
+        mY.reserve( count );
+        mZ.reserve( count );
+        for (size_t i=0;i!=count;++i)
+            Add( x[i], y[i], z[i] );
+    }
+
+    template< typename Scalar >
+    PointCloudReader<Scalar>::PointCloudReader(size_t chunkBytes)
+        : mChunkBytes(chunkBytes)
+        , mFile(nullptr)
+        , mFormat(PointCloudFormat::none)
+        , mDeclaredCount(0)
+        , mField{0, 1, 2}
+        , mFieldCount(3)
+        , mOffset{0, 0, 0}
+        , mProperty{Property::float32, Property::float32, Property::float32}
+        , mVertexSize(0)
+        , mSwap(false)
+    {
+        // room for at least one long line or a few binary vertices
+        assert( chunkBytes>=256 );
+    }
+
+    template< typename Scalar >
+    PointCloudReader<Scalar>::~PointCloudReader()
+    {
+        Close();
+    }
+
+    template< typename Scalar >
+    bool PointCloudReader<Scalar>::Open(const char* path)
+    {
+        Close();
+        mFile = std::fopen( path, "rb" );
+        if (!mFile)
+            return false;
+
+        char line[1024];
+        if (!std::fgets( line, sizeof(line), mFile ) || std::strncmp( line, "ply", 3 )!=0
+            || (line[3]!='\n' && line[3]!='\r'))
+        {
+            std::rewind( mFile );
+            mFormat = PointCloudFormat::xyz;
+            return true;
+        }
+
+        const uint16_t probe = 1;
+        const bool little = *reinterpret_cast<const unsigned char*>( &probe )==1;
+        bool inVertex = false;
+        bool seenVertex = false;
+        size_t properties = 0;
+        size_t offset = 0;
+        bool found[3] = { false, false, false };
+        while (std::fgets( line, sizeof(line), mFile ))
+        {
+            char word[64] = {}, type[64] = {}, name[64] = {};
+            unsigned long long count = 0;
+            if (std::sscanf( line, "%63s", word )!=1 || std::strcmp( word, "comment" )==0
+                || std::strcmp( word, "obj_info" )==0)
+            {
+                continue;
+            }
+            if (std::strcmp( word, "end_header" )==0)
+            {
+                if (mFormat==PointCloudFormat::none || !found[0] || !found[1] || !found[2])
+                    break;
+                mFieldCount = std::max( std::max( mField[0], mField[1] ), mField[2] ) + 1;
+                mVertexSize = offset;
+                return true;
+            }
+            if (std::strcmp( word, "format" )==0)
+            {
+                std::sscanf( line, "%*s %63s", type );
+                if (std::strcmp( type, "ascii" )==0)
+                {
+                    mFormat = PointCloudFormat::plyAscii;
+                }
+                else if (std::strcmp( type, "binary_little_endian" )==0 || std::strcmp( type, "binary_big_endian" )==0)
+                {
+                    mFormat = PointCloudFormat::plyBinary;
+                    mSwap = (std::strcmp( type, "binary_little_endian" )==0)!=little;
+                }
+            }
+            else if (std::strcmp( word, "element" )==0)
+            {
+                // nothing after the vertices is read
+                if (seenVertex)
+                {
+                    inVertex = false;
+                    continue;
+                }
+                if (std::sscanf( line, "%*s %63s %llu", name, &count )!=2 || std::strcmp( name, "vertex" )!=0)
+                    break;
+                inVertex = seenVertex = true;
+                mDeclaredCount = size_t(count);
+            }
+            else if (std::strcmp( word, "property" )==0 && inVertex)
+            {
+                if (std::sscanf( line, "%*s %63s %63s", type, name )!=2)
+                    break;
+                Property property;
+                size_t size;
+                const std::string t( type );
+                if (t=="char" || t=="int8") { property = Property::int8; size = 1; }
+                else if (t=="uchar" || t=="uint8") { property = Property::uint8; size = 1; }
+                else if (t=="short" || t=="int16") { property = Property::int16; size = 2; }
+                else if (t=="ushort" || t=="uint16") { property = Property::uint16; size = 2; }
+                else if (t=="int" || t=="int32") { property = Property::int32; size = 4; }
+                else if (t=="uint" || t=="uint32") { property = Property::uint32; size = 4; }
+                else if (t=="float" || t=="float32") { property = Property::float32; size = 4; }
+                else if (t=="double" || t=="float64") { property = Property::float64; size = 8; }
+                // list properties on vertices are not supported
+                else break;
+
+                const size_t axis = std::strcmp( name, "x" )==0 ? 0 : std::strcmp( name, "y" )==0 ? 1
+                    : std::strcmp( name, "z" )==0 ? 2 : 3;
+                if (axis<3)
+                {
+                    found[axis] = true;
+                    mField[axis] = properties;
+                    mOffset[axis] = offset;
+                    mProperty[axis] = property;
+                }
+                ++properties;
+                offset += size;
+            }
+        }
+        Close();
+        return false;
+    }
+
+    template< typename Scalar >
+    void PointCloudReader<Scalar>::Close()
+    {
+        if (mFile)
+            std::fclose( mFile );
+        mFile = nullptr;
+        mFormat = PointCloudFormat::none;
+        mDeclaredCount = 0;
+        mField[0] = 0; mField[1] = 1; mField[2] = 2;
+        mFieldCount = 3;
+        mVertexSize = 0;
+        mSwap = false;
+    }
+
+    template< typename Scalar >
+    PointCloudFormat PointCloudReader<Scalar>::GetFormat() const
+    {
+        return mFormat;
+    }
+
+    template< typename Scalar >
+    size_t PointCloudReader<Scalar>::GetDeclaredCount() const
+    {
+        return mDeclaredCount;
+    }
+
+    template< typename Scalar >
+    template< typename Fn >
+    bool PointCloudReader<Scalar>::Read(Fn fn, const ExecutionPolicy& policy)
+    {
+        if (!mFile)
+            return false;
+        const bool result = mFormat==PointCloudFormat::plyBinary ? ReadBinary( fn, policy ) : ReadText( fn, policy );
+        Close();
+        return result;
+    }
+
+    // blocks are cut after their last newline, the partial line carried to
+    // the next. a batch of one block per thread is read, parsed side by side,
+    // then handed back in order
+    template< typename Scalar >
+    template< typename Fn >
+    bool PointCloudReader<Scalar>::ReadText(Fn fn, const ExecutionPolicy& policy)
+    {
+        const size_t batch = policy.IsParallel() ? policy.GetPool()->GetThreadCount() + 1 : 1;
+        std::vector< std::vector<char> > blocks( batch, std::vector<char>( mChunkBytes ) );
+        std::vector<size_t> lengths( batch );
+        std::vector<Chunk> chunks( batch );
+        std::vector<char> carry;
+        // PLY stops after its vertices, there may be faces after them
+        size_t remaining = mFormat==PointCloudFormat::plyAscii ? mDeclaredCount : ~size_t(0);
+        size_t point = 0;
+        bool eof = false;
+
+        while (!eof && remaining!=0)
+        {
+            size_t used = 0;
+            for (;used!=batch && !eof;++used)
+            {
+                char* block = blocks[used].data();
+                std::copy( carry.begin(), carry.end(), block );
+                const size_t read = std::fread( block+carry.size(), 1, mChunkBytes-carry.size(), mFile );
+                size_t length = carry.size() + read;
+                carry.clear();
+                eof = length<mChunkBytes;
+                if (eof && std::ferror( mFile ))
+                    return false;
+                if (!eof)
+                {
+                    size_t cut = length;
+                    while (cut!=0 && block[cut-1]!='\n')
+                        --cut;
+                    if (cut==0)
+                        return false;
+                    carry.assign( block+cut, block+length );
+                    length = cut;
+                }
+                lengths[used] = length;
+            }
+
+            ParallelFor( policy.WithGrain(1), 0, used, [&](size_t first, size_t last) {
+                for (size_t i=first;i!=last;++i)
+                    ParseText( blocks[i].data(), blocks[i].data()+lengths[i], chunks[i] );
+            } );
+
+            for (size_t i=0;i!=used && remaining!=0;++i)
+            {
+                Chunk& chunk = chunks[i];
+                if (chunk.mErrorLine<remaining)
+                    return false;
+                if (chunk.GetSize()>remaining)
+                    chunk.Truncate( remaining );
+                if (remaining!=~size_t(0))
+                    remaining -= chunk.GetSize();
+                chunk.mFirstPoint = point;
+                point += chunk.GetSize();
+                if (chunk.GetSize()!=0)
+                    fn( static_cast<const Chunk&>( chunk ) );
+            }
+        }
+        return mFormat==PointCloudFormat::xyz || remaining==0;
+    }
+
+    template< typename Scalar >
+    template< typename Fn >
+    bool PointCloudReader<Scalar>::ReadBinary(Fn fn, const ExecutionPolicy& policy)
+    {
+        const size_t batch = policy.IsParallel() ? policy.GetPool()->GetThreadCount() + 1 : 1;
+        const size_t perBlock = std::max( mChunkBytes / mVertexSize, size_t(1) );
+        std::vector< std::vector<unsigned char> > blocks( batch, std::vector<unsigned char>( perBlock*mVertexSize ) );
+        std::vector<size_t> counts( batch );
+        std::vector<Chunk> chunks( batch );
+        size_t point = 0;
+
+        while (point!=mDeclaredCount)
+        {
+            size_t used = 0;
+            size_t next = point;
+            for (;used!=batch && next!=mDeclaredCount;++used)
+            {
+                const size_t count = std::min( perBlock, mDeclaredCount-next );
+                if (std::fread( blocks[used].data(), mVertexSize, count, mFile )!=count)
+                    return false;
+                counts[used] = count;
+                next += count;
+            }
+
+            ParallelFor( policy.WithGrain(1), 0, used, [&](size_t first, size_t last) {
+                for (size_t i=first;i!=last;++i)
+                    ParseBinary( blocks[i].data(), counts[i], chunks[i] );
+            } );
+
+            for (size_t i=0;i!=used;++i)
+            {
+                chunks[i].mFirstPoint = point;
+                point += chunks[i].GetSize();
+                fn( static_cast<const Chunk&>( chunks[i] ) );
+            }
+        }
+        return true;
+    }
+
+    // a point per line, blank lines and lines starting # are skipped.
+    // stops at the first line that is not a point
+    template< typename Scalar >
+    void PointCloudReader<Scalar>::ParseText(const char* first, const char* last, Chunk& chunk) const
+    {
+        chunk.Clear();
+        const size_t fieldCount = mFieldCount;
+        const char* p = first;
+        while (p!=last)
+        {
+            const char* lineEnd = static_cast<const char*>( std::memchr( p, '\n', size_t(last-p) ) );
+            if (!lineEnd)
+                lineEnd = last;
+            while (p!=lineEnd && (*p==' ' || *p=='\t' || *p=='\r'))
+                ++p;
+            if (p==lineEnd || *p=='#')
+            {
+                p = lineEnd==last ? last : lineEnd+1;
+                continue;
+            }
+
+            double xyz[3] = { 0, 0, 0 };
+            size_t field = 0;
+            for (;field!=fieldCount;++field)
+            {
+                while (p!=lineEnd && (*p==' ' || *p=='\t' || *p==','))
+                    ++p;
+                double value;
+                if (!ParseDouble( p, lineEnd, value ))
+                    break;
+                for (size_t axis=0;axis!=3;++axis)
+                {
+                    if (mField[axis]==field)
+                        xyz[axis] = value;
+                }
+            }
+            if (field!=fieldCount)
+            {
+                chunk.mErrorLine = chunk.GetSize();
+                return;
+            }
+            chunk.Add( Scalar(xyz[0]), Scalar(xyz[1]), Scalar(xyz[2]) );
+            p = lineEnd==last ? last : lineEnd+1;
+        }
+    }
+
+    template< typename Scalar >
+    void PointCloudReader<Scalar>::ParseBinary(const unsigned char* first, size_t count, Chunk& chunk) const
+    {
+        chunk.Clear();
+        chunk.mX.reserve( count );
+        chunk.mY.reserve( count );
+        chunk.mZ.reserve( count );
+        for (size_t i=0;i!=count;++i)
+        {
+            const unsigned char* vertex = first + i*mVertexSize;
+            chunk.Add( ReadProperty( vertex, 0 ), ReadProperty( vertex, 1 ), ReadProperty( vertex, 2 ) );
+        }
+    }
+
+    template< typename Scalar >
+    Scalar PointCloudReader<Scalar>::ReadProperty(const unsigned char* data, size_t axis) const
+    {
+        unsigned char bytes[8];
+        const Property property = mProperty[axis];
+        const size_t size = property==Property::float64 ? 8
+            : (property==Property::int32 || property==Property::uint32 || property==Property::float32) ? 4
+            : (property==Property::int16 || property==Property::uint16) ? 2 : 1;
+        std::memcpy( bytes, data + mOffset[axis], size );
+        if (mSwap)
+            std::reverse( bytes, bytes+size );
+
+        switch (property)
+        {
+            case Property::int8: { int8_t v; std::memcpy( &v, bytes, 1 ); return Scalar(v); }
+            case Property::uint8: { uint8_t v; std::memcpy( &v, bytes, 1 ); return Scalar(v); }
+            case Property::int16: { int16_t v; std::memcpy( &v, bytes, 2 ); return Scalar(v); }
+            case Property::uint16: { uint16_t v; std::memcpy( &v, bytes, 2 ); return Scalar(v); }
+            case Property::int32: { int32_t v; std::memcpy( &v, bytes, 4 ); return Scalar(v); }
+            case Property::uint32: { uint32_t v; std::memcpy( &v, bytes, 4 ); return Scalar(v); }
+            case Property::float32: { float v; std::memcpy( &v, bytes, 4 ); return Scalar(v); }
+            case Property::float64: { double v; std::memcpy( &v, bytes, 8 ); return Scalar(v); }
+        }
+        return Scalar(0);
+    }
+}
+
+#endif//GEOMETRY_POINT_CLOUD_READER_H_INCLUDED_
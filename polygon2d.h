@@ -0,0 +1,454 @@
+#ifndef GEOMETRY_POLYGON2D_H_INCLUDED_
+#define GEOMETRY_POLYGON2D_H_INCLUDED_
+
+#include "vector2d.h"
+#include "aabb2d.h"
+#include "convex_hull.h"
+#include "parallel.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // a polygon as closed rings of points, the first the outline and any
+    // later ones holes, read with the even-odd rule so their winding does not
+    // matter. Prepare builds a uniform grid over the bounds listing the edges
+    // whose boxes touch each cell, and a parity for the bottom left corner of
+    // each cell that counts only the edges whose boxes start in a column right
+    // of the cell. every other edge the ray from a point in the cell can cross
+    // is in the cell's own list: those are counted against the point directly,
+    // and mCrossY corrects the corner parity for the ones crossing the cell's
+    // right side. a point then only needs the edges of its own cell, so a
+    // query costs about the same for a ring of ten points as for one of a
+    // million, as long as edges are short against the polygon. answers with
+    // and without the grid are the same, points exactly on an edge included,
+    // since both count the same crossings with the exact Orient2d
+    template <typename Scalar>
+    class Polygon2d
+    {
+        public:
+            typedef Vector2d<Scalar> VectorType;
+            typedef typename VectorType::BaseType VectorBase;
+            typedef AxisAlignedBoundingBox2d<Scalar> BoundsType;
+
+            // empty
+            Polygon2d();
+
+            explicit Polygon2d(const std::vector<VectorType>& outline);
+
+            // a ring is closed from its last point back to its first. adding
+            // one drops the grid until the next Prepare
+            void AddRing(const std::vector<VectorType>& ring);
+
+            size_t GetRingCount() const;
+            size_t GetRingSize(size_t ring) const;
+            // where the ring starts in GetPoints
+            size_t GetRingStart(size_t ring) const;
+            const std::vector<VectorType>& GetPoints() const;
+
+            // positive for a counterclockwise ring
+            double GetSignedArea(size_t ring) const;
+            // the outline's less the holes'
+            double GetArea() const;
+            // not valid while empty
+            const BoundsType& GetBounds() const;
+
+            void Prepare();
+            bool IsPrepared() const;
+
+            // inside the outline and no hole. uses the grid if prepared and
+            // every edge otherwise
+            bool Contains(const VectorBase& p) const;
+
+            // result[i] is 1 for the points of [first,last) inside, 0 otherwise
+            template< typename iterator >
+            void ComputeContains(iterator first, iterator last, std::vector<uint8_t>& result,
+                const ExecutionPolicy& policy = ExecutionPolicy()) const;
+
+        private:
+            // an edge as seen from one cell. mCrossY is the y of the end right
+            // of the cell of an edge crossing its right side, nan otherwise
+            class CellEdge
+            {
+                public:
+                    double mAx, mAy, mBx, mBy;
+                    double mCrossY;
+            };
+
+            // edges run from point i to the next point of its ring
+            size_t GetNext(size_t i) const;
+
+            double GetCellMinX(size_t column) const;
+            double GetCellMinY(size_t row) const;
+            size_t GetColumn(double x) const;
+            size_t GetRow(double y) const;
+            bool ContainsBruteForce(double x, double y) const;
+
+            std::vector<VectorType> mPoints;
+            std::vector<size_t> mRingStart;
+            std::vector<uint32_t> mRingOf;
+            BoundsType mBounds;
+
+            bool mPrepared;
+            double mMin[2];
+            double mMax[2];
+            double mCellSize[2];
+            size_t mColumns;
+            size_t mRows;
+            std::vector<size_t> mCellStart;
+            std::vector<CellEdge> mCellEdges;
+            std::vector<uint8_t> mCellParity;
+    };
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template <typename Scalar>
+    Polygon2d<Scalar>::Polygon2d()
+        : mRingStart(1, 0)
+        , mBounds(uninitialised)
+        , mPrepared(false)
+        , mColumns(0)
+        , mRows(0)
+    {
+    }
+
+    template <typename Scalar>
+    Polygon2d<Scalar>::Polygon2d(const std::vector<VectorType>& outline)
+        : Polygon2d()
+    {
+        AddRing( outline );
+    }
+
+    template <typename Scalar>
+    void Polygon2d<Scalar>::AddRing(const std::vector<VectorType>& ring)
+    {
+        assert( !ring.empty() );
+        if (mPoints.empty())
+            mBounds = BoundsType( ring[0] );
+        const uint32_t index = uint32_t( GetRingCount() );
+        for (const VectorType& p : ring)
+        {
+            mPoints.push_back( p );
+            mRingOf.push_back( index );
+            mBounds.ExpandToContain( p );
+        }
+        mRingStart.push_back( mPoints.size() );
+        mPrepared = false;
+    }
+
+    template <typename Scalar>
+    size_t Polygon2d<Scalar>::GetRingCount() const
+    {
+        return mRingStart.size()-1;
+    }
+
+    template <typename Scalar>
+    size_t Polygon2d<Scalar>::GetRingSize(size_t ring) const
+    {
+        return mRingStart[ring+1] - mRingStart[ring];
+    }
+
+    template <typename Scalar>
+    size_t Polygon2d<Scalar>::GetRingStart(size_t ring) const
+    {
+        return mRingStart[ring];
+    }
+
+    template <typename Scalar>
+    const std::vector<typename Polygon2d<Scalar>::VectorType>& Polygon2d<Scalar>::GetPoints() const
+    {
+        return mPoints;
+    }
+
+    template <typename Scalar>
+    double Polygon2d<Scalar>::GetSignedArea(size_t ring) const
+    {
+        double sum = 0;
+        for (size_t i=mRingStart[ring];i!=mRingStart[ring+1];++i)
+        {
+            const VectorType& a = mPoints[i];
+            const VectorType& b = mPoints[GetNext( i )];
+            sum += double( a[0] )*double( b[1] ) - double( b[0] )*double( a[1] );
+        }
+        return sum/2;
+    }
+
+    template <typename Scalar>
+    double Polygon2d<Scalar>::GetArea() const
+    {
+        double area = 0;
+        for (size_t r=0;r!=GetRingCount();++r)
+            area += r==0 ? Fabs( GetSignedArea( r ) ) : -Fabs( GetSignedArea( r ) );
+        return area;
+    }
+
+    template <typename Scalar>
+    const typename Polygon2d<Scalar>::BoundsType& Polygon2d<Scalar>::GetBounds() const
+    {
+        assert( !mPoints.empty() );
+        return mBounds;
+    }
+
+    template <typename Scalar>
+    void Polygon2d<Scalar>::Prepare()
+    {
+        mCellStart.clear();
+        mCellEdges.clear();
+        mCellParity.clear();
+        mColumns = mRows = 0;
+        mPrepared = true;
+        if (mPoints.empty())
+            return;
+
+        const size_t edges = mPoints.size();
+        for (size_t d=0;d!=2;++d)
+        {
+            mMin[d] = mMax[d] = double( mPoints[0][d] );
+            for (const VectorType& p : mPoints)
+            {
+                mMin[d] = std::min( mMin[d], double( p[d] ) );
+                mMax[d] = std::max( mMax[d], double( p[d] ) );
+            }
+        }
+
+        // about two cells an edge, square where the bounds allow it
+        const size_t maxAxis = 2048;
+        const double width = mMax[0] - mMin[0];
+        const double height = mMax[1] - mMin[1];
+        const double cells = double( 2*edges );
+        double columns = 1, rows = 1;
+        if (width > 0 && height > 0)
+        {
+            columns = std::sqrt( cells*width/height );
+            rows = std::sqrt( cells*height/width );
+        }
+        else if (width > 0)
+        {
+            columns = cells;
+        }
+        else if (height > 0)
+        {
+            rows = cells;
+        }
+        mColumns = size_t( std::min( std::max( columns, 1.0 ), double( maxAxis ) ) );
+        mRows = size_t( std::min( std::max( rows, 1.0 ), double( maxAxis ) ) );
+        mCellSize[0] = width > 0 ? width/double( mColumns ) : 1;
+        mCellSize[1] = height > 0 ? height/double( mRows ) : 1;
+
+        // the cells touching an edge's box, closed on every side, and the
+        // first column whose right side reaches the box
+        auto span = [&](size_t e, size_t range[4]) {
+            const VectorType& a = mPoints[e];
+            const VectorType& b = mPoints[GetNext( e )];
+            const double minX = std::min( double( a[0] ), double( b[0] ) );
+            const double maxX = std::max( double( a[0] ), double( b[0] ) );
+            const double minY = std::min( double( a[1] ), double( b[1] ) );
+            const double maxY = std::max( double( a[1] ), double( b[1] ) );
+            range[0] = GetColumn( minX );
+            if (range[0]!=0 && GetCellMinX( range[0] )==minX)
+                --range[0];
+            range[1] = GetColumn( maxX );
+            range[2] = GetRow( minY );
+            if (range[2]!=0 && GetCellMinY( range[2] )==minY)
+                --range[2];
+            range[3] = GetRow( maxY );
+        };
+
+        mCellStart.assign( mColumns*mRows + 1, 0 );
+        size_t range[4];
+        for (size_t e=0;e!=edges;++e)
+        {
+            span( e, range );
+            for (size_t row=range[2];row<=range[3];++row)
+                for (size_t column=range[0];column<=range[1];++column)
+                    ++mCellStart[row*mColumns + column + 1];
+        }
+        for (size_t c=0;c!=mColumns*mRows;++c)
+            mCellStart[c+1] += mCellStart[c];
+
+        mCellEdges.resize( mCellStart.back() );
+        std::vector<size_t> next( mCellStart.begin(), mCellStart.end()-1 );
+        std::vector<uint8_t> marks( mColumns*mRows, 0 );
+        for (size_t e=0;e!=edges;++e)
+        {
+            const VectorType& a = mPoints[e];
+            const VectorType& b = mPoints[GetNext( e )];
+            span( e, range );
+            for (size_t row=range[2];row<=range[3];++row)
+            {
+                for (size_t column=range[0];column<=range[1];++column)
+                {
+                    CellEdge& edge = mCellEdges[next[row*mColumns + column]++];
+                    const double right = GetCellMinX( column+1 );
+                    edge.mAx = double( a[0] );
+                    edge.mAy = double( a[1] );
+                    edge.mBx = double( b[0] );
+                    edge.mBy = double( b[1] );
+                    edge.mCrossY = std::numeric_limits<double>::quiet_NaN();
+                    if (edge.mAx > right && edge.mBx <= right)
+                        edge.mCrossY = edge.mAy;
+                    if (edge.mBx > right && edge.mAx <= right)
+                        edge.mCrossY = edge.mBy;
+                }
+            }
+
+            // the rows whose bottom the edge straddles see it from every
+            // cell left of its box, marked at the last of them
+            const double minY = std::min( double( a[1] ), double( b[1] ) );
+            const double maxY = std::max( double( a[1] ), double( b[1] ) );
+            if (range[0]!=0)
+            {
+                for (size_t row=range[2];row!=mRows && GetCellMinY( row ) < maxY;++row)
+                {
+                    if (GetCellMinY( row ) >= minY)
+                        marks[row*mColumns + range[0]-1] ^= 1;
+                }
+            }
+        }
+
+        mCellParity.resize( mColumns*mRows );
+        for (size_t row=0;row!=mRows;++row)
+        {
+            uint8_t parity = 0;
+            for (size_t column=mColumns;column--!=0;)
+            {
+                parity ^= marks[row*mColumns + column];
+                mCellParity[row*mColumns + column] = parity;
+            }
+        }
+    }
+
+    template <typename Scalar>
+    bool Polygon2d<Scalar>::IsPrepared() const
+    {
+        return mPrepared;
+    }
+
+    template <typename Scalar>
+    bool Polygon2d<Scalar>::Contains(const VectorBase& p) const
+    {
+        const double x = double( p[0] );
+        const double y = double( p[1] );
+        if (!mPrepared)
+            return ContainsBruteForce( x, y );
+        // written so nan is outside
+        if (mPoints.empty() || !(x >= mMin[0] && x <= mMax[0] && y >= mMin[1] && y <= mMax[1]))
+            return false;
+
+        // the parity at the cell's corner, moved along the cell's bottom to
+        // its right side, up that to y, and left to the point
+        const size_t column = GetColumn( x );
+        const size_t row = GetRow( y );
+        const size_t cell = row*mColumns + column;
+        const double bottom = GetCellMinY( row );
+        bool inside = mCellParity[cell]!=0;
+        for (size_t i=mCellStart[cell];i!=mCellStart[cell+1];++i)
+        {
+            const CellEdge& e = mCellEdges[i];
+            const bool aAbove = e.mAy > y;
+            const bool bAbove = e.mBy > y;
+            if (aAbove!=bAbove)
+            {
+                const double o = Orient2d( e.mAx, e.mAy, e.mBx, e.mBy, x, y );
+                inside ^= bAbove ? o > 0 : o < 0;
+            }
+            inside ^= (e.mCrossY > y)!=(e.mCrossY > bottom);
+        }
+        return inside;
+    }
+
+    template <typename Scalar>
+    template< typename iterator >
+    void Polygon2d<Scalar>::ComputeContains(iterator first, iterator last, std::vector<uint8_t>& result,
+        const ExecutionPolicy& policy) const
+    {
+        result.resize( size_t( last - first ) );
+        uint8_t* out = result.data();
+        ParallelFor( policy, 0, result.size(), [&](size_t begin, size_t end) {
+            for (size_t i=begin;i!=end;++i)
+                out[i] = Contains( first[i] ) ? 1 : 0;
+        } );
+    }
+
+    template <typename Scalar>
+    size_t Polygon2d<Scalar>::GetNext(size_t i) const
+    {
+        const size_t ring = mRingOf[i];
+        return i+1==mRingStart[ring+1] ? mRingStart[ring] : i+1;
+    }
+
+    template <typename Scalar>
+    double Polygon2d<Scalar>::GetCellMinX(size_t column) const
+    {
+        return column==mColumns ? mMax[0] : mMin[0] + double( column )*mCellSize[0];
+    }
+
+    template <typename Scalar>
+    double Polygon2d<Scalar>::GetCellMinY(size_t row) const
+    {
+        return row==mRows ? mMax[1] : mMin[1] + double( row )*mCellSize[1];
+    }
+
+    // the column with GetCellMinX(c) <= x < GetCellMinX(c+1), the last
+    // closed on the right, so that the rounding in the first guess does not
+    // put a point outside its cell
+    template <typename Scalar>
+    size_t Polygon2d<Scalar>::GetColumn(double x) const
+    {
+        const double guess = (x - mMin[0])/mCellSize[0];
+        size_t c = guess > 0 ? std::min( size_t( guess ), mColumns-1 ) : 0;
+        while (c!=0 && x < GetCellMinX( c ))
+            --c;
+        while (c+1!=mColumns && x >= GetCellMinX( c+1 ))
+            ++c;
+        return c;
+    }
+
+    template <typename Scalar>
+    size_t Polygon2d<Scalar>::GetRow(double y) const
+    {
+        const double guess = (y - mMin[1])/mCellSize[1];
+        size_t r = guess > 0 ? std::min( size_t( guess ), mRows-1 ) : 0;
+        while (r!=0 && y < GetCellMinY( r ))
+            --r;
+        while (r+1!=mRows && y >= GetCellMinY( r+1 ))
+            ++r;
+        return r;
+    }
+
+    // crossings of the ray from the point towards +x. an edge counts if one
+    // end is above the point and the other not, and the point is strictly
+    // left of it
+    template <typename Scalar>
+    bool Polygon2d<Scalar>::ContainsBruteForce(double x, double y) const
+    {
+        bool inside = false;
+        for (size_t i=0;i!=mPoints.size();++i)
+        {
+            const VectorType& a = mPoints[i];
+            const VectorType& b = mPoints[GetNext( i )];
+            const bool aAbove = double( a[1] ) > y;
+            const bool bAbove = double( b[1] ) > y;
+            if (aAbove!=bAbove)
+            {
+                const double o = Orient2d( double( a[0] ), double( a[1] ), double( b[0] ), double( b[1] ), x, y );
+                inside ^= bAbove ? o > 0 : o < 0;
+            }
+        }
+        return inside;
+    }
+}
+
+#endif//GEOMETRY_POLYGON2D_H_INCLUDED_
@@ -0,0 +1,399 @@
+#ifndef GEOMETRY_POLYGON_TRIANGULATION_H_INCLUDED_
+#define GEOMETRY_POLYGON_TRIANGULATION_H_INCLUDED_
+
+#include "polygon2d.h"
+#include "convex_hull.h"
+
+#include <cassert>
+#include <cstdint>
+#include <set>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Free-functions
+    //
+
+    // the order the triangulation sweeps points in: top first, left first
+    // along a horizontal, and by index for equal points
+    template< typename VectorType >
+    bool IsAboveInSweep(const std::vector<VectorType>& points, uint32_t a, uint32_t b)
+    {
+        const double ay = double( points[a][1] ), by = double( points[b][1] );
+        if (ay!=by)
+            return ay > by;
+        const double ax = double( points[a][0] ), bx = double( points[b][0] );
+        return ax!=bx ? ax < bx : a < b;
+    }
+
+    // a point to look up in the sweep status of ComputeTriangulation
+    class SweepPoint
+    {
+        public:
+            uint32_t mVertex;
+    };
+
+    // orders the sweep status of ComputeTriangulation, the edges v->next[v]
+    // crossing the sweep line. they never cross, so an edge is placed by
+    // where the lower of the two tops is against the other
+    template< typename VectorType >
+    class SweepStatusOrder
+    {
+        public:
+            typedef void is_transparent;
+
+            SweepStatusOrder(const std::vector<VectorType>& points, const std::vector<uint32_t>& next)
+                : mPoints(&points), mNext(&next)
+            { }
+
+            // <0 if p is left of the edge going down from e, >0 if right
+            double Side(uint32_t e, uint32_t p) const
+            {
+                const std::vector<VectorType>& points = *mPoints;
+                return Orient2d( points[e], points[(*mNext)[e]], points[p] );
+            }
+            bool operator()(uint32_t a, uint32_t b) const
+            {
+                if (a==b)
+                    return false;
+                const bool aLower = IsAboveInSweep( *mPoints, b, a );
+                const uint32_t g = aLower ? a : b;
+                const uint32_t h = aLower ? b : a;
+                double side = Side( h, g );
+                if (side==0)
+                    side = Side( h, (*mNext)[g] );
+                return (side < 0)==aLower;
+            }
+            bool operator()(uint32_t e, const SweepPoint& p) const
+            {
+                return Side( e, p.mVertex ) > 0;
+            }
+            bool operator()(const SweepPoint& p, uint32_t e) const
+            {
+                return Side( e, p.mVertex ) < 0;
+            }
+
+        private:
+            const std::vector<VectorType>* mPoints;
+            const std::vector<uint32_t>* mNext;
+    };
+
+    // triangulates a simple polygon with holes in O(n log n): a sweep from
+    // the top adds the diagonals that split it into y-monotone pieces, and
+    // each piece is then triangulated in linear time (de Berg et al.,
+    // "Computational Geometry", chapter 3). triangles are appended to one
+    // flat buffer, three indices into polygon.GetPoints() each and
+    // counterclockwise, reserved up front as there are n + 2h - 2 of them
+    // for n points and h holes, less any that collinear points would leave
+    // with no area. every decision is an exact Orient2d.
+    // rings of fewer than three points are skipped; rings that cross or
+    // touch are not supported. false, with no triangles, if the outline
+    // has fewer than three points
+    template <typename Scalar>
+    bool ComputeTriangulation(const Polygon2d<Scalar>& polygon, std::vector<uint32_t>& triangles)
+    {
+        typedef typename Polygon2d<Scalar>::VectorType VectorType;
+        const std::vector<VectorType>& points = polygon.GetPoints();
+        triangles.clear();
+        if (polygon.GetRingCount()==0 || polygon.GetRingSize( 0 ) < 3)
+            return false;
+        assert( points.size() < size_t( UINT32_MAX ) );
+
+        // the outline counterclockwise and holes clockwise, so the
+        // inside is always left of next
+        std::vector<uint32_t> next( points.size() ), prev( points.size() );
+        std::vector<uint32_t> events;
+        size_t holes = 0;
+        for (size_t r=0;r!=polygon.GetRingCount();++r)
+        {
+            const size_t size = polygon.GetRingSize( r );
+            if (size < 3)
+                continue;
+            holes += r!=0;
+            const uint32_t start = uint32_t( polygon.GetRingStart( r ) );
+            const bool reverse = (r==0)!=(polygon.GetSignedArea( r ) > 0);
+            for (uint32_t k=0;k!=size;++k)
+            {
+                const uint32_t i = start + k;
+                const uint32_t j = start + uint32_t( (k+1)%size );
+                if (reverse)
+                {
+                    next[j] = i;
+                    prev[i] = j;
+                }
+                else
+                {
+                    next[i] = j;
+                    prev[j] = i;
+                }
+                events.push_back( i );
+            }
+        }
+
+        auto above = [&](uint32_t a, uint32_t b) {
+            return IsAboveInSweep( points, a, b );
+        };
+        std::sort( events.begin(), events.end(), above );
+        triangles.reserve( 3*(events.size() + 2*holes - 2) );
+
+        enum class VertexKind { start, end, split, merge, regular };
+        std::vector<VertexKind> kind( points.size(), VertexKind::regular );
+        for (uint32_t v : events)
+        {
+            const bool prevBelow = above( v, prev[v] );
+            const bool nextBelow = above( v, next[v] );
+            const bool convex = Orient2d( points[prev[v]], points[v], points[next[v]] ) > 0;
+            if (prevBelow && nextBelow)
+                kind[v] = convex ? VertexKind::start : VertexKind::split;
+            else if (!prevBelow && !nextBelow)
+                kind[v] = convex ? VertexKind::end : VertexKind::merge;
+        }
+
+        // the sweep status holds the edges v->next[v] with the inside to
+        // their right, left to right
+        typedef std::set< uint32_t, SweepStatusOrder<VectorType> > Status;
+        Status status( SweepStatusOrder<VectorType>( points, next ) );
+        std::vector<typename Status::iterator> where( points.size() );
+        std::vector<uint32_t> helper( points.size() );
+        std::vector<uint32_t> diagonals;
+
+        auto insert = [&](uint32_t v) {
+            where[v] = status.insert( v ).first;
+            helper[v] = v;
+        };
+        auto leftOf = [&](uint32_t v) {
+            typename Status::iterator it = status.lower_bound( SweepPoint{ v } );
+            assert( it!=status.begin() );
+            return *--it;
+        };
+        auto connectMerge = [&](uint32_t v, uint32_t e) {
+            if (kind[helper[e]]==VertexKind::merge)
+            {
+                diagonals.push_back( v );
+                diagonals.push_back( helper[e] );
+            }
+        };
+
+        for (uint32_t v : events)
+        {
+            switch (kind[v])
+            {
+                case VertexKind::start:
+                    insert( v );
+                    break;
+                case VertexKind::end:
+                    connectMerge( v, prev[v] );
+                    status.erase( where[prev[v]] );
+                    break;
+                case VertexKind::split:
+                {
+                    const uint32_t e = leftOf( v );
+                    diagonals.push_back( v );
+                    diagonals.push_back( helper[e] );
+                    helper[e] = v;
+                    insert( v );
+                    break;
+                }
+                case VertexKind::merge:
+                {
+                    connectMerge( v, prev[v] );
+                    status.erase( where[prev[v]] );
+                    const uint32_t e = leftOf( v );
+                    connectMerge( v, e );
+                    helper[e] = v;
+                    break;
+                }
+                case VertexKind::regular:
+                    if (above( prev[v], v ))
+                    {
+                        // on a left chain, the inside to the right
+                        connectMerge( v, prev[v] );
+                        status.erase( where[prev[v]] );
+                        insert( v );
+                    }
+                    else
+                    {
+                        const uint32_t e = leftOf( v );
+                        connectMerge( v, e );
+                        helper[e] = v;
+                    }
+                    break;
+            }
+        }
+
+        // half edges of the boundary and both ways along each diagonal,
+        // those leaving each vertex sorted counterclockwise
+        std::vector<uint32_t> from, to;
+        for (uint32_t v : events)
+        {
+            from.push_back( v );
+            to.push_back( next[v] );
+        }
+        for (size_t d=0;d!=diagonals.size();d+=2)
+        {
+            from.push_back( diagonals[d] );
+            to.push_back( diagonals[d+1] );
+            from.push_back( diagonals[d+1] );
+            to.push_back( diagonals[d] );
+        }
+        const size_t halfEdges = from.size();
+        std::vector<uint32_t> outStart( points.size()+1, 0 );
+        for (size_t h=0;h!=halfEdges;++h)
+            ++outStart[from[h]+1];
+        for (size_t v=0;v!=points.size();++v)
+            outStart[v+1] += outStart[v];
+        std::vector<uint32_t> out( halfEdges );
+        {
+            std::vector<uint32_t> fill( outStart.begin(), outStart.end()-1 );
+            for (size_t h=0;h!=halfEdges;++h)
+                out[fill[from[h]]++] = uint32_t( h );
+        }
+
+        // true if the direction to a comes before that to b around v,
+        // counting counterclockwise from +x
+        auto angleBefore = [&](uint32_t v, uint32_t a, uint32_t b) {
+            auto upper = [&](uint32_t p) {
+                const double dy = double( points[p][1] ) - double( points[v][1] );
+                return dy > 0 || (dy==0 && double( points[p][0] ) > double( points[v][0] ));
+            };
+            const bool ua = upper( a ), ub = upper( b );
+            if (ua!=ub)
+                return ua;
+            return Orient2d( points[v], points[a], points[b] ) > 0;
+        };
+        for (size_t v=0;v!=points.size();++v)
+        {
+            if (outStart[v+1] - outStart[v] > 1)
+            {
+                std::sort( out.begin()+outStart[v], out.begin()+outStart[v+1], [&](uint32_t a, uint32_t b) {
+                    return angleBefore( uint32_t(v), to[a], to[b] );
+                } );
+            }
+        }
+
+        // the face left of u->v goes on along the edge leaving v just
+        // clockwise of the way back to u
+        auto following = [&](uint32_t h) {
+            const uint32_t v = to[h];
+            const uint32_t u = from[h];
+            const uint32_t first = outStart[v], last = outStart[v+1];
+            if (last - first == 1)
+                return out[first];
+            const uint32_t k = uint32_t( std::lower_bound( out.begin()+first, out.begin()+last, u,
+                [&](uint32_t e, uint32_t p) { return angleBefore( v, to[e], p ); } ) - out.begin() );
+            return out[k==first ? last-1 : k-1];
+        };
+
+        auto emit = [&](uint32_t a, uint32_t b, uint32_t c) {
+            triangles.push_back( a );
+            triangles.push_back( b );
+            triangles.push_back( c );
+        };
+
+        // each face is monotone; walk its two chains down together
+        std::vector<uint8_t> visited( halfEdges, 0 );
+        std::vector<uint32_t> face;
+        std::vector<uint32_t> sweep;
+        std::vector<uint8_t> onLeft;
+        std::vector<uint32_t> stack;
+        for (size_t start=0;start!=halfEdges;++start)
+        {
+            if (visited[start])
+                continue;
+            face.clear();
+            for (uint32_t h=uint32_t(start);!visited[h];h=following( h ))
+            {
+                visited[h] = 1;
+                face.push_back( from[h] );
+            }
+            const size_t m = face.size();
+            if (m < 3)
+                continue;
+
+            size_t top = 0, bottom = 0;
+            for (size_t i=1;i!=m;++i)
+            {
+                if (above( face[i], face[top] ))
+                    top = i;
+                if (above( face[bottom], face[i] ))
+                    bottom = i;
+            }
+
+            // counterclockwise from the top runs down the left chain
+            sweep.clear();
+            onLeft.clear();
+            sweep.push_back( face[top] );
+            onLeft.push_back( 1 );
+            size_t l = (top+1)%m, r = (top+m-1)%m;
+            while (l!=bottom || r!=bottom)
+            {
+                const bool left = r==bottom || (l!=bottom && above( face[l], face[r] ));
+                sweep.push_back( left ? face[l] : face[r] );
+                onLeft.push_back( left );
+                if (left)
+                    l = (l+1)%m;
+                else
+                    r = (r+m-1)%m;
+            }
+            sweep.push_back( face[bottom] );
+            onLeft.push_back( onLeft.back() );
+
+            // a fan from w to the chain a above b, kept counterclockwise.
+            // collinear points left on the stack would give a triangle with
+            // no area, which covers nothing and is left out
+            auto fan = [&](uint32_t a, uint32_t b, uint32_t w, bool left) {
+                if (Orient2d( points[a], points[b], points[w] )==0)
+                    return;
+                if (left)
+                    emit( a, b, w );
+                else
+                    emit( a, w, b );
+            };
+
+            stack.clear();
+            stack.push_back( 0 );
+            stack.push_back( 1 );
+            for (size_t j=2;j+1<m;++j)
+            {
+                const uint32_t w = sweep[j];
+                if (onLeft[j]!=onLeft[stack.back()])
+                {
+                    const bool left = onLeft[stack.back()]!=0;
+                    for (size_t i=0;i+1<stack.size();++i)
+                        fan( sweep[stack[i]], sweep[stack[i+1]], w, left );
+                    const size_t last = stack.back();
+                    stack.clear();
+                    stack.push_back( last );
+                    stack.push_back( j );
+                }
+                else
+                {
+                    const bool left = onLeft[j]!=0;
+                    size_t last = stack.back();
+                    stack.pop_back();
+                    while (!stack.empty())
+                    {
+                        const uint32_t a = sweep[stack.back()];
+                        const uint32_t b = sweep[last];
+                        const double turn = Orient2d( points[a], points[b], points[w] );
+                        if (left ? !(turn > 0) : !(turn < 0))
+                            break;
+                        fan( a, b, w, left );
+                        last = stack.back();
+                        stack.pop_back();
+                    }
+                    stack.push_back( last );
+                    stack.push_back( j );
+                }
+            }
+            const bool left = onLeft[stack.back()]!=0;
+            for (size_t i=0;i+1<stack.size();++i)
+                fan( sweep[stack[i]], sweep[stack[i+1]], sweep[m-1], left );
+        }
+        return true;
+    }
+}
+
+#endif//GEOMETRY_POLYGON_TRIANGULATION_H_INCLUDED_
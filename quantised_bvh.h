@@ -0,0 +1,462 @@
+#ifndef GEOMETRY_QUANTISED_BVH_H_INCLUDED_
+#define GEOMETRY_QUANTISED_BVH_H_INCLUDED_
+
+#include "bvh.h"
+#include "aabb3d.h"
+#include "ray3d.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // compressed copy of a TriangleBVH for memory bound traversal. the binary
+    // tree is collapsed into W wide nodes, and each node stores its children's
+    // bounds as Quantised (uint8_t or uint16_t) offsets on a grid spanning
+    // the node's own bounds. minimums round down and maximums round up, checked
+    // against the exact dequantised values, so a child's box only ever grows
+    // and no hit the source tree finds is missed. leaves share the source's
+    // TriangleBlock layout, so hits report the same triangle ids
+    template <typename Scalar, typename Quantised = uint8_t, size_t W = 4>
+    class QuantisedBVH
+    {
+        public:
+            typedef TriangleBVH<Scalar> SourceType;
+            typedef typename SourceType::BoundsType BoundsType;
+            typedef typename SourceType::RayType RayType;
+            typedef typename SourceType::HitType HitType;
+            typedef typename SourceType::BlockType BlockType;
+            const static size_t sWidth = W;
+
+            explicit QuantisedBVH(const SourceType& bvh);
+
+            size_t GetNodeCount() const;
+            const BoundsType& GetBounds() const;
+
+            // bytes held by the node array, not counting the triangle blocks
+            size_t GetNodeMemory() const;
+
+            // the dequantised box of child lane of node, as traversal sees it
+            BoundsType GetChildBounds(size_t node, size_t lane) const;
+            bool HasChild(size_t node, size_t lane) const;
+
+            // as TriangleBVH::ClosestHit
+            bool ClosestHit(const RayType& ray, HitType* hit) const;
+
+            // as TriangleBVH::AnyHit
+            bool AnyHit(const RayType& ray, Scalar tMax) const;
+
+        private:
+            const static uint32_t sLeaf = 0x80000000;
+            const static uint32_t sEmpty = 0xffffffff;
+
+            class Node
+            {
+                public:
+                    // child bounds are mOrigin + q * mScale per axis
+                    Scalar mOrigin[3];
+                    Scalar mScale[3];
+                    Quantised mLo[3][W];
+                    Quantised mHi[3][W];
+                    // inner: node index, leaf: block index | sLeaf, unused: sEmpty
+                    uint32_t mChild[W];
+            };
+
+            // which source nodes become the children of each wide node
+            class Collapse
+            {
+                public:
+                    explicit Collapse(const SourceType& bvh);
+
+                    // the frontier of source nodes under inner node root
+                    size_t GetChildren(size_t root, size_t children[W]) const;
+
+                private:
+                    void Gather(size_t node, size_t k, size_t children[W], size_t& count) const;
+
+                    const SourceType& mBvh;
+                    // per source node and frontier size k, the share of k taken by the left child
+                    std::vector<uint8_t> mSplit;
+                    // per source node, the frontier size of the wide node rooted there
+                    std::vector<uint8_t> mWidth;
+            };
+
+            uint32_t BuildNode(const SourceType& bvh, const Collapse& collapse, size_t root);
+            static void SetFrame(Node& node, const BoundsType& bounds);
+            static void SetChildBounds(Node& node, size_t lane, const BoundsType& bounds);
+
+            // slab test against every child at once, returns a bit per lane hit
+            // before tMax along with the entry distances
+            static unsigned IntersectChildren(const Node& node, const RayType& ray, Scalar tMax, Scalar tNear[W]);
+
+            std::vector<Node> mNodes;
+            std::vector<BlockType> mBlocks;
+            BoundsType mBounds;
+    };
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template <typename Scalar, typename Quantised, size_t W>
+    QuantisedBVH<Scalar, Quantised, W>::QuantisedBVH(const SourceType& bvh)
+        : mBounds(uninitialised)
+    {
+        static_assert( std::is_unsigned<Quantised>::value, "quantised bounds are unsigned offsets" );
+        static_assert( W>=2 && W<=sizeof(unsigned)*8, "one mask bit per lane" );
+        if (bvh.GetNodeCount()==0) return;
+
+        mBounds = bvh.GetBounds();
+        mNodes.reserve( bvh.GetNodeCount() / (W-1) + 1 );
+        BuildNode( bvh, Collapse( bvh ), 0 );
+    }
+
+    template <typename Scalar, typename Quantised, size_t W>
+    size_t QuantisedBVH<Scalar, Quantised, W>::GetNodeCount() const
+    {
+        return mNodes.size();
+    }
+
+    template <typename Scalar, typename Quantised, size_t W>
+    const typename QuantisedBVH<Scalar, Quantised, W>::BoundsType& QuantisedBVH<Scalar, Quantised, W>::GetBounds() const
+    {
+        assert( !mNodes.empty() );
+        return mBounds;
+    }
+
+    template <typename Scalar, typename Quantised, size_t W>
+    size_t QuantisedBVH<Scalar, Quantised, W>::GetNodeMemory() const
+    {
+        return mNodes.size() * sizeof(Node);
+    }
+
+    template <typename Scalar, typename Quantised, size_t W>
+    bool QuantisedBVH<Scalar, Quantised, W>::HasChild(size_t node, size_t lane) const
+    {
+        assert( node<mNodes.size() && lane<W );
+        return mNodes[node].mChild[lane]!=sEmpty;
+    }
+
+    template <typename Scalar, typename Quantised, size_t W>
+    typename QuantisedBVH<Scalar, Quantised, W>::BoundsType QuantisedBVH<Scalar, Quantised, W>::GetChildBounds(size_t node, size_t lane) const
+    {
+        assert( HasChild(node, lane) );
+        const Node& n = mNodes[node];
+        Vector3d<Scalar> lo(uninitialised), hi(uninitialised);
+        for (size_t d=0;d!=3;++d)
+        {
+            lo[d] = n.mOrigin[d] + Scalar(n.mLo[d][lane]) * n.mScale[d];
+            hi[d] = n.mOrigin[d] + Scalar(n.mHi[d][lane]) * n.mScale[d];
+        }
+        return BoundsType( lo, hi );
+    }
+
+    // static
+    template <typename Scalar, typename Quantised, size_t W>
+    void QuantisedBVH<Scalar, Quantised, W>::SetFrame(Node& node, const BoundsType& bounds)
+    {
+        const Quantised top = std::numeric_limits<Quantised>::max();
+        for (size_t d=0;d!=3;++d)
+        {
+            const Scalar lo = bounds.GetMinBound()[d];
+            const Scalar hi = bounds.GetMaxBound()[d];
+            Scalar scale = (hi - lo) / top;
+            // the top of the grid must reach the node's own maximum
+            while (lo + Scalar(top) * scale < hi)
+                scale = std::nextafter( scale, std::numeric_limits<Scalar>::max() );
+            node.mOrigin[d] = lo;
+            node.mScale[d] = scale;
+        }
+    }
+
+    // static
+    template <typename Scalar, typename Quantised, size_t W>
+    void QuantisedBVH<Scalar, Quantised, W>::SetChildBounds(Node& node, size_t lane, const BoundsType& bounds)
+    {
+        const Scalar top = std::numeric_limits<Quantised>::max();
+        for (size_t d=0;d!=3;++d)
+        {
+            const Scalar origin = node.mOrigin[d];
+            const Scalar scale = node.mScale[d];
+            const Scalar lo = bounds.GetMinBound()[d];
+            const Scalar hi = bounds.GetMaxBound()[d];
+
+            // flat axis, every q lands on the origin
+            if (scale == 0)
+            {
+                node.mLo[d][lane] = 0;
+                node.mHi[d][lane] = 0;
+                continue;
+            }
+
+            Scalar qlo = std::min( std::max( std::floor( (lo - origin) / scale ), Scalar(0) ), top );
+            Scalar qhi = std::min( std::max( std::ceil( (hi - origin) / scale ), Scalar(0) ), top );
+
+            // the division can round either way, step until the exact
+            // dequantised values traversal computes enclose the box
+            while (qlo > 0 && origin + qlo * scale > lo)
+                qlo -= 1;
+            while (qhi < top && origin + qhi * scale < hi)
+                qhi += 1;
+
+            node.mLo[d][lane] = Quantised(qlo);
+            node.mHi[d][lane] = Quantised(qhi);
+        }
+    }
+
+    // dynamic programming over the source tree for the collapse giving the
+    // fewest wide nodes. cost[n][k] is the fewest wide nodes needed below a
+    // frontier of k nodes cut from n's subtree; a frontier of 1 is n itself,
+    // which costs one wide node plus its own best frontier if n is inner.
+    // greedy collapses leave half empty nodes wherever the binary depth is
+    // not a multiple of log2(W), this packs them
+    template <typename Scalar, typename Quantised, size_t W>
+    QuantisedBVH<Scalar, Quantised, W>::Collapse::Collapse(const SourceType& bvh)
+        : mBvh(bvh)
+        , mSplit( bvh.GetNodeCount()*(W+1), 0 )
+        , mWidth( bvh.GetNodeCount(), 1 )
+    {
+        const uint32_t none = 0xffffffff;
+        std::vector<uint32_t> cost( bvh.GetNodeCount()*(W+1), none );
+
+        // children always follow their parent in the source
+        for (size_t n=bvh.GetNodeCount();n--!=0;)
+        {
+            uint32_t* c = &cost[n*(W+1)];
+            if (bvh.IsLeaf(n))
+            {
+                c[1] = 0;
+                continue;
+            }
+
+            const uint32_t* l = &cost[bvh.GetLeftChild(n)*(W+1)];
+            const uint32_t* r = &cost[bvh.GetRightChild(n)*(W+1)];
+            for (size_t k=2;k<=W;++k)
+            {
+                for (size_t i=1;i<k;++i)
+                {
+                    if (l[i]==none || r[k-i]==none) continue;
+                    if (l[i] + r[k-i] < c[k])
+                    {
+                        c[k] = l[i] + r[k-i];
+                        mSplit[n*(W+1)+k] = uint8_t(i);
+                    }
+                }
+            }
+
+            size_t best = 2;
+            for (size_t k=3;k<=W;++k)
+            {
+                if (c[k] < c[best])
+                    best = k;
+            }
+            mWidth[n] = uint8_t(best);
+            c[1] = c[best] + 1;
+        }
+    }
+
+    template <typename Scalar, typename Quantised, size_t W>
+    size_t QuantisedBVH<Scalar, Quantised, W>::Collapse::GetChildren(size_t root, size_t children[W]) const
+    {
+        size_t count = 0;
+        if (mBvh.IsLeaf(root))
+            children[count++] = root;
+        else
+            Gather( root, mWidth[root], children, count );
+        return count;
+    }
+
+    template <typename Scalar, typename Quantised, size_t W>
+    void QuantisedBVH<Scalar, Quantised, W>::Collapse::Gather(size_t node, size_t k, size_t children[W], size_t& count) const
+    {
+        if (k==1)
+        {
+            children[count++] = node;
+            return;
+        }
+        const size_t i = mSplit[node*(W+1)+k];
+        Gather( mBvh.GetLeftChild(node), i, children, count );
+        Gather( mBvh.GetRightChild(node), k-i, children, count );
+    }
+
+    template <typename Scalar, typename Quantised, size_t W>
+    uint32_t QuantisedBVH<Scalar, Quantised, W>::BuildNode(const SourceType& bvh, const Collapse& collapse, size_t root)
+    {
+        size_t children[W];
+        const size_t count = collapse.GetChildren( root, children );
+
+        const uint32_t index = uint32_t(mNodes.size());
+        mNodes.push_back( Node() );
+        SetFrame( mNodes[index], bvh.GetNodeBounds(root) );
+        for (size_t lane=0;lane!=W;++lane)
+        {
+            if (lane<count)
+            {
+                SetChildBounds( mNodes[index], lane, bvh.GetNodeBounds(children[lane]) );
+            }
+            else
+            {
+                // inverted box, also masked out by sEmpty
+                for (size_t d=0;d!=3;++d)
+                {
+                    mNodes[index].mLo[d][lane] = std::numeric_limits<Quantised>::max();
+                    mNodes[index].mHi[d][lane] = 0;
+                }
+                mNodes[index].mChild[lane] = sEmpty;
+            }
+        }
+
+        for (size_t lane=0;lane!=count;++lane)
+        {
+            uint32_t child;
+            if (bvh.IsLeaf(children[lane]))
+            {
+                child = uint32_t(mBlocks.size()) | sLeaf;
+                mBlocks.push_back( bvh.GetLeafBlock(children[lane]) );
+            }
+            else
+            {
+                child = BuildNode( bvh, collapse, children[lane] );
+            }
+            // set after the recursion, which may have reallocated mNodes
+            mNodes[index].mChild[lane] = child;
+        }
+        return index;
+    }
+
+    // static
+    template <typename Scalar, typename Quantised, size_t W>
+    unsigned QuantisedBVH<Scalar, Quantised, W>::IntersectChildren(const Node& node, const RayType& ray, Scalar tMax, Scalar tNear[W])
+    {
+        Scalar tFar[W];
+        for (size_t i=0;i!=W;++i)
+        {
+            tNear[i] = 0;
+            tFar[i] = tMax;
+        }
+
+        // the same slab test as Ray3d::Intersection, a lane at a time with
+        // no branches so the dequantise and compare vectorise
+        for (size_t d=0;d!=3;++d)
+        {
+            const Scalar o = ray.GetOrigin()[d];
+            const Scalar inv = ray.GetInverseDirection()[d];
+            const Scalar origin = node.mOrigin[d];
+            const Scalar scale = node.mScale[d];
+            for (size_t i=0;i!=W;++i)
+            {
+                const Scalar lo = origin + Scalar(node.mLo[d][i]) * scale;
+                const Scalar hi = origin + Scalar(node.mHi[d][i]) * scale;
+                const Scalar t0 = (lo - o) * inv;
+                const Scalar t1 = (hi - o) * inv;
+                const Scalar a = t0 > t1 ? t1 : t0;
+                const Scalar b = t0 > t1 ? t0 : t1;
+                tNear[i] = a > tNear[i] ? a : tNear[i];
+                tFar[i] = b < tFar[i] ? b : tFar[i];
+            }
+        }
+
+        unsigned mask = 0;
+        for (size_t i=0;i!=W;++i)
+            mask |= unsigned( tNear[i] <= tFar[i] && node.mChild[i]!=sEmpty ) << i;
+        return mask;
+    }
+
+    template <typename Scalar, typename Quantised, size_t W>
+    bool QuantisedBVH<Scalar, Quantised, W>::ClosestHit(const RayType& ray, HitType* hit) const
+    {
+        assert( hit );
+        Scalar tEntry;
+        if (mNodes.empty() || !ray.Intersection( mBounds, hit->mDistance, &tEntry ))
+            return false;
+
+        // a wide node is never deeper than the binary node it came from
+        uint32_t stack[64*W];
+        Scalar stackDistance[64*W];
+        size_t top = 0;
+        stack[top] = 0;
+        stackDistance[top++] = tEntry;
+
+        bool result = false;
+        while (top)
+        {
+            --top;
+            const uint32_t child = stack[top];
+            // the hit may have moved closer since this was pushed
+            if (stackDistance[top] > hit->mDistance)
+                continue;
+
+            if (child & sLeaf)
+            {
+                result |= mBlocks[child & ~sLeaf].Intersection( ray, hit );
+                continue;
+            }
+
+            Scalar tNear[W];
+            const unsigned mask = IntersectChildren( mNodes[child], ray, hit->mDistance, tNear );
+
+            // push far to near so the nearest child comes off first
+            size_t order[W];
+            size_t count = 0;
+            for (size_t i=0;i!=W;++i)
+            {
+                if (!(mask & (1u << i))) continue;
+                size_t j = count++;
+                for (;j>0 && tNear[order[j-1]] < tNear[i];--j)
+                    order[j] = order[j-1];
+                order[j] = i;
+            }
+            for (size_t n=0;n!=count;++n)
+            {
+                stack[top] = mNodes[child].mChild[order[n]];
+                stackDistance[top++] = tNear[order[n]];
+            }
+            assert( top <= 64*W );
+        }
+        return result;
+    }
+
+    template <typename Scalar, typename Quantised, size_t W>
+    bool QuantisedBVH<Scalar, Quantised, W>::AnyHit(const RayType& ray, Scalar tMax) const
+    {
+        if (mNodes.empty() || !ray.Intersects( mBounds, tMax ))
+            return false;
+
+        uint32_t stack[64*W];
+        size_t top = 0;
+        stack[top++] = 0;
+
+        while (top)
+        {
+            const uint32_t child = stack[--top];
+            if (child & sLeaf)
+            {
+                if (mBlocks[child & ~sLeaf].Intersects( ray, tMax ))
+                    return true;
+                continue;
+            }
+
+            Scalar tNear[W];
+            const unsigned mask = IntersectChildren( mNodes[child], ray, tMax, tNear );
+            for (size_t i=0;i!=W;++i)
+            {
+                if (mask & (1u << i))
+                    stack[top++] = mNodes[child].mChild[i];
+            }
+            assert( top <= 64*W );
+        }
+        return false;
+    }
+}
+
+#endif//GEOMETRY_QUANTISED_BVH_H_INCLUDED_
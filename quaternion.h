@@ -0,0 +1,327 @@
+#ifndef GEOMETRY_QUATERNION_H_INCLUDED_
+#define GEOMETRY_QUATERNION_H_INCLUDED_
+
+#include "geometry_uninitialised.h"
+#include "base_maths.h"
+#include "vectorn.h"
+#include "vector3d.h"
+#include "matrix4.h"
+
+#include <cassert>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // rotation quaternion stored x,y,z,w, where w is the real part.
+    // follows Matrix4: vectors are rows, as for operator*(MatrixN, VectorN),
+    // so Rotate(v) is GetMatrix()*v and a*b applies a first, matching
+    // a.GetMatrix()*b.GetMatrix()
+    template<typename Scalar>
+    class Quaternion : public VectorN<Scalar, 4>
+    {
+        public:
+            typedef Quaternion<Scalar> QuaternionType;
+            typedef VectorN<Scalar,4> BaseType;
+            typedef Vector3d<Scalar> VectorType;
+
+            // identity
+            Quaternion();
+
+            //explicity uninitialised construction
+            Quaternion(const Uninitialised&);
+
+            Quaternion( Scalar x, Scalar y, Scalar z, Scalar w );
+
+            //upcast constructor
+            explicit Quaternion( const VectorN<Scalar, 4>& rhs );
+
+            // from the rotation part of a matrix
+            explicit Quaternion( const MatrixNM<Scalar, 4, 4>& m );
+
+            static Quaternion Identity();
+
+            // rotation of r radians about the unit axis
+            static Quaternion RotationAround( const VectorN<Scalar,3>& axis, Scalar r );
+
+            Scalar GetX() const;
+            Scalar GetY() const;
+            Scalar GetZ() const;
+            Scalar GetW() const;
+
+            // the inverse, for unit quaternions
+            Quaternion GetConjugate() const;
+
+            VectorType Rotate( const VectorN<Scalar,3>& v ) const;
+
+            void ComputeMatrix( Matrix4<Scalar>& result ) const;
+            Matrix4<Scalar> GetMatrix() const;
+
+            // interpolation from a (t=0) to b (t=1) along the shorter arc
+            static Quaternion Nlerp( Scalar t, const Quaternion& a, const Quaternion& b );
+            static Quaternion Slerp( Scalar t, const Quaternion& a, const Quaternion& b );
+    };
+
+    //
+    // Free-functions
+    //
+
+    // composition, the result applies lhs then rhs
+    template<typename Scalar>
+    Quaternion<Scalar> operator* ( const Quaternion<Scalar>& lhs, const Quaternion<Scalar>& rhs )
+    {
+        const Scalar ax = lhs[0], ay = lhs[1], az = lhs[2], aw = lhs[3];
+        const Scalar bx = rhs[0], by = rhs[1], bz = rhs[2], bw = rhs[3];
+        return Quaternion<Scalar>(
+            aw*bx + ax*bw + ay*bz - az*by,
+            aw*by - ax*bz + ay*bw + az*bx,
+            aw*bz + ax*by - ay*bx + az*bw,
+            aw*bw - ax*bx - ay*by - az*bz );
+    }
+
+    // batch Quaternion::Nlerp, result[i] = Nlerp( t[i], a[i], b[i] )
+    template<typename Scalar>
+    void Nlerp( const Scalar* t, const Quaternion<Scalar>* a, const Quaternion<Scalar>* b,
+        Quaternion<Scalar>* result, size_t count )
+    {
+        for (size_t i=0;i!=count;++i)
+        {
+            const Scalar d = DotProduct( a[i], b[i] );
+            const Scalar ta = 1 - t[i];
+            const Scalar tb = d < 0 ? -t[i] : t[i];
+            Scalar q[4];
+            for (size_t n=0;n!=4;++n)
+                q[n] = a[i][n]*ta + b[i][n]*tb;
+            const Scalar l = RSqrt<accuracy_precise>( q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3] );
+            for (size_t n=0;n!=4;++n)
+                result[i][n] = q[n]*l;
+        }
+    }
+
+    // batch Quaternion::Slerp, result[i] = Slerp( t[i], a[i], b[i] ).
+    // the trig comes from the given accuracy tier, the C library acos for
+    // exact and precise, ACosApprox for fast, which leaves the loop branch free
+    template<Accuracy A = accuracy_precise, typename Scalar>
+    void Slerp( const Scalar* t, const Quaternion<Scalar>* a, const Quaternion<Scalar>* b,
+        Quaternion<Scalar>* result, size_t count )
+    {
+        for (size_t i=0;i!=count;++i)
+        {
+            const Scalar dot = DotProduct( a[i], b[i] );
+            const Scalar sign = dot < 0 ? Scalar(-1) : Scalar(1);
+            const Scalar d = std::min( dot*sign, Scalar(1) );
+
+            // near parallel the weights tend to 1-t and t, use those to avoid 0/0
+            const bool linear = d > Scalar(0.9995);
+            const Scalar theta = A == accuracy_fast ? ACosApprox( d ) : ACos( d );
+            const Scalar st = linear ? Scalar(1) : Sin<A>( theta );
+            const Scalar wa = linear ? 1 - t[i] : Sin<A>( (1 - t[i]) * theta ) / st;
+            const Scalar wb = (linear ? t[i] : Sin<A>( t[i] * theta ) / st) * sign;
+
+            Scalar q[4];
+            for (size_t n=0;n!=4;++n)
+                q[n] = a[i][n]*wa + b[i][n]*wb;
+            // exact slerp keeps unit length, renormalise away the approximation drift
+            const Scalar l = RSqrt<accuracy_precise>( q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3] );
+            for (size_t n=0;n!=4;++n)
+                result[i][n] = q[n]*l;
+        }
+    }
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template<typename Scalar>
+    Quaternion<Scalar>::Quaternion()
+        : VectorN<Scalar, 4>(uninitialised)
+    {
+        (*this)[0]=0;
+        (*this)[1]=0;
+        (*this)[2]=0;
+        (*this)[3]=1;
+    }
+
+    template<typename Scalar>
+    Quaternion<Scalar>::Quaternion(const Uninitialised&)
+        : VectorN<Scalar, 4>(uninitialised)
+    {
+        // nothing to do here
+    }
+
+    template<typename Scalar>
+    Quaternion<Scalar>::Quaternion( Scalar x, Scalar y, Scalar z, Scalar w )
+        : VectorN<Scalar, 4>(uninitialised)
+    {
+        (*this)[0]=x;
+        (*this)[1]=y;
+        (*this)[2]=z;
+        (*this)[3]=w;
+    }
+
+    template<typename Scalar>
+    Quaternion<Scalar>::Quaternion( const VectorN<Scalar, 4>& rhs )
+        : VectorN<Scalar, 4>(rhs)
+    {
+        // nothing to do here
+    }
+
+    // Shepperd's method, pivots on the largest of w,x,y,z to stay well conditioned
+    template<typename Scalar>
+    Quaternion<Scalar>::Quaternion( const MatrixNM<Scalar, 4, 4>& m )
+        : VectorN<Scalar, 4>(uninitialised)
+    {
+        const Scalar trace = m[0][0] + m[1][1] + m[2][2];
+        if (trace > 0)
+        {
+            const Scalar s = Sqrt( trace + 1 ) * 2;
+            (*this)[3] = s / 4;
+            (*this)[0] = ( m[2][1] - m[1][2] ) / s;
+            (*this)[1] = ( m[0][2] - m[2][0] ) / s;
+            (*this)[2] = ( m[1][0] - m[0][1] ) / s;
+        }
+        else if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+        {
+            const Scalar s = Sqrt( 1 + m[0][0] - m[1][1] - m[2][2] ) * 2;
+            (*this)[3] = ( m[2][1] - m[1][2] ) / s;
+            (*this)[0] = s / 4;
+            (*this)[1] = ( m[0][1] + m[1][0] ) / s;
+            (*this)[2] = ( m[0][2] + m[2][0] ) / s;
+        }
+        else if (m[1][1] > m[2][2])
+        {
+            const Scalar s = Sqrt( 1 + m[1][1] - m[0][0] - m[2][2] ) * 2;
+            (*this)[3] = ( m[0][2] - m[2][0] ) / s;
+            (*this)[0] = ( m[0][1] + m[1][0] ) / s;
+            (*this)[1] = s / 4;
+            (*this)[2] = ( m[1][2] + m[2][1] ) / s;
+        }
+        else
+        {
+            const Scalar s = Sqrt( 1 + m[2][2] - m[0][0] - m[1][1] ) * 2;
+            (*this)[3] = ( m[1][0] - m[0][1] ) / s;
+            (*this)[0] = ( m[0][2] + m[2][0] ) / s;
+            (*this)[1] = ( m[1][2] + m[2][1] ) / s;
+            (*this)[2] = s / 4;
+        }
+    }
+
+    // static
+    template<typename Scalar>
+    Quaternion<Scalar> Quaternion<Scalar>::Identity()
+    {
+        return Quaternion();
+    }
+
+    // static
+    template<typename Scalar>
+    Quaternion<Scalar> Quaternion<Scalar>::RotationAround( const VectorN<Scalar,3>& axis, Scalar r )
+    {
+        Scalar s, c;
+        SinCos( r/2, &s, &c );
+        return Quaternion( axis[0]*s, axis[1]*s, axis[2]*s, c );
+    }
+
+    template<typename Scalar>
+    Scalar Quaternion<Scalar>::GetX() const
+    {
+        return this->Get(0);
+    }
+
+    template<typename Scalar>
+    Scalar Quaternion<Scalar>::GetY() const
+    {
+        return this->Get(1);
+    }
+
+    template<typename Scalar>
+    Scalar Quaternion<Scalar>::GetZ() const
+    {
+        return this->Get(2);
+    }
+
+    template<typename Scalar>
+    Scalar Quaternion<Scalar>::GetW() const
+    {
+        return this->Get(3);
+    }
+
+    template<typename Scalar>
+    Quaternion<Scalar> Quaternion<Scalar>::GetConjugate() const
+    {
+        return Quaternion( -GetX(), -GetY(), -GetZ(), GetW() );
+    }
+
+    template<typename Scalar>
+    typename Quaternion<Scalar>::VectorType Quaternion<Scalar>::Rotate( const VectorN<Scalar,3>& v ) const
+    {
+        // row vectors turn the opposite way to q v q*, so this is q* v q:
+        // v + 2w(v x q) + (v x q) x q, with u = 2(v x q)
+        const VectorType q( GetX(), GetY(), GetZ() );
+        VectorType u = CrossProduct( VectorType(v), q );
+        u *= 2;
+        VectorType result = CrossProduct( u, q );
+        result += v;
+        u *= GetW();
+        result += u;
+        return result;
+    }
+
+    template<typename Scalar>
+    void Quaternion<Scalar>::ComputeMatrix( Matrix4<Scalar>& result ) const
+    {
+        const Scalar x = GetX(), y = GetY(), z = GetZ(), w = GetW();
+        const Scalar xx = x*x, yy = y*y, zz = z*z;
+        const Scalar xy = x*y, xz = x*z, yz = y*z;
+        const Scalar wx = w*x, wy = w*y, wz = w*z;
+
+        const Scalar r[3][3] = {
+            { 1 - 2*(yy + zz),     2*(xy - wz),     2*(xz + wy) },
+            {     2*(xy + wz), 1 - 2*(xx + zz),     2*(yz - wx) },
+            {     2*(xz - wy),     2*(yz + wx), 1 - 2*(xx + yy) } };
+        SetRotation( result, r );
+    }
+
+    template<typename Scalar>
+    Matrix4<Scalar> Quaternion<Scalar>::GetMatrix() const
+    {
+        Matrix4<Scalar> result(uninitialised);
+        ComputeMatrix( result );
+        return result;
+    }
+
+    // static
+    template<typename Scalar>
+    Quaternion<Scalar> Quaternion<Scalar>::Nlerp( Scalar t, const Quaternion& a, const Quaternion& b )
+    {
+        Quaternion result(uninitialised);
+        Geometry::Nlerp( &t, &a, &b, &result, 1 );
+        return result;
+    }
+
+    // static
+    template<typename Scalar>
+    Quaternion<Scalar> Quaternion<Scalar>::Slerp( Scalar t, const Quaternion& a, const Quaternion& b )
+    {
+        const Scalar dot = DotProduct( a, b );
+        const Scalar sign = dot < 0 ? Scalar(-1) : Scalar(1);
+        const Scalar d = dot*sign;
+        if (d > Scalar(0.9995))
+            return Nlerp( t, a, b );
+
+        const Scalar theta = ACos( d );
+        const Scalar st = Sin( theta );
+        const Scalar wa = Sin( (1 - t) * theta ) / st;
+        const Scalar wb = Sin( t * theta ) / st * sign;
+
+        Quaternion result(uninitialised);
+        for (size_t n=0;n!=4;++n)
+            result[n] = a[n]*wa + b[n]*wb;
+        return result;
+    }
+}
+
+#endif//GEOMETRY_QUATERNION_H_INCLUDED_
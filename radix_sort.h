@@ -0,0 +1,156 @@
+#ifndef GEOMETRY_RADIX_SORT_H_INCLUDED_
+#define GEOMETRY_RADIX_SORT_H_INCLUDED_
+
+#include "parallel.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // the buffers RadixSort works in. a caller sorting every frame keeps one
+    // so that only its first sort allocates; the sorted keys and values may
+    // end up in storage swapped in from here
+    template< typename Value >
+    class RadixSortScratch
+    {
+        public:
+            std::vector<uint64_t> mKeys;
+            std::vector<Value> mValues;
+            std::vector<size_t> mHistograms;
+    };
+
+    //
+    // Free-functions
+    //
+
+    // sorts keys ascending, moving values[i] along with keys[i]. stable,
+    // least significant digit first, and a digit the keys all share costs
+    // one histogram and no scatter. only the low keyBits bits are sorted on,
+    // the bits above them must be zero. each pass counts per chunk, one chunk
+    // per thread of the policy, then every chunk scatters to its own
+    // precomputed offsets. a stable sort has only one answer, so the result
+    // does not depend on the policy
+    template< typename Value >
+    void RadixSort(std::vector<uint64_t>& keys, std::vector<Value>& values, RadixSortScratch<Value>& scratch,
+        const ExecutionPolicy& policy = ExecutionPolicy(), unsigned keyBits = 64)
+    {
+        assert( keys.size()==values.size() );
+        assert( keyBits>0 && keyBits<=64 );
+        const size_t count = keys.size();
+        if (count<2)
+            return;
+
+        // eleven bits a pass, six passes cover 64 bit keys, and the
+        // histogram of a chunk still sits in L1
+        const unsigned digitBits = 11;
+        const size_t buckets = size_t(1) << digitBits;
+        // the offsets are prefix summed serially over chunks*buckets counters,
+        // so the chunk count follows the threads rather than the key count.
+        // chunks much smaller than minimumGrain spend more on their
+        // histograms than on their keys
+        const size_t minimumGrain = size_t(1) << 14;
+        const size_t threads = policy.IsParallel() ? policy.GetPool()->GetThreadCount() + 1 : 1;
+        const size_t wanted = std::max( size_t(1), std::min( threads, count / minimumGrain ) );
+        const ExecutionPolicy chunked = policy.WithGrain( (count + wanted - 1) / wanted );
+        const size_t grain = chunked.GetGrain();
+        const size_t chunks = (count + grain - 1) / grain;
+
+        std::vector<uint64_t>& keysOut = scratch.mKeys;
+        std::vector<Value>& valuesOut = scratch.mValues;
+        std::vector<size_t>& histograms = scratch.mHistograms;
+        keysOut.resize( count );
+        valuesOut.resize( count, values[0] );
+        histograms.resize( chunks*buckets );
+
+        for (unsigned shift=0;shift<keyBits;shift+=digitBits)
+        {
+            // raw pointers, so the stores below cannot be taken to alias them
+            const uint64_t* in = keys.data();
+            const Value* valuesIn = values.data();
+            uint64_t* out = keysOut.data();
+            Value* valuesOutData = valuesOut.data();
+            size_t* counts = histograms.data();
+
+            std::fill( histograms.begin(), histograms.end(), size_t(0) );
+            ParallelForChunks( chunked, 0, count, [=](size_t chunk, size_t begin, size_t end) {
+                size_t* histogram = counts + chunk*buckets;
+                for (size_t i=begin;i!=end;++i)
+                    ++histogram[(in[i] >> shift) & (buckets-1)];
+            } );
+
+            // bucket major, chunk minor, so equal digits keep their order
+            size_t offset = 0;
+            bool uniform = false;
+            for (size_t digit=0;digit!=buckets;++digit)
+            {
+                const size_t start = offset;
+                for (size_t chunk=0;chunk!=chunks;++chunk)
+                {
+                    size_t& h = counts[chunk*buckets+digit];
+                    const size_t n = h;
+                    h = offset;
+                    offset += n;
+                }
+                uniform |= offset-start==count;
+            }
+            if (uniform)
+                continue;
+
+            ParallelForChunks( chunked, 0, count, [=](size_t chunk, size_t begin, size_t end) {
+                size_t* next = counts + chunk*buckets;
+                for (size_t i=begin;i!=end;++i)
+                {
+                    const uint64_t key = in[i];
+                    const size_t to = next[(key >> shift) & (buckets-1)]++;
+                    out[to] = key;
+                    valuesOutData[to] = valuesIn[i];
+                }
+            } );
+            keys.swap( keysOut );
+            values.swap( valuesOut );
+        }
+    }
+
+    template< typename Value >
+    void RadixSort(std::vector<uint64_t>& keys, std::vector<Value>& values,
+        const ExecutionPolicy& policy = ExecutionPolicy(), unsigned keyBits = 64)
+    {
+        RadixSortScratch<Value> scratch;
+        RadixSort( keys, values, scratch, policy, keyBits );
+    }
+
+    // order[i] is the index of the i-th smallest key, keys left as they are
+    inline void ComputeSortOrder(const std::vector<uint64_t>& keys, std::vector<uint32_t>& order,
+        const ExecutionPolicy& policy = ExecutionPolicy())
+    {
+        assert( keys.size() <= size_t(UINT32_MAX) );
+        std::vector<uint64_t> sorted( keys );
+        order.resize( keys.size() );
+        std::iota( order.begin(), order.end(), uint32_t(0) );
+        RadixSort( sorted, order, policy );
+    }
+
+    // data[i] = data[order[i]], for each of a set of arrays sorted by one order
+    template< typename T >
+    void ApplyOrder(const std::vector<uint32_t>& order, std::vector<T>& data,
+        const ExecutionPolicy& policy = ExecutionPolicy())
+    {
+        assert( order.size()==data.size() );
+        std::vector<T> result( data );
+        ParallelFor( policy, 0, order.size(), [&](size_t first, size_t last) {
+            for (size_t i=first;i!=last;++i)
+                result[i] = data[order[i]];
+        } );
+        data.swap( result );
+    }
+}
+
+#endif//GEOMETRY_RADIX_SORT_H_INCLUDED_
@@ -0,0 +1,395 @@
+#ifndef GEOMETRY_RAY3D_H_INCLUDED_
+#define GEOMETRY_RAY3D_H_INCLUDED_
+
+#include "vector3d.h"
+#include "triangle3d.h"
+#include "aabb3d.h"
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    template <typename Scalar>
+    class Ray3d
+    {
+        public:
+            typedef Vector3d<Scalar> VectorType;
+            typedef Scalar ScalarType;
+
+            // direction does not need to be unit length,
+            // distances are then measured in multiples of it
+            Ray3d(const VectorType& origin, const VectorType& direction);
+
+            const VectorType& GetOrigin() const;
+            const VectorType& GetDirection() const;
+            const VectorType& GetInverseDirection() const;
+
+            // the point at distance t along the ray
+            VectorType GetPoint(Scalar t) const;
+
+            // Woop, Benthin and Wald's watertight test, "Watertight
+            // Ray/Triangle Intersection", 2013: the vertices are sheared so
+            // the ray runs down z, and each edge decided from the same
+            // rounded values whichever triangle it belongs to. a ray through
+            // a shared edge or vertex hits at least one of the triangles
+            // sharing it. on a hit in (0,*t) writes the distance and
+            // barycentrics
+            bool Intersection(const Triangle3d<Scalar>& tri, Scalar* t, Scalar* u=nullptr, Scalar* v=nullptr) const;
+
+            // slab test, true if the ray enters the box before tMax
+            bool Intersects(const AxisAlignedBoundingBox3d<Scalar>& box, Scalar tMax) const;
+
+            // as above, also returning the entry distance
+            bool Intersection(const AxisAlignedBoundingBox3d<Scalar>& box, Scalar tMax, Scalar* tEntry) const;
+
+            // the watertight test's frame: axis 2 is the largest component
+            // of the direction, axes 0 and 1 follow it keeping the winding,
+            // and the shear takes the direction to (0,0,1)
+            size_t GetShearAxis(size_t i) const;
+            Scalar GetShear(size_t i) const;
+
+        private:
+            VectorType mOrigin;
+            VectorType mDirection;
+            VectorType mInverseDirection;
+            size_t mShearAxis[3];
+            Scalar mShear[3];
+    };
+
+    // the result of a ray query against many triangles
+    template <typename Scalar>
+    class RayHit
+    {
+        public:
+            RayHit()
+                : mDistance( std::numeric_limits<Scalar>::max() )
+                , mU(0), mV(0)
+                , mTriangle( sNone )
+            { }
+
+            static constexpr uint32_t sNone = 0xffffffff;
+
+            Scalar mDistance;
+            Scalar mU, mV;
+            uint32_t mTriangle;
+    };
+
+    // W triangles stored structure-of-arrays, tested against one ray per call
+    // with the same watertight test as Ray3d. the per-lane loop has no
+    // branches so the compiler can vectorise it; unused lanes hold
+    // degenerate triangles that never report a hit
+    template <typename Scalar, size_t W = 4>
+    class TriangleBlock
+    {
+        public:
+            const static size_t sWidth = W;
+
+            TriangleBlock();
+
+            size_t GetSize() const;
+            uint32_t GetId(size_t lane) const;
+
+            // appends a triangle, the id is reported back from Intersection
+            void Add(const Triangle3d<Scalar>& tri, uint32_t id);
+
+            // nearest hit closer than hit->mDistance, updates hit and returns true
+            bool Intersection(const Ray3d<Scalar>& ray, RayHit<Scalar>* hit) const;
+
+            // true if any triangle is hit closer than tMax
+            bool Intersects(const Ray3d<Scalar>& ray, Scalar tMax) const;
+
+        private:
+            // t is NaN for the lanes missed
+            void Intersect(const Ray3d<Scalar>& ray, Scalar t[W], Scalar u[W], Scalar v[W]) const;
+
+            Scalar mA[3][W];
+            Scalar mB[3][W];
+            Scalar mC[3][W];
+            uint32_t mId[W];
+            size_t mCount;
+    };
+
+    //
+    // Free-functions
+    //
+
+    // twice the signed areas the ray makes with edges bc, ca and ab of a
+    // triangle, from its vertices sheared into the ray's frame. an edge
+    // product that rounds to zero is redone in double, as the paper does,
+    // so the ray is not taken to pass exactly along an edge it misses
+    template <typename Scalar>
+    inline void ComputeShearedEdges(Scalar ax, Scalar ay, Scalar bx, Scalar by, Scalar cx, Scalar cy, Scalar edges[3])
+    {
+        edges[0] = cx*by - cy*bx;
+        edges[1] = ax*cy - ay*cx;
+        edges[2] = bx*ay - by*ax;
+        if (sizeof( Scalar ) < sizeof( double ) && (edges[0]==0 || edges[1]==0 || edges[2]==0))
+        {
+            edges[0] = Scalar( double( cx )*double( by ) - double( cy )*double( bx ) );
+            edges[1] = Scalar( double( ax )*double( cy ) - double( ay )*double( cx ) );
+            edges[2] = Scalar( double( bx )*double( ay ) - double( by )*double( ax ) );
+        }
+    }
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template <typename Scalar>
+    Ray3d<Scalar>::Ray3d(const VectorType& origin, const VectorType& direction)
+        : mOrigin(origin)
+        , mDirection(direction)
+        , mInverseDirection(1/direction.GetX(), 1/direction.GetY(), 1/direction.GetZ())
+    {
+        size_t kz = 0;
+        for (size_t d=1;d!=3;++d)
+        {
+            if (Fabs( direction[d] ) > Fabs( direction[kz] ))
+                kz = d;
+        }
+        size_t kx = (kz+1)%3;
+        size_t ky = (kx+1)%3;
+        if (direction[kz] < 0)
+            std::swap( kx, ky );
+        mShearAxis[0] = kx;
+        mShearAxis[1] = ky;
+        mShearAxis[2] = kz;
+        mShear[0] = direction[kx] / direction[kz];
+        mShear[1] = direction[ky] / direction[kz];
+        mShear[2] = 1 / direction[kz];
+    }
+
+    template <typename Scalar>
+    const typename Ray3d<Scalar>::VectorType& Ray3d<Scalar>::GetOrigin() const
+    {
+        return mOrigin;
+    }
+
+    template <typename Scalar>
+    const typename Ray3d<Scalar>::VectorType& Ray3d<Scalar>::GetDirection() const
+    {
+        return mDirection;
+    }
+
+    template <typename Scalar>
+    const typename Ray3d<Scalar>::VectorType& Ray3d<Scalar>::GetInverseDirection() const
+    {
+        return mInverseDirection;
+    }
+
+    template <typename Scalar>
+    typename Ray3d<Scalar>::VectorType Ray3d<Scalar>::GetPoint(Scalar t) const
+    {
+        VectorType result(mDirection);
+        result *= t;
+        result += mOrigin;
+        return result;
+    }
+
+    template <typename Scalar>
+    bool Ray3d<Scalar>::Intersection(const Triangle3d<Scalar>& tri, Scalar* t, Scalar* u, Scalar* v) const
+    {
+        assert( t );
+        const size_t kx = mShearAxis[0], ky = mShearAxis[1], kz = mShearAxis[2];
+        const VectorType a( tri.GetA() - mOrigin );
+        const VectorType b( tri.GetB() - mOrigin );
+        const VectorType c( tri.GetC() - mOrigin );
+        Scalar edges[3];
+        ComputeShearedEdges(
+            a[kx] - mShear[0]*a[kz], a[ky] - mShear[1]*a[kz],
+            b[kx] - mShear[0]*b[kz], b[ky] - mShear[1]*b[kz],
+            c[kx] - mShear[0]*c[kz], c[ky] - mShear[1]*c[kz], edges );
+
+        // inside when no edge disagrees with another, on an edge counting
+        if ((edges[0] < 0 || edges[1] < 0 || edges[2] < 0) && (edges[0] > 0 || edges[1] > 0 || edges[2] > 0))
+            return false;
+        const Scalar det = edges[0] + edges[1] + edges[2];
+        if (det == 0) return false; // parallel or degenerate
+
+        const Scalar invDet = 1 / det;
+        const Scalar ht = (edges[0]*a[kz] + edges[1]*b[kz] + edges[2]*c[kz]) * mShear[2] * invDet;
+        if (!(ht > 0 && ht < *t)) return false;
+
+        *t = ht;
+        if (u) *u = edges[1] * invDet;
+        if (v) *v = edges[2] * invDet;
+        return true;
+    }
+
+    template <typename Scalar>
+    bool Ray3d<Scalar>::Intersects(const AxisAlignedBoundingBox3d<Scalar>& box, Scalar tMax) const
+    {
+        Scalar tEntry;
+        return Intersection( box, tMax, &tEntry );
+    }
+
+    template <typename Scalar>
+    bool Ray3d<Scalar>::Intersection(const AxisAlignedBoundingBox3d<Scalar>& box, Scalar tMax, Scalar* tEntry) const
+    {
+        Scalar tNear = 0;
+        Scalar tFar = tMax;
+        for (size_t d=0;d!=3;++d)
+        {
+            Scalar t0 = (box.GetMinBound()[d] - mOrigin[d]) * mInverseDirection[d];
+            Scalar t1 = (box.GetMaxBound()[d] - mOrigin[d]) * mInverseDirection[d];
+            if (t0 > t1) std::swap(t0, t1);
+            // written so a NaN (origin on a slab plane of a flat axis) leaves the interval alone
+            tNear = t0 > tNear ? t0 : tNear;
+            tFar = t1 < tFar ? t1 : tFar;
+        }
+        *tEntry = tNear;
+        return tNear <= tFar;
+    }
+
+    template <typename Scalar>
+    size_t Ray3d<Scalar>::GetShearAxis(size_t i) const
+    {
+        assert( i<3 );
+        return mShearAxis[i];
+    }
+
+    template <typename Scalar>
+    Scalar Ray3d<Scalar>::GetShear(size_t i) const
+    {
+        assert( i<3 );
+        return mShear[i];
+    }
+
+    template <typename Scalar, size_t W>
+    TriangleBlock<Scalar, W>::TriangleBlock()
+        : mCount(0)
+    {
+        for (size_t d=0;d!=3;++d)
+        {
+            std::fill( mA[d], mA[d]+W, Scalar(0) );
+            std::fill( mB[d], mB[d]+W, Scalar(0) );
+            std::fill( mC[d], mC[d]+W, Scalar(0) );
+        }
+        std::fill( mId, mId+W, RayHit<Scalar>::sNone );
+    }
+
+    template <typename Scalar, size_t W>
+    size_t TriangleBlock<Scalar, W>::GetSize() const
+    {
+        return mCount;
+    }
+
+    template <typename Scalar, size_t W>
+    uint32_t TriangleBlock<Scalar, W>::GetId(size_t lane) const
+    {
+        assert( lane<mCount );
+        return mId[lane];
+    }
+
+    template <typename Scalar, size_t W>
+    void TriangleBlock<Scalar, W>::Add(const Triangle3d<Scalar>& tri, uint32_t id)
+    {
+        assert( mCount<W );
+        for (size_t d=0;d!=3;++d)
+        {
+            mA[d][mCount] = tri.GetA()[d];
+            mB[d][mCount] = tri.GetB()[d];
+            mC[d][mCount] = tri.GetC()[d];
+        }
+        mId[mCount++] = id;
+    }
+
+    template <typename Scalar, size_t W>
+    void TriangleBlock<Scalar, W>::Intersect(const Ray3d<Scalar>& ray, Scalar t[W], Scalar u[W], Scalar v[W]) const
+    {
+        const size_t kx = ray.GetShearAxis(0), ky = ray.GetShearAxis(1), kz = ray.GetShearAxis(2);
+        const Scalar ox = ray.GetOrigin()[kx], oy = ray.GetOrigin()[ky], oz = ray.GetOrigin()[kz];
+        const Scalar sx = ray.GetShear(0), sy = ray.GetShear(1), sz = ray.GetShear(2);
+        const Scalar nan = std::numeric_limits<Scalar>::quiet_NaN();
+
+        // the sheared vertices and edge functions, as in Ray3d::Intersection
+        Scalar ax[W], ay[W], bx[W], by[W], cx[W], cy[W], e0[W], e1[W], e2[W];
+        bool zero = false;
+        for (size_t i=0;i!=W;++i)
+        {
+            const Scalar az = mA[kz][i] - oz, bz = mB[kz][i] - oz, cz = mC[kz][i] - oz;
+            ax[i] = (mA[kx][i] - ox) - sx*az;
+            ay[i] = (mA[ky][i] - oy) - sy*az;
+            bx[i] = (mB[kx][i] - ox) - sx*bz;
+            by[i] = (mB[ky][i] - oy) - sy*bz;
+            cx[i] = (mC[kx][i] - ox) - sx*cz;
+            cy[i] = (mC[ky][i] - oy) - sy*cz;
+            e0[i] = cx[i]*by[i] - cy[i]*bx[i];
+            e1[i] = ax[i]*cy[i] - ay[i]*cx[i];
+            e2[i] = bx[i]*ay[i] - by[i]*ax[i];
+            // padding lanes are all zero and would always ask for the fallback
+            zero |= (i<mCount) & ((e0[i]==0) | (e1[i]==0) | (e2[i]==0));
+        }
+        // rare, a ray along an edge in float
+        if (zero && sizeof( Scalar ) < sizeof( double ))
+        {
+            for (size_t i=0;i!=mCount;++i)
+            {
+                Scalar edges[3];
+                ComputeShearedEdges( ax[i], ay[i], bx[i], by[i], cx[i], cy[i], edges );
+                e0[i] = edges[0]; e1[i] = edges[1]; e2[i] = edges[2];
+            }
+        }
+
+        for (size_t i=0;i!=W;++i)
+        {
+            const Scalar az = mA[kz][i] - oz, bz = mB[kz][i] - oz, cz = mC[kz][i] - oz;
+            const bool negative = (e0[i] < 0) | (e1[i] < 0) | (e2[i] < 0);
+            const bool positive = (e0[i] > 0) | (e1[i] > 0) | (e2[i] > 0);
+            const Scalar det = e0[i] + e1[i] + e2[i];
+            const Scalar invDet = (det != 0) & !(negative & positive) ? 1 / det : nan;
+            u[i] = e1[i] * invDet;
+            v[i] = e2[i] * invDet;
+            t[i] = (e0[i]*az + e1[i]*bz + e2[i]*cz) * sz * invDet;
+        }
+    }
+
+    template <typename Scalar, size_t W>
+    bool TriangleBlock<Scalar, W>::Intersection(const Ray3d<Scalar>& ray, RayHit<Scalar>* hit) const
+    {
+        Scalar t[W], u[W], v[W];
+        Intersect( ray, t, u, v );
+
+        // NaN lanes (missed / degenerate / padding) fail every comparison
+        size_t best = W;
+        for (size_t i=0;i!=mCount;++i)
+        {
+            if (t[i] > 0 && t[i] < hit->mDistance)
+            {
+                hit->mDistance = t[i];
+                best = i;
+            }
+        }
+        if (best == W) return false;
+
+        hit->mU = u[best];
+        hit->mV = v[best];
+        hit->mTriangle = mId[best];
+        return true;
+    }
+
+    template <typename Scalar, size_t W>
+    bool TriangleBlock<Scalar, W>::Intersects(const Ray3d<Scalar>& ray, Scalar tMax) const
+    {
+        Scalar t[W], u[W], v[W];
+        Intersect( ray, t, u, v );
+
+        bool result = false;
+        for (size_t i=0;i!=mCount;++i)
+        {
+            result |= (t[i] > 0 && t[i] < tMax);
+        }
+        return result;
+    }
+}
+
+#endif//GEOMETRY_RAY3D_H_INCLUDED_
@@ -0,0 +1,300 @@
+#ifndef GEOMETRY_SPACE_FILLING_CURVE_H_INCLUDED_
+#define GEOMETRY_SPACE_FILLING_CURVE_H_INCLUDED_
+
+#include "aabb.h"
+#include "parallel.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // places points of a box on the grid the curves run over: 2^32 cells a
+    // side in 2D and 2^21 in 3D, so either key fits 64 bits. integer points
+    // in a box at most that many wide keep a cell each. points outside the
+    // box are clamped onto its faces
+    template< typename AABB >
+    class CurveGrid
+    {
+    public:
+        typedef typename AABB::VectorBase VectorBase;
+        typedef typename VectorBase::ScalarType ScalarType;
+
+        const static size_t sDimensions = VectorBase::sDimensions;
+        const static unsigned sBits = sDimensions==2 ? 32 : 21;
+
+        explicit CurveGrid(const AABB& bounds);
+
+        void ComputeCell(const VectorBase& p, uint32_t cell[]) const;
+
+        uint64_t GetMortonKey(const VectorBase& p) const;
+        uint64_t GetHilbertKey(const VectorBase& p) const;
+
+    private:
+        static_assert( sDimensions==2 || sDimensions==3, "curves are 2D or 3D" );
+
+        double mMin[sDimensions];
+        double mScale[sDimensions];
+    };
+
+    //
+    // Free-functions
+    //
+
+    // spreads the low 32 bits of v to the even bits of the result
+    inline uint64_t MortonSpread2(uint64_t v)
+    {
+        v &= 0xffffffff;
+        v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+        v = (v | (v << 8))  & 0x00ff00ff00ff00ffull;
+        v = (v | (v << 4))  & 0x0f0f0f0f0f0f0f0full;
+        v = (v | (v << 2))  & 0x3333333333333333ull;
+        v = (v | (v << 1))  & 0x5555555555555555ull;
+        return v;
+    }
+
+    inline uint32_t MortonCompact2(uint64_t v)
+    {
+        v &= 0x5555555555555555ull;
+        v = (v | (v >> 1))  & 0x3333333333333333ull;
+        v = (v | (v >> 2))  & 0x0f0f0f0f0f0f0f0full;
+        v = (v | (v >> 4))  & 0x00ff00ff00ff00ffull;
+        v = (v | (v >> 8))  & 0x0000ffff0000ffffull;
+        v = (v | (v >> 16)) & 0x00000000ffffffffull;
+        return uint32_t(v);
+    }
+
+    // spreads the low 21 bits of v to every third bit of the result
+    inline uint64_t MortonSpread3(uint64_t v)
+    {
+        v &= 0x1fffff;
+        v = (v | (v << 32)) & 0x001f00000000ffffull;
+        v = (v | (v << 16)) & 0x001f0000ff0000ffull;
+        v = (v | (v << 8))  & 0x100f00f00f00f00full;
+        v = (v | (v << 4))  & 0x10c30c30c30c30c3ull;
+        v = (v | (v << 2))  & 0x1249249249249249ull;
+        return v;
+    }
+
+    inline uint32_t MortonCompact3(uint64_t v)
+    {
+        v &= 0x1249249249249249ull;
+        v = (v | (v >> 2))  & 0x10c30c30c30c30c3ull;
+        v = (v | (v >> 4))  & 0x100f00f00f00f00full;
+        v = (v | (v >> 8))  & 0x001f0000ff0000ffull;
+        v = (v | (v >> 16)) & 0x001f00000000ffffull;
+        v = (v | (v >> 32)) & 0x00000000001fffffull;
+        return uint32_t(v);
+    }
+
+    // x in the lowest bit of each pair
+    inline uint64_t MortonEncode(uint32_t x, uint32_t y)
+    {
+        return MortonSpread2( x ) | (MortonSpread2( y ) << 1);
+    }
+
+    // 21 bits of each, x in the lowest bit of each triple
+    inline uint64_t MortonEncode(uint32_t x, uint32_t y, uint32_t z)
+    {
+        return MortonSpread3( x ) | (MortonSpread3( y ) << 1) | (MortonSpread3( z ) << 2);
+    }
+
+    inline void MortonDecode(uint64_t key, uint32_t& x, uint32_t& y)
+    {
+        x = MortonCompact2( key );
+        y = MortonCompact2( key >> 1 );
+    }
+
+    inline void MortonDecode(uint64_t key, uint32_t& x, uint32_t& y, uint32_t& z)
+    {
+        x = MortonCompact3( key );
+        y = MortonCompact3( key >> 1 );
+        z = MortonCompact3( key >> 2 );
+    }
+
+    // Skilling's in place transform ("Programming the Hilbert curve", 2004)
+    // from D coordinates of bits bits to the transposed Hilbert index, which
+    // read interleaved with axis 0 most significant is the distance along
+    // the curve. consecutive distances are neighbouring cells
+    template< size_t D >
+    void HilbertAxesToTranspose(uint32_t x[], unsigned bits)
+    {
+        const uint32_t m = uint32_t(1) << (bits-1);
+        for (uint32_t q=m;q>1;q>>=1)
+        {
+            const uint32_t p = q-1;
+            for (size_t i=0;i!=D;++i)
+            {
+                if (x[i] & q)
+                {
+                    x[0] ^= p;
+                }
+                else
+                {
+                    const uint32_t t = (x[0] ^ x[i]) & p;
+                    x[0] ^= t;
+                    x[i] ^= t;
+                }
+            }
+        }
+
+        // gray encode
+        for (size_t i=1;i!=D;++i)
+            x[i] ^= x[i-1];
+        uint32_t t = 0;
+        for (uint32_t q=m;q>1;q>>=1)
+        {
+            if (x[D-1] & q)
+                t ^= q-1;
+        }
+        for (size_t i=0;i!=D;++i)
+            x[i] ^= t;
+    }
+
+    template< size_t D >
+    void HilbertTransposeToAxes(uint32_t x[], unsigned bits)
+    {
+        const uint64_t n = uint64_t(2) << (bits-1);
+
+        // gray decode
+        uint32_t t = x[D-1] >> 1;
+        for (size_t i=D-1;i!=0;--i)
+            x[i] ^= x[i-1];
+        x[0] ^= t;
+
+        for (uint64_t q=2;q!=n;q<<=1)
+        {
+            const uint32_t p = uint32_t(q-1);
+            for (size_t i=D;i--!=0;)
+            {
+                if (x[i] & q)
+                {
+                    x[0] ^= p;
+                }
+                else
+                {
+                    t = (x[0] ^ x[i]) & p;
+                    x[0] ^= t;
+                    x[i] ^= t;
+                }
+            }
+        }
+    }
+
+    inline uint64_t HilbertEncode(uint32_t x, uint32_t y)
+    {
+        uint32_t axes[2] = { x, y };
+        HilbertAxesToTranspose<2>( axes, 32 );
+        return MortonEncode( axes[1], axes[0] );
+    }
+
+    inline uint64_t HilbertEncode(uint32_t x, uint32_t y, uint32_t z)
+    {
+        uint32_t axes[3] = { x & 0x1fffff, y & 0x1fffff, z & 0x1fffff };
+        HilbertAxesToTranspose<3>( axes, 21 );
+        return MortonEncode( axes[2], axes[1], axes[0] );
+    }
+
+    inline void HilbertDecode(uint64_t key, uint32_t& x, uint32_t& y)
+    {
+        uint32_t axes[2];
+        MortonDecode( key, axes[1], axes[0] );
+        HilbertTransposeToAxes<2>( axes, 32 );
+        x = axes[0];
+        y = axes[1];
+    }
+
+    inline void HilbertDecode(uint64_t key, uint32_t& x, uint32_t& y, uint32_t& z)
+    {
+        uint32_t axes[3];
+        MortonDecode( key, axes[2], axes[1], axes[0] );
+        HilbertTransposeToAxes<3>( axes, 21 );
+        x = axes[0];
+        y = axes[1];
+        z = axes[2];
+    }
+
+    // keys[i] for each point of [first,last), keys sized to match
+    template< typename AABB, typename iterator >
+    void ComputeMortonKeys(const AABB& bounds, iterator first, iterator last, std::vector<uint64_t>& keys,
+        const ExecutionPolicy& policy = ExecutionPolicy())
+    {
+        const CurveGrid<AABB> grid( bounds );
+        keys.resize( size_t(last - first) );
+        ParallelFor( policy, 0, keys.size(), [&](size_t begin, size_t end) {
+            for (size_t i=begin;i!=end;++i)
+                keys[i] = grid.GetMortonKey( first[i] );
+        } );
+    }
+
+    template< typename AABB, typename iterator >
+    void ComputeHilbertKeys(const AABB& bounds, iterator first, iterator last, std::vector<uint64_t>& keys,
+        const ExecutionPolicy& policy = ExecutionPolicy())
+    {
+        const CurveGrid<AABB> grid( bounds );
+        keys.resize( size_t(last - first) );
+        ParallelFor( policy, 0, keys.size(), [&](size_t begin, size_t end) {
+            for (size_t i=begin;i!=end;++i)
+                keys[i] = grid.GetHilbertKey( first[i] );
+        } );
+    }
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template< typename AABB >
+    CurveGrid<AABB>::CurveGrid(const AABB& bounds)
+    {
+        const double cells = double( uint64_t(1) << sBits );
+        for (size_t d=0;d!=sDimensions;++d)
+        {
+            const double lo = double( bounds.GetMinBound()[d] );
+            const double extent = double( bounds.GetMaxBound()[d] ) - lo;
+            mMin[d] = lo;
+            mScale[d] = extent > 0 ? cells / extent : 0;
+        }
+    }
+
+    template< typename AABB >
+    void CurveGrid<AABB>::ComputeCell(const VectorBase& p, uint32_t cell[]) const
+    {
+        const double top = double( (uint64_t(1) << sBits) - 1 );
+        for (size_t d=0;d!=sDimensions;++d)
+        {
+            const double c = (double( p[d] ) - mMin[d]) * mScale[d];
+            // written so nan lands in cell 0
+            cell[d] = uint32_t( !(c > 0) ? 0 : c < top ? c : top );
+        }
+    }
+
+    template< typename AABB >
+    uint64_t CurveGrid<AABB>::GetMortonKey(const VectorBase& p) const
+    {
+        uint32_t c[sDimensions];
+        ComputeCell( p, c );
+        if constexpr (sDimensions==2)
+            return MortonEncode( c[0], c[1] );
+        else
+            return MortonEncode( c[0], c[1], c[2] );
+    }
+
+    template< typename AABB >
+    uint64_t CurveGrid<AABB>::GetHilbertKey(const VectorBase& p) const
+    {
+        uint32_t c[sDimensions];
+        ComputeCell( p, c );
+        if constexpr (sDimensions==2)
+            return HilbertEncode( c[0], c[1] );
+        else
+            return HilbertEncode( c[0], c[1], c[2] );
+    }
+}
+
+#endif//GEOMETRY_SPACE_FILLING_CURVE_H_INCLUDED_
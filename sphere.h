@@ -0,0 +1,521 @@
+#ifndef GEOMETRY_SPHERE_H_INCLUDED_
+#define GEOMETRY_SPHERE_H_INCLUDED_
+
+#include "vectorn.h"
+#include "aabb.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // the closed ball within mRadius of mCenter, in any dimension. a circle
+    // in 2D
+    template<typename T>
+    class Sphere
+    {
+        public:
+            typedef T VectorType;
+            typedef typename VectorType::BaseType VectorBase;
+            typedef typename VectorBase::ScalarType ScalarType;
+            typedef AxisAlignedBoundingBox<T> BoundsType;
+            const static size_t sDimensions = VectorBase::sDimensions;
+            static_assert( std::is_floating_point<ScalarType>::value, "spheres need a floating point type" );
+
+            Sphere( const Uninitialised& )
+                : mCenter(uninitialised), mRadius()
+            { }
+
+            Sphere(const VectorBase& center, ScalarType radius);
+            // a single point
+            explicit Sphere(const VectorBase& p);
+            // through the corners of box, as GetCircumradius
+            explicit Sphere(const BoundsType& box);
+
+            const VectorType& GetCenter() const;
+            ScalarType GetRadius() const;
+
+            bool Contains(const VectorBase& p) const;
+            bool Contains(const Sphere& rhs) const;
+            // touching counts
+            bool Overlaps(const Sphere& rhs) const;
+            bool Overlaps(const BoundsType& box) const;
+
+            // grows, moving the center towards p, just enough to hold both
+            // the sphere as was and p, as Ritter's second pass does
+            void ExpandToContain(const VectorBase& p);
+
+        private:
+            VectorType mCenter;
+            ScalarType mRadius;
+    };
+
+    // spheres structure-of-arrays: one contiguous array per center axis and
+    // one of radii, so the batch overlap tests read straight lines of scalars
+    template<typename T>
+    class SphereArray
+    {
+        public:
+            typedef Sphere<T> SphereType;
+            typedef typename SphereType::ScalarType ScalarType;
+            const static size_t sDimensions = SphereType::sDimensions;
+
+            SphereArray();
+
+            size_t GetSize() const;
+            void Reserve(size_t count);
+
+            void Add(const SphereType& s);
+            SphereType Get(size_t i) const;
+
+            const ScalarType* GetCenters(size_t axis) const;
+            const ScalarType* GetRadii() const;
+
+        private:
+            std::vector<ScalarType> mData[sDimensions+1];
+    };
+
+    //
+    // Free-functions
+    //
+
+    // the radius about center holding every point of [first,last), from
+    // distances in double, then grown until Sphere::Contains agrees for
+    // each point with its own Scalar arithmetic
+    template<typename VectorBase, typename iterator>
+    typename VectorBase::ScalarType GetEnclosingRadius(iterator first, iterator last, const VectorBase& center)
+    {
+        typedef typename VectorBase::ScalarType Scalar;
+        static_assert( std::is_floating_point<Scalar>::value, "spheres need a floating point type" );
+        double radiusSquare = 0;
+        for (iterator i=first;i!=last;++i)
+        {
+            const VectorBase& p = *i;
+            double distance = 0;
+            for (size_t d=0;d!=VectorBase::sDimensions;++d)
+            {
+                const double e = double( p[d] ) - double( center[d] );
+                distance += e*e;
+            }
+            radiusSquare = std::max( radiusSquare, distance );
+        }
+        Scalar radius = Scalar( std::sqrt( radiusSquare ) );
+        for (iterator i=first;i!=last;++i)
+        {
+            const VectorBase& p = *i;
+            const VectorBase d( p - center );
+            const Scalar distanceSquare = d.LengthSquare();
+            while (distanceSquare > radius*radius)
+                radius = std::nextafter( radius, std::numeric_limits<Scalar>::max() );
+        }
+        return radius;
+    }
+
+    // the smallest sphere through the count points, which must be affinely
+    // independent so at most sDimensions+1 of them. its center lies in
+    // their affine hull. false when they are too close to dependent
+    template<typename T>
+    bool ComputeCircumsphere(const T* points, size_t count, Sphere<T>& result)
+    {
+        typedef typename Sphere<T>::VectorBase VectorBase;
+        typedef typename Sphere<T>::ScalarType Scalar;
+        const size_t D = VectorBase::sDimensions;
+        assert( count>0 && count<=D+1 );
+
+        // center p0 + sum l_j v_j for v_j = p_j - p0, equidistant from all:
+        // 2 sum_j l_j v_i.v_j = v_i.v_i, solved in double with pivoting
+        const size_t n = count-1;
+        double g[D][D+1];
+        double scale = 0;
+        for (size_t i=0;i!=n;++i)
+        {
+            for (size_t j=0;j!=n;++j)
+            {
+                double dot = 0;
+                for (size_t d=0;d!=D;++d)
+                    dot += (double( points[i+1][d] ) - double( points[0][d] ))
+                        * (double( points[j+1][d] ) - double( points[0][d] ));
+                g[i][j] = 2*dot;
+            }
+            g[i][n] = g[i][i]/2;
+            scale = std::max( scale, g[i][i] );
+        }
+        for (size_t c=0;c!=n;++c)
+        {
+            size_t pivot = c;
+            for (size_t r=c+1;r!=n;++r)
+                if (std::fabs( g[r][c] ) > std::fabs( g[pivot][c] ))
+                    pivot = r;
+            if (!(std::fabs( g[pivot][c] ) > 1e-12*scale))
+                return false;
+            for (size_t k=0;k!=n+1;++k)
+                std::swap( g[c][k], g[pivot][k] );
+            for (size_t r=0;r!=n;++r)
+            {
+                if (r==c)
+                    continue;
+                const double f = g[r][c]/g[c][c];
+                for (size_t k=c;k!=n+1;++k)
+                    g[r][k] -= f*g[c][k];
+            }
+        }
+
+        double center[D];
+        for (size_t d=0;d!=D;++d)
+        {
+            center[d] = double( points[0][d] );
+            for (size_t j=0;j!=n;++j)
+                center[d] += g[j][n]/g[j][j] * (double( points[j+1][d] ) - double( points[0][d] ));
+        }
+        VectorBase c( uninitialised );
+        for (size_t d=0;d!=D;++d)
+            c[d] = Scalar( center[d] );
+        result = Sphere<T>( c, GetEnclosingRadius( points, points+count, c ) );
+        return true;
+    }
+
+    // Ritter's bounding sphere: the widest of the pairs of points extreme
+    // along an axis as a diameter, then grown through every point in one
+    // more pass. a last pass shrinks the radius to the farthest point from
+    // the final center. linear and no more than about a fifth too large
+    template<typename T, typename iterator>
+    void ComputeRitterSphere(iterator first, iterator last, Sphere<T>& result)
+    {
+        typedef typename Sphere<T>::VectorBase VectorBase;
+        typedef typename Sphere<T>::ScalarType Scalar;
+        const size_t D = VectorBase::sDimensions;
+        assert( first!=last );
+
+        iterator lo[D], hi[D];
+        std::fill( lo, lo+D, first );
+        std::fill( hi, hi+D, first );
+        for (iterator i=first;i!=last;++i)
+        {
+            const VectorBase& p = *i;
+            for (size_t d=0;d!=D;++d)
+            {
+                if (p[d] < (*lo[d])[d]) lo[d] = i;
+                if (p[d] > (*hi[d])[d]) hi[d] = i;
+            }
+        }
+        size_t widest = 0;
+        Scalar span = -1;
+        for (size_t d=0;d!=D;++d)
+        {
+            const VectorBase diagonal = VectorBase( *hi[d] ) - VectorBase( *lo[d] );
+            if (diagonal.LengthSquare() > span)
+            {
+                span = diagonal.LengthSquare();
+                widest = d;
+            }
+        }
+
+        const VectorBase pair[2] = { *lo[widest], *hi[widest] };
+        const VectorBase center = GetMidpoint( pair[0], pair[1] );
+        result = Sphere<T>( center );
+        result.ExpandToContain( pair[0] );
+        result.ExpandToContain( pair[1] );
+        for (iterator i=first;i!=last;++i)
+            result.ExpandToContain( *i );
+        const VectorBase final( result.GetCenter() );
+        result = Sphere<T>( final, GetEnclosingRadius( first, last, final ) );
+    }
+
+    // as ComputeMinimalSphere, holding [first,last) with points boundary[]
+    // on its surface, for points[0,end) in turn
+    template<typename T, typename VectorBase>
+    void ComputeMinimalSphere(const std::vector<VectorBase>& points, size_t end,
+        VectorBase* boundary, size_t boundaryCount, Sphere<T>& result)
+    {
+        const size_t D = VectorBase::sDimensions;
+        // slack for points on the sphere, which would otherwise join the
+        // boundary only to make it degenerate
+        auto holds = [&](const VectorBase& p) {
+            const VectorBase d = p - result.GetCenter();
+            return d.LengthSquare() <= result.GetRadius()*result.GetRadius()*(1 + 1e-12);
+        };
+        if (boundaryCount==0)
+            result = Sphere<T>( points[0] );
+        else if (!ComputeCircumsphere( boundary, boundaryCount, result ))
+            result.ExpandToContain( boundary[boundaryCount-1] );
+        if (boundaryCount==D+1)
+            return;
+        for (size_t i=boundaryCount==0 ? 1 : 0;i<end;++i)
+        {
+            const VectorBase& p = points[i];
+            if (holds( p ))
+                continue;
+            boundary[boundaryCount] = p;
+            ComputeMinimalSphere( points, i, boundary, boundaryCount+1, result );
+        }
+    }
+
+    // the smallest sphere holding the points of [first,last), by Welzl's
+    // algorithm: every point outside the sphere of those before it is on
+    // the boundary of theirs and its own. taken in a random order that is
+    // expected linear time, the order here is fixed so the result is
+    // repeatable. the sphere is computed in double and its radius then
+    // rounded up to hold every point
+    template<typename T, typename iterator>
+    void ComputeMinimalSphere(iterator first, iterator last, Sphere<T>& result)
+    {
+        typedef typename Sphere<T>::VectorBase VectorBase;
+        typedef typename Sphere<T>::ScalarType Scalar;
+        typedef VectorN<double, VectorBase::sDimensions> Point;
+        const size_t D = VectorBase::sDimensions;
+        assert( first!=last );
+
+        // copied in double and shuffled, so the passes read in order
+        std::vector<Point> points;
+        points.reserve( size_t( last - first ) );
+        for (iterator i=first;i!=last;++i)
+            points.push_back( Point( VectorBase( *i ) ) );
+        std::shuffle( points.begin(), points.end(), std::minstd_rand( 0x5eed ) );
+
+        std::vector<Point> boundary( D+1, Point( 0.0 ) );
+        Sphere<Point> sphere( uninitialised );
+        ComputeMinimalSphere( points, points.size(), boundary.data(), 0, sphere );
+
+        // the same center in Scalar, and the radius out to the farthest point
+        VectorBase center( uninitialised );
+        for (size_t d=0;d!=D;++d)
+            center[d] = Scalar( sphere.GetCenter()[d] );
+        result = Sphere<T>( center, GetEnclosingRadius( first, last, center ) );
+    }
+
+    // result[i] is 1 if sphere first+i of spheres overlaps query, 0 otherwise
+    template<typename T>
+    void ComputeOverlaps(const SphereArray<T>& spheres, size_t first, size_t last,
+        const Sphere<T>& query, uint8_t* result)
+    {
+        typedef typename SphereArray<T>::ScalarType Scalar;
+        const size_t D = SphereArray<T>::sDimensions;
+        const size_t block = 256;
+        assert( first<=last && last<=spheres.GetSize() );
+
+        // a block of squared distances at a time, an axis at a time
+        Scalar distance[block];
+        for (size_t begin=first;begin<last;begin+=block)
+        {
+            const size_t n = std::min( block, last-begin );
+            std::fill( distance, distance+n, Scalar(0) );
+            for (size_t d=0;d!=D;++d)
+            {
+                const Scalar* c = spheres.GetCenters( d ) + begin;
+                const Scalar q = query.GetCenter()[d];
+                for (size_t i=0;i!=n;++i)
+                    distance[i] += (c[i] - q)*(c[i] - q);
+            }
+            const Scalar* r = spheres.GetRadii() + begin;
+            for (size_t i=0;i!=n;++i)
+            {
+                const Scalar reach = r[i] + query.GetRadius();
+                result[begin-first+i] = uint8_t( distance[i] <= reach*reach );
+            }
+        }
+    }
+
+    // result[i] is 1 if sphere first+i of spheres overlaps box, 0 otherwise.
+    // the squared distance from each center to the box (Arvo, Graphics
+    // Gems, 1990), clamped an axis at a time without branches
+    template<typename T>
+    void ComputeOverlaps(const SphereArray<T>& spheres, size_t first, size_t last,
+        const AxisAlignedBoundingBox<T>& box, uint8_t* result)
+    {
+        typedef typename SphereArray<T>::ScalarType Scalar;
+        const size_t D = SphereArray<T>::sDimensions;
+        const size_t block = 256;
+        assert( first<=last && last<=spheres.GetSize() );
+
+        Scalar distance[block];
+        for (size_t begin=first;begin<last;begin+=block)
+        {
+            const size_t n = std::min( block, last-begin );
+            std::fill( distance, distance+n, Scalar(0) );
+            for (size_t d=0;d!=D;++d)
+            {
+                const Scalar* c = spheres.GetCenters( d ) + begin;
+                const Scalar lo = box.GetMinBound()[d];
+                const Scalar hi = box.GetMaxBound()[d];
+                for (size_t i=0;i!=n;++i)
+                {
+                    const Scalar outside = std::max( std::max( lo - c[i], c[i] - hi ), Scalar(0) );
+                    distance[i] += outside*outside;
+                }
+            }
+            const Scalar* r = spheres.GetRadii() + begin;
+            for (size_t i=0;i!=n;++i)
+                result[begin-first+i] = uint8_t( distance[i] <= r[i]*r[i] );
+        }
+    }
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template<typename T>
+    Sphere<T>::Sphere(const VectorBase& center, ScalarType radius)
+        : mCenter(center), mRadius(radius)
+    {
+        assert( radius>=0 );
+    }
+
+    template<typename T>
+    Sphere<T>::Sphere(const VectorBase& p)
+        : mCenter(p), mRadius(0)
+    {
+    }
+
+    template<typename T>
+    Sphere<T>::Sphere(const BoundsType& box)
+        : mCenter(GetMidpoint( box.GetMinBound(), box.GetMaxBound() )), mRadius(box.GetCircumradius())
+    {
+    }
+
+    template<typename T>
+    const typename Sphere<T>::VectorType& Sphere<T>::GetCenter() const
+    {
+        return mCenter;
+    }
+
+    template<typename T>
+    typename Sphere<T>::ScalarType Sphere<T>::GetRadius() const
+    {
+        return mRadius;
+    }
+
+    template<typename T>
+    bool Sphere<T>::Contains(const VectorBase& p) const
+    {
+        const VectorBase d = p - mCenter;
+        return d.LengthSquare() <= mRadius*mRadius;
+    }
+
+    template<typename T>
+    bool Sphere<T>::Contains(const Sphere& rhs) const
+    {
+        if (rhs.mRadius > mRadius)
+            return false;
+        const VectorBase d = rhs.mCenter - mCenter;
+        const ScalarType room = mRadius - rhs.mRadius;
+        return d.LengthSquare() <= room*room;
+    }
+
+    template<typename T>
+    bool Sphere<T>::Overlaps(const Sphere& rhs) const
+    {
+        const VectorBase d = rhs.mCenter - mCenter;
+        const ScalarType reach = mRadius + rhs.mRadius;
+        return d.LengthSquare() <= reach*reach;
+    }
+
+    template<typename T>
+    bool Sphere<T>::Overlaps(const BoundsType& box) const
+    {
+        ScalarType distance = 0;
+        for (size_t d=0;d!=sDimensions;++d)
+        {
+            const ScalarType outside = std::max( std::max(
+                box.GetMinBound()[d] - mCenter[d], mCenter[d] - box.GetMaxBound()[d] ), ScalarType(0) );
+            distance += outside*outside;
+        }
+        return distance <= mRadius*mRadius;
+    }
+
+    template<typename T>
+    void Sphere<T>::ExpandToContain(const VectorBase& p)
+    {
+        const VectorBase d = p - mCenter;
+        const ScalarType distanceSquare = d.LengthSquare();
+        if (distanceSquare <= mRadius*mRadius)
+            return;
+        const ScalarType distance = Sqrt( distanceSquare );
+        const ScalarType radius = (mRadius + distance) / 2;
+        VectorBase step( d );
+        step *= (radius - mRadius) / distance;
+        const VectorBase old( mCenter );
+        mCenter += step;
+
+        // the center lands on the nearest representable point, which far
+        // from the origin can be well off the ideal one. the radius is
+        // measured in double from where it landed, to p and to the far side
+        // of the sphere as was, then rounded up
+        double moved = 0, reach = 0;
+        for (size_t k=0;k!=sDimensions;++k)
+        {
+            const double m = double( mCenter[k] ) - double( old[k] );
+            const double e = double( p[k] ) - double( mCenter[k] );
+            moved += m*m;
+            reach += e*e;
+        }
+        const double needed = std::max( std::sqrt( moved ) + double( mRadius ), std::sqrt( reach ) );
+        mRadius = std::max( radius, ScalarType( needed ) );
+        if (double( mRadius ) < needed)
+            mRadius = std::nextafter( mRadius, std::numeric_limits<ScalarType>::max() );
+        // and the last ulps for p as Contains rounds
+        while (!Contains( p ))
+            mRadius = std::nextafter( mRadius, std::numeric_limits<ScalarType>::max() );
+    }
+
+    template<typename T>
+    SphereArray<T>::SphereArray()
+    {
+    }
+
+    template<typename T>
+    size_t SphereArray<T>::GetSize() const
+    {
+        return mData[0].size();
+    }
+
+    template<typename T>
+    void SphereArray<T>::Reserve(size_t count)
+    {
+        for (size_t k=0;k!=sDimensions+1;++k)
+            mData[k].reserve( count );
+    }
+
+    template<typename T>
+    void SphereArray<T>::Add(const SphereType& s)
+    {
+        for (size_t d=0;d!=sDimensions;++d)
+            mData[d].push_back( s.GetCenter()[d] );
+        mData[sDimensions].push_back( s.GetRadius() );
+    }
+
+    template<typename T>
+    typename SphereArray<T>::SphereType SphereArray<T>::Get(size_t i) const
+    {
+        assert( i<GetSize() );
+        typename SphereType::VectorBase center( uninitialised );
+        for (size_t d=0;d!=sDimensions;++d)
+            center[d] = mData[d][i];
+        return SphereType( center, mData[sDimensions][i] );
+    }
+
+    template<typename T>
+    const typename SphereArray<T>::ScalarType* SphereArray<T>::GetCenters(size_t axis) const
+    {
+        assert( axis<sDimensions );
+        return mData[axis].data();
+    }
+
+    template<typename T>
+    const typename SphereArray<T>::ScalarType* SphereArray<T>::GetRadii() const
+    {
+        return mData[sDimensions].data();
+    }
+}
+
+#endif//GEOMETRY_SPHERE_H_INCLUDED_
@@ -7,7 +7,35 @@
 #include "../aabb2d.h"
 #include "../aabb3d.h"
 #include "../aabb_fn.h"
-
+#include "../mesh.h"
+#include "../bvh.h"
+#include "../quantised_bvh.h"
+#include "../triangle_array.h"
+#include "../quaternion.h"
+#include "../affine3.h"
+#include "../transform_hierarchy.h"
+#include "../parallel.h"
+#include "../arena.h"
+#include "../matrixx.h"
+#include "../linear_solve.h"
+#include "../matrix_chain.h"
+#include "../binary_file.h"
+#include "../point_cloud_reader.h"
+#include "../space_filling_curve.h"
+#include "../radix_sort.h"
+#include "../lbvh.h"
+#include "../convex_hull.h"
+#include "../convex_hull3d.h"
+#include "../polygon2d.h"
+#include "../polygon_triangulation.h"
+#include "../gjk.h"
+#include "../obb3d.h"
+#include "../sphere.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <stdexcept>
 #include <vector>
 
 using namespace Geometry;
@@ -679,6 +707,2362 @@ void Test2dIntersection()
     Flush("Test2dIntersection");
 }
 
+void TestMesh()
+{
+    // unit square in the xy plane, split into two faces, plus a lone vertex
+    IndexedMesh<float> mesh;
+    mesh.AddVertex( Vector3d<float>(0,0,0) );
+    mesh.AddVertex( Vector3d<float>(1,0,0) );
+    mesh.AddVertex( Vector3d<float>(1,1,0) );
+    mesh.AddVertex( Vector3d<float>(0,1,0) );
+    mesh.AddVertex( Vector3d<float>(5,5,5) );
+    mesh.AddFace(0,1,2);
+    mesh.AddFace(0,2,3);
+
+    TEST( mesh.GetVertexCount()==5 );
+    TEST( mesh.GetFaceCount()==2 );
+    TEST( mesh.GetSurfaceArea()==1 );
+    TEST( Fabs(mesh.GetFace(1).GetSurfaceArea()-0.5f) < 0.0001f );
+
+    std::vector< Vector3d<float> > normals;
+    mesh.ComputeFaceNormals( normals );
+    TEST( normals.size()==2 );
+    TEST( normals[0]==Vector3d<float>(0,0,1) );
+    TEST( normals[1]==FaceNormal(mesh.GetFace(1)) );
+
+    float areas[2];
+    mesh.ComputeFaceAreas( 0, 2, areas );
+    TEST( areas[0]==0.5f && areas[1]==0.5f );
+
+    mesh.ComputeVertexNormals( normals );
+    TEST( normals.size()==5 );
+    TEST( normals[0]==Vector3d<float>(0,0,1) );
+    TEST( normals[3]==Vector3d<float>(0,0,1) );
+    TEST( normals[4]==Vector3d<float>(0,0,0) );
+
+    // the unreferenced vertex does not contribute to the bounds
+    AxisAlignedBoundingBox3d<float> bounds = mesh.GetBounds();
+    TEST( bounds.GetMinBound()==Vector3d<float>(0,0,0) );
+    TEST( bounds.Contains( Vector3d<float>(1,1,0) ) );
+    TEST( !bounds.Contains( Vector3d<float>(5,5,5) ) );
+
+    // no faces, the inverted box and nothing read
+    IndexedMesh<float> empty;
+    empty.AddVertex( Vector3d<float>(1,2,3) );
+    TEST( !empty.ComputeBounds( 0, 0, bounds ) && !bounds.Contains( Vector3d<float>(1,2,3) ) );
+    TEST( empty.GetBounds().GetMinBound()[0]==std::numeric_limits<float>::max() );
+    TEST( empty.GetBounds( ExecutionPolicy() ).GetMaxBound()==empty.GetBounds().GetMaxBound() );
+    IndexedMesh<unsigned> emptyUnsigned;
+    TEST( emptyUnsigned.GetBounds().GetMaxBound()[0]==0 && !emptyUnsigned.GetBounds().Contains( Vector3d<unsigned>(1,1,1) ) );
+
+    Flush("TestMesh");
+}
+
+float RandomFloat(float lo, float hi)
+{
+    return lo + (hi-lo) * (rand() / float(RAND_MAX));
+}
+
+void TestRayTriangle()
+{
+    Triangle3d<float> tri(
+        Vector3d<float>(0,0,0),
+        Vector3d<float>(1,0,0),
+        Vector3d<float>(0,1,0) );
+
+    Ray3d<float> down( Vector3d<float>(0.25f,0.25f,1), Vector3d<float>(0,0,-1) );
+    float t = 100, u, v;
+    TEST( down.Intersection(tri, &t, &u, &v) );
+    TEST( t==1 );
+    TEST( u==0.25f && v==0.25f );
+
+    // closer limit rejects the hit, as does pointing away
+    t = 0.5f;
+    TEST( !down.Intersection(tri, &t) );
+    Ray3d<float> up( Vector3d<float>(0.25f,0.25f,1), Vector3d<float>(0,0,1) );
+    t = 100;
+    TEST( !up.Intersection(tri, &t) );
+
+    // edges are inclusive
+    Ray3d<float> edge( Vector3d<float>(0.5f,0.5f,1), Vector3d<float>(0,0,-1) );
+    t = 100;
+    TEST( edge.Intersection(tri, &t) );
+
+    // ray box
+    AxisAlignedBoundingBox3d<float> box( Vector3d<float>(-1,-1,-1), Vector3d<float>(1,1,1) );
+    TEST( down.Intersects(box, 100) );
+    TEST( down.Intersects(box, 0) ); // origin inside the box
+    Ray3d<float> miss( Vector3d<float>(5,5,5), Vector3d<float>(1,0,0) );
+    TEST( !miss.Intersects(box, 100) );
+
+    // the block agrees with the scalar test lane by lane
+    srand(1);
+    for (int n=0;n!=100;++n)
+    {
+        TriangleBlock<float,4> block;
+        std::vector< Triangle3d<float> > tris;
+        for (uint32_t i=0;i!=3;++i)
+        {
+            tris.push_back( Triangle3d<float>(
+                Vector3d<float>( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) ),
+                Vector3d<float>( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) ),
+                Vector3d<float>( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) ) ) );
+            block.Add( tris.back(), i );
+        }
+        Ray3d<float> ray(
+            Vector3d<float>( RandomFloat(-2,2), RandomFloat(-2,2), -3 ),
+            Vector3d<float>( RandomFloat(-0.5f,0.5f), RandomFloat(-0.5f,0.5f), 1 ) );
+
+        RayHit<float> expect;
+        for (uint32_t i=0;i!=tris.size();++i)
+        {
+            if (ray.Intersection( tris[i], &expect.mDistance ))
+                expect.mTriangle = i;
+        }
+        RayHit<float> hit;
+        bool found = block.Intersection( ray, &hit );
+        TEST( found == (expect.mTriangle!=RayHit<float>::sNone) );
+        TEST( hit.mTriangle == expect.mTriangle );
+        TEST( block.Intersects( ray, 100 ) == found );
+    }
+
+    // a fan about an awkward vertex, rays aimed along its shared edges and
+    // at the vertex itself. none may slip between the triangles
+    const Vector3d<float> hub( 0.1f, 0.3f, 0.7f );
+    std::vector< Triangle3d<float> > fan;
+    std::vector< Vector3d<float> > rim;
+    for (int i=0;i!=7;++i)
+    {
+        const float angle = i * 6.2831853f / 7;
+        rim.push_back( Vector3d<float>( 0.1f + cosf( angle ), 0.3f + sinf( angle ), 0.7f + 0.3f*sinf( 3*angle ) ) );
+    }
+    for (int i=0;i!=7;++i)
+        fan.push_back( Triangle3d<float>( hub, rim[i], rim[(i+1)%7] ) );
+    int misses = 0;
+    for (int n=0;n!=20000;++n)
+    {
+        const Vector3d<float> origin( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(2,3) );
+        const float s = n%10 ? RandomFloat(0,1) : 0;
+        const Vector3d<float>& end = rim[n%7];
+        const Vector3d<float> target( hub[0] + s*(end[0]-hub[0]), hub[1] + s*(end[1]-hub[1]), hub[2] + s*(end[2]-hub[2]) );
+        const Ray3d<float> ray( origin, Vector3d<float>( target - origin ) );
+        TriangleBlock<float,8> block;
+        bool hit = false;
+        for (uint32_t i=0;i!=fan.size();++i)
+        {
+            float tHit = 100;
+            hit |= ray.Intersection( fan[i], &tHit );
+            block.Add( fan[i], i );
+        }
+        misses += !hit || !block.Intersects( ray, 100 );
+    }
+    TEST( misses==0 );
+
+    Flush("TestRayTriangle");
+}
+
+void TestBVH()
+{
+    // a bumpy height field
+    IndexedMesh<float> mesh;
+    const int size = 32;
+    for (int y=0;y!=size;++y)
+        for (int x=0;x!=size;++x)
+            mesh.AddVertex( Vector3d<float>( float(x), float(y), Sin(x*0.5f)+Cos(y*0.3f) ) );
+    for (int y=0;y!=size-1;++y)
+    {
+        for (int x=0;x!=size-1;++x)
+        {
+            uint32_t i = y*size+x;
+            mesh.AddFace( i, i+1, i+size+1 );
+            mesh.AddFace( i, i+size+1, i+size );
+        }
+    }
+
+    TriangleBVH<float> bvh( mesh );
+    TEST( bvh.GetNodeCount() > 1 );
+    TEST( bvh.GetBounds().GetMinBound()==mesh.GetBounds().GetMinBound() );
+
+    // compare against brute force
+    srand(2);
+    int hits = 0;
+    for (int n=0;n!=200;++n)
+    {
+        Ray3d<float> ray(
+            Vector3d<float>( RandomFloat(-5,size+5), RandomFloat(-5,size+5), 10 ),
+            Vector3d<float>( RandomFloat(-0.5f,0.5f), RandomFloat(-0.5f,0.5f), -1 ) );
+
+        RayHit<float> expect;
+        for (uint32_t f=0;f!=mesh.GetFaceCount();++f)
+        {
+            if (ray.Intersection( mesh.GetFace(f), &expect.mDistance ))
+                expect.mTriangle = f;
+        }
+
+        RayHit<float> hit;
+        bool found = bvh.ClosestHit( ray, &hit );
+        TEST( found == (expect.mTriangle!=RayHit<float>::sNone) );
+        TEST( hit.mTriangle == expect.mTriangle );
+        TEST( bvh.AnyHit( ray, 100 ) == found );
+        TEST( bvh.AnyHit( ray, expect.mDistance*0.999f ) == false );
+        hits += found;
+    }
+    TEST( hits > 100 );
+
+    std::vector< Triangle3d<float> > none;
+    TriangleBVH<float> empty( none );
+    RayHit<float> hit;
+    TEST( !empty.ClosestHit( Ray3d<float>( Vector3d<float>(0,0,0), Vector3d<float>(1,0,0) ), &hit ) );
+
+    Flush("TestBVH");
+}
+
+template<typename Quantised, size_t W>
+void TestQuantisedBVH(const TriangleBVH<float>& bvh, const IndexedMesh<float>& mesh)
+{
+    QuantisedBVH<float, Quantised, W> qbvh( bvh );
+    TEST( qbvh.GetNodeCount() > 0 );
+    TEST( qbvh.GetNodeMemory()*2 < bvh.GetNodeMemory() );
+
+    // every dequantised child box holds its triangles: aim rays just inside
+    // the corners of triangles, where the boxes are tightest
+    srand(36);
+    for (int n=0;n!=300;++n)
+    {
+        const Triangle3d<float> face = mesh.GetFace( rand()%mesh.GetFaceCount() );
+        Vector3d<float> target( face.GetCentroid() - face.GetA() );
+        target *= 0.001f;
+        target += face.GetA();
+        const Vector3d<float> origin( RandomFloat(-5,40), RandomFloat(-5,40), 10 );
+        Ray3d<float> ray( origin, Vector3d<float>( target - origin ) );
+
+        RayHit<float> expect, hit;
+        for (uint32_t f=0;f!=mesh.GetFaceCount();++f)
+        {
+            if (ray.Intersection( mesh.GetFace(f), &expect.mDistance ))
+                expect.mTriangle = f;
+        }
+        const bool found = expect.mTriangle!=RayHit<float>::sNone;
+        TEST( qbvh.ClosestHit( ray, &hit ) == found );
+        TEST( Abs( hit.mDistance - expect.mDistance ) < 1e-5f );
+        TEST( qbvh.AnyHit( ray, 2 ) == found );
+    }
+
+    for (size_t node=0;node!=qbvh.GetNodeCount();++node)
+        for (size_t lane=0;lane!=W;++lane)
+            if (qbvh.HasChild( node, lane ))
+                TEST( qbvh.GetBounds().Contains( qbvh.GetChildBounds( node, lane ) ) );
+}
+
+void TestQuantisedBVH()
+{
+    IndexedMesh<float> mesh;
+    const int size = 40;
+    for (int y=0;y!=size;++y)
+        for (int x=0;x!=size;++x)
+            mesh.AddVertex( Vector3d<float>( x*0.9f, y*0.9f, Sin(x*0.7f)*Cos(y*0.4f) ) );
+    for (int y=0;y!=size-1;++y)
+    {
+        for (int x=0;x!=size-1;++x)
+        {
+            uint32_t i = y*size+x;
+            mesh.AddFace( i, i+1, i+size+1 );
+            mesh.AddFace( i, i+size+1, i+size );
+        }
+    }
+    TriangleBVH<float> bvh( mesh );
+
+    TestQuantisedBVH<uint8_t, 4>( bvh, mesh );
+    TestQuantisedBVH<uint8_t, 8>( bvh, mesh );
+    TestQuantisedBVH<uint16_t, 4>( bvh, mesh );
+    const size_t wideMemory = QuantisedBVH<float, uint8_t, 8>( bvh ).GetNodeMemory();
+    TEST( wideMemory*4 < bvh.GetNodeMemory() );
+
+    // a tree that is a single leaf
+    std::vector< Triangle3d<float> > one( 1, Triangle3d<float>(
+        Vector3d<float>(0,0,0), Vector3d<float>(1,0,0), Vector3d<float>(0,1,0) ) );
+    TriangleBVH<float> small( one );
+    QuantisedBVH<float> qsmall( small );
+    RayHit<float> hit;
+    TEST( qsmall.ClosestHit( Ray3d<float>( Vector3d<float>(0.25f,0.25f,1), Vector3d<float>(0,0,-1) ), &hit ) );
+    TEST( hit.mTriangle==0 );
+
+    Flush("TestQuantisedBVH");
+}
+
+void TestTriangleArray()
+{
+    TEST( Fabs( ACosApprox(0.5) - ACos(0.5) ) < 1e-7 );
+    TEST( Fabs( ACosApprox(-0.9) - ACos(-0.9) ) < 1e-7 );
+    TEST( ACosApprox(1.0f) == 0 );
+
+    srand(3);
+    TriangleArray< Vector3d<double> > tris;
+    for (int n=0;n!=64;++n)
+    {
+        tris.Add( Triangle3d<double>(
+            Vector3d<double>( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) ),
+            Vector3d<double>( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) ),
+            Vector3d<double>( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) ) ) );
+    }
+    TEST( tris.GetSize()==64 );
+    TEST( tris.Get(5).GetB()[1]==tris.GetCoordinates(1,1)[5] );
+
+    double a0[64], a1[64], a2[64];
+    ComputeAngles( tris, 0, 64, a0, a1, a2 );
+    double minAngle[64], maxAngle[64], area[64];
+    ComputeTriangleQuality( tris, 0, 64, minAngle, maxAngle, area );
+    double minCos[64], maxCos[64];
+    ComputeTriangleQuality( tris, 0, 64, minCos, maxCos, nullptr, angle_cosines );
+
+    for (int n=0;n!=64;++n)
+    {
+        const Triangle3d<double> t( tris.Get(n).GetA(), tris.Get(n).GetB(), tris.Get(n).GetC() );
+        Vector3d<double> angles = t.GetAngles();
+        TEST( Fabs( angles[0]-a0[n] ) < 1e-6 );
+        TEST( Fabs( angles[1]-a1[n] ) < 1e-6 );
+        TEST( Fabs( angles[2]-a2[n] ) < 1e-6 );
+        TEST( Fabs( std::min(a0[n],std::min(a1[n],a2[n])) - minAngle[n] ) < 1e-6 );
+        TEST( Fabs( std::max(a0[n],std::max(a1[n],a2[n])) - maxAngle[n] ) < 1e-6 );
+        TEST( Fabs( Cos(minAngle[n]) - minCos[n] ) < 1e-6 );
+        TEST( Fabs( Cos(maxAngle[n]) - maxCos[n] ) < 1e-6 );
+        TEST( Fabs( t.GetSurfaceArea() - area[n] ) < 1e-6 );
+    }
+
+    // sub ranges write from the start of the output
+    double sub[4];
+    ComputeSurfaceAreas( tris, 10, 14, sub );
+    TEST( sub[0]==area[10] && sub[3]==area[13] );
+
+    // past one stack block, with a collapsed and a flat triangle at the end
+    for (int n=64;n!=598;++n)
+        tris.Add( tris.Get( n%64 ) );
+    tris.Add( Triangle3d<double>( Vector3d<double>(1,2,3), Vector3d<double>(1,2,3), Vector3d<double>(4,5,6) ) );
+    tris.Add( Triangle3d<double>( Vector3d<double>(0,0,0), Vector3d<double>(1,1,1), Vector3d<double>(2,2,2) ) );
+    std::vector<double> minMany( 600 ), maxMany( 600 ), areaMany( 600 );
+    ComputeTriangleQuality( tris, 0, 600, minMany.data(), maxMany.data(), areaMany.data() );
+    TEST( minMany[595]==minAngle[595%64] && maxMany[300]==maxAngle[300%64] && areaMany[597]==area[597%64] );
+    TEST( minMany[598]==0 && Fabs( maxMany[598] - M_PI ) < 1e-6 && areaMany[598]==0 );
+    TEST( Fabs( minMany[599] ) < 1e-6 && Fabs( maxMany[599] - M_PI ) < 1e-6 && Fabs( areaMany[599] ) < 1e-6 );
+
+    // a zero length edge gives pi at both its ends rather than NaN
+    std::vector<double> d0( 600 ), d1( 600 ), d2( 600 );
+    ComputeAngles( tris, 0, 600, d0.data(), d1.data(), d2.data() );
+    TEST( d0[598]==M_PI && d1[598]==M_PI && d2[598]==0 );
+    TEST( d0[5]==a0[5] && d2[63]==a2[63] );
+
+    // the fast tier stays close to the exact one
+    double f0[64], f1[64], f2[64], fMin[64];
+    ComputeAngles<accuracy_fast>( tris, 0, 64, f0, f1, f2 );
+    ComputeTriangleQuality<accuracy_fast>( tris, 0, 64, fMin, nullptr, nullptr );
+    for (int n=0;n!=64;++n)
+    {
+        TEST( Fabs( f0[n]-a0[n] ) < 1e-7 && Fabs( f1[n]-a1[n] ) < 1e-7 && Fabs( f2[n]-a2[n] ) < 1e-7 );
+        TEST( Fabs( fMin[n]-minAngle[n] ) < 1e-7 );
+    }
+
+    Flush("TestTriangleArray");
+}
+
+template< typename Scalar >
+void TestFastMaths(Scalar preciseError)
+{
+    Scalar worstPrecise = 0, worstFast = 0;
+    for (int n=-2000;n!=2000;++n)
+    {
+        const Scalar x = Scalar(n) * Scalar(0.0123);
+        Scalar s, c;
+        SinCos( x, &s, &c );
+        TEST( s==Sin(x) && c==Cos(x) );
+
+        SinCos<accuracy_precise>( x, &s, &c );
+        worstPrecise = std::max( worstPrecise, std::max( Fabs(s-Sin(x)), Fabs(c-Cos(x)) ) );
+        TEST( Sin<accuracy_precise>(x)==s );
+
+        SinCos<accuracy_fast>( x, &s, &c );
+        worstFast = std::max( worstFast, std::max( Fabs(s-Sin(x)), Fabs(c-Cos(x)) ) );
+    }
+    TEST( worstPrecise < preciseError );
+    TEST( worstFast < Scalar(4e-5) );
+
+    // stays relative right next to the zeros, up to the end of the range
+    const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+    for (int k=1;k<600000;k+=997)
+    {
+        const Scalar x = Scalar( k * M_PI / 2 );
+        Scalar s, c;
+        SinCos<accuracy_precise>( x, &s, &c );
+        TEST( Fabs( s - Sin(x) ) <= 4*eps*Fabs( Sin(x) ) );
+        TEST( Fabs( c - Cos(x) ) <= 4*eps*Fabs( Cos(x) ) );
+    }
+
+    // past the range, and for inf and NaN, the approximate tiers give NaN
+    const Scalar outside[3] = { Scalar(2e6), -std::numeric_limits<Scalar>::infinity(), std::numeric_limits<Scalar>::quiet_NaN() };
+    for (int n=0;n!=3;++n)
+    {
+        Scalar s, c;
+        SinCos<accuracy_precise>( outside[n], &s, &c );
+        TEST( s!=s && c!=c );
+        TEST( Cos<accuracy_fast>( outside[n] ) != Cos<accuracy_fast>( outside[n] ) );
+    }
+
+    Scalar worstRSqrt = 0;
+    for (int n=1;n!=1000;++n)
+    {
+        const Scalar x = Scalar(n) * Scalar(0.37);
+        const Scalar exact = RSqrt(x);
+        TEST( exact == 1/Sqrt(x) );
+        worstRSqrt = std::max( worstRSqrt, Fabs( RSqrt<accuracy_precise>(x) - exact ) / exact );
+        TEST( Fabs( RSqrt<accuracy_fast>(x) - exact ) / exact < Scalar(1e-5) );
+    }
+    TEST( worstRSqrt < preciseError );
+
+    // batch forms match the scalar ones
+    Scalar x[8] = { 0, 1, 2, 3, -4, 5, 6, 70000 };
+    Scalar s[8], c[8], r[8];
+    SinCos<accuracy_fast>( x, s, c, 8 );
+    Sin( x, r, 8 );
+    for (int n=0;n!=8;++n)
+    {
+        Scalar es, ec;
+        SinCos<accuracy_fast>( x[n], &es, &ec );
+        TEST( s[n]==es && c[n]==ec );
+        TEST( r[n]==Sin(x[n]) );
+    }
+}
+
+void TestFastMaths()
+{
+    TestFastMaths<float>( 2e-7f );
+    TestFastMaths<double>( 1e-15 );
+    Flush("TestFastMaths");
+}
+
+void TestBatchRotation()
+{
+    // rotation around an axis agrees with the fixed axis builders at any angle
+    TEST( Matrix4<double>::RotationAround({1,0,0},0.3).Equals( Matrix4<double>::RotationAroundX(0.3), 1e-12 ) );
+    TEST( Matrix4<double>::RotationAround({0,1,0},0.3).Equals( Matrix4<double>::RotationAroundY(0.3), 1e-12 ) );
+    TEST( Matrix4<double>::RotationFromEuler({0,0,0}) == Matrix4<double>::Identity() );
+
+    srand(4);
+    const size_t count = 100;
+    std::vector< VectorN<double,3> > euler, axis;
+    std::vector< Vector3d<double> > from, to;
+    std::vector< double > angle;
+    for (size_t n=0;n!=count;++n)
+    {
+        euler.push_back( VectorN<double,3>({ RandomFloat(-10,10), RandomFloat(-10,10), RandomFloat(-10,10) }) );
+        Vector3d<double> a( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) );
+        a.Normalise();
+        axis.push_back( a );
+        angle.push_back( RandomFloat(-10,10) );
+        Vector3d<double> b( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) );
+        b.Normalise();
+        from.push_back( a );
+        to.push_back( b );
+    }
+
+    std::vector< Matrix4<double> > result( count );
+    std::vector< MatrixNM<double,4,3> > affine( count, MatrixNM<double,4,3>(uninitialised) );
+
+    Matrix4<double>::RotationFromEuler( euler.data(), result.data(), count );
+    Matrix4<double>::RotationFromEuler<accuracy_fast>( euler.data(), affine.data(), count );
+    for (size_t n=0;n!=count;++n)
+    {
+        const Matrix4<double> expect = Matrix4<double>::RotationFromEuler( euler[n] );
+        TEST( result[n] == expect );
+        for (int r=0;r!=4;++r)
+            for (int c=0;c!=3;++c)
+                TEST( Fabs( affine[n][r][c] - expect[r][c] ) < 1e-4 );
+    }
+
+    Matrix4<double>::RotationAround( axis.data(), angle.data(), result.data(), count );
+    for (size_t n=0;n!=count;++n)
+        TEST( result[n] == Matrix4<double>::RotationAround( axis[n], angle[n] ) );
+
+    Matrix4<double>::RotationAlign( from.data(), to.data(), affine.data(), count );
+    for (size_t n=0;n!=count;++n)
+    {
+        // the rotation builders are written for column vectors, m*v
+        Vector3d<double> p( uninitialised );
+        for (int r=0;r!=3;++r)
+            p[r] = affine[n][r][0]*from[n][0] + affine[n][r][1]*from[n][1] + affine[n][r][2]*from[n][2];
+        TEST( p.Distance( to[n] ) < 1e-9 );
+    }
+
+    Flush("TestBatchRotation");
+}
+
+Quaternion<double> RandomRotation()
+{
+    Vector3d<double> axis( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) );
+    axis.Normalise();
+    return Quaternion<double>::RotationAround( axis, RandomFloat(-3,3) );
+}
+
+void TestQuaternion()
+{
+    const Vector3d<double> v(1,2,3);
+    TEST( Quaternion<double>().Rotate(v) == v );
+    TEST( Quaternion<double>().GetMatrix() == Matrix4<double>::Identity() );
+
+    // matches the matrix builders
+    const Quaternion<double> qz = Quaternion<double>::RotationAround( {0,0,1}, 0.7 );
+    TEST( qz.GetMatrix().Equals( Matrix4<double>::RotationAroundZ(0.7), 1e-20 ) );
+    TEST( qz.Rotate( Vector3d<double>(1,0,0) ).Distance( Vector3d<double>(Cos(0.7),-Sin(0.7),0) ) < 1e-12 );
+    TEST( qz.Rotate(v).Distance( Vector3d<double>( Matrix4<double>::RotationAroundZ(0.7)*v ) ) < 1e-12 );
+
+    srand(5);
+    for (int n=0;n!=50;++n)
+    {
+        const Quaternion<double> a = RandomRotation();
+        const Quaternion<double> b = RandomRotation();
+
+        // round trip through the matrix, up to sign
+        const Quaternion<double> c( a.GetMatrix() );
+        TEST( Fabs( Fabs( DotProduct(a, c) ) - 1 ) < 1e-12 );
+
+        // rotation matches the matrix, and composition matches matrix
+        // multiply, both with row vectors so a*b applies a first
+        TEST( a.Rotate(v).Distance( Vector3d<double>( a.GetMatrix()*v ) ) < 1e-12 );
+        TEST( (a*b).GetMatrix().Equals( a.GetMatrix()*b.GetMatrix(), 1e-20 ) );
+        TEST( (a*b).Rotate(v).Distance( b.Rotate( a.Rotate(v) ) ) < 1e-12 );
+        TEST( (a*b).Rotate(v).Distance( Vector3d<double>( Matrix4<double>( a.GetMatrix()*b.GetMatrix() )*v ) ) < 1e-12 );
+        TEST( (a*a.GetConjugate()).Rotate(v).Distance(v) < 1e-12 );
+
+        // interpolation end points
+        TEST( Fabs( Fabs( DotProduct( Quaternion<double>::Slerp(0, a, b), a ) ) - 1 ) < 1e-12 );
+        TEST( Fabs( Fabs( DotProduct( Quaternion<double>::Slerp(1, a, b), b ) ) - 1 ) < 1e-12 );
+        TEST( Fabs( Fabs( DotProduct( Quaternion<double>::Nlerp(1, a, b), b ) ) - 1 ) < 1e-12 );
+
+        // slerp moves at constant angular speed: half way splits the angle evenly
+        const Quaternion<double> h = Quaternion<double>::Slerp(0.5, a, b);
+        TEST( Fabs( Fabs( DotProduct(a, h) ) - Fabs( DotProduct(h, b) ) ) < 1e-12 );
+        TEST( Fabs( h.Length() - 1 ) < 1e-12 );
+    }
+
+    // batch forms agree with the single ones
+    const size_t count = 40;
+    std::vector< Quaternion<double> > a, b, r( count ), er( count ), nr( count );
+    std::vector< double > t;
+    for (size_t n=0;n!=count;++n)
+    {
+        a.push_back( RandomRotation() );
+        b.push_back( n==0 ? a.back() : RandomRotation() );
+        t.push_back( RandomFloat(0,1) );
+    }
+    Slerp( t.data(), a.data(), b.data(), r.data(), count );
+    Slerp<accuracy_exact>( t.data(), a.data(), b.data(), er.data(), count );
+    Nlerp( t.data(), a.data(), b.data(), nr.data(), count );
+    for (size_t n=0;n!=count;++n)
+    {
+        TEST( r[n].Distance( Quaternion<double>::Slerp( t[n], a[n], b[n] ) ) < 1e-7 );
+        const Quaternion<double> s = Quaternion<double>::Slerp( t[n], a[n], b[n] );
+        for (size_t i=0;i!=4;++i)
+            TEST( Fabs( er[n][i] - s[i] ) < 1e-14 );
+        TEST( nr[n].Distance( Quaternion<double>::Nlerp( t[n], a[n], b[n] ) ) < 1e-12 );
+    }
+
+    Flush("TestQuaternion");
+}
+
+Affine3<double> RandomAffine()
+{
+    Affine3<double> result( RandomRotation().GetMatrix() );
+    result.SetTranslation( Vector3d<double>( RandomFloat(-5,5), RandomFloat(-5,5), RandomFloat(-5,5) ) );
+    return result;
+}
+
+void TestAffine3()
+{
+    const Vector3d<double> p(1,2,3);
+    TEST( Affine3<double>().TransformPoint(p) == p );
+    TEST( Affine3<double>().GetMatrix4() == Matrix4<double>::Identity() );
+
+    // translation matches Matrix4
+    const Affine3<double> t = Affine3<double>::Translation( Vector3d<double>(4,5,6) );
+    const Matrix4<double> mt = Matrix4<double>::Translation( Vector3d<double>(4,5,6) );
+    TEST( t.GetMatrix4() == mt );
+    TEST( t.TransformPoint(p) == Vector3d<double>(5,7,9) );
+    TEST( t.TransformDirection(p) == p );
+
+    srand(6);
+    for (int n=0;n!=50;++n)
+    {
+        Affine3<double> a = RandomAffine();
+        const Affine3<double> b = RandomAffine();
+        // add some scale and shear so the general inverse is exercised
+        a[0][1] += 0.5;
+        a[2][2] *= 3;
+
+        // lossless round trip and same algebra as Matrix4
+        TEST( Affine3<double>( a.GetMatrix4() ) == a );
+        const Matrix4<double> ab = a.GetMatrix4()*b.GetMatrix4();
+        TEST( (a*b).GetMatrix4().Equals( ab, 1e-20 ) );
+        const VectorN<double,3> mp = a.GetMatrix4() * VectorN<double,3>(p);
+        TEST( a.TransformPoint(p).Distance( mp ) < 1e-12 );
+
+        TEST( (a*a.GetInverse()).GetMatrix4().Equals( Matrix4<double>::Identity(), 1e-20 ) );
+        TEST( (b*b.GetRigidInverse()).GetMatrix4().Equals( Matrix4<double>::Identity(), 1e-20 ) );
+        TEST( b.GetRigidInverse().GetMatrix4().Equals( b.GetInverse().GetMatrix4(), 1e-20 ) );
+
+        // the transformed box holds every transformed corner
+        const AxisAlignedBoundingBox3d<double> box( Vector3d<double>(-1,-2,-3), Vector3d<double>(1,2,3) );
+        const AxisAlignedBoundingBox3d<double> tbox = a.TransformBounds( box );
+        for (int c=0;c!=8;++c)
+        {
+            const Vector3d<double> corner(
+                (c&1) ? 1 : -1, (c&2) ? 2 : -2, (c&4) ? 3 : -3 );
+            const Vector3d<double> tc = a.TransformPoint( corner );
+            for (int d=0;d!=3;++d)
+                TEST( tc[d] >= tbox.GetMinBound()[d]-1e-12 && tc[d] <= tbox.GetMaxBound()[d]+1e-12 );
+        }
+    }
+
+    // the max bound stays exclusive, a corner landing on it is still inside
+    const AxisAlignedBoundingBox3d<double> unit( Vector3d<double>(0,0,0), Vector3d<double>(1,1,1) );
+    const Affine3<double> shift = Affine3<double>::Translation( Vector3d<double>(0.5,2,-3) );
+    TEST( shift.TransformBounds( unit ).Contains( shift.TransformPoint( Vector3d<double>(1,1,1) ) ) );
+
+    Affine3<double> batch[3] = { RandomAffine(), RandomAffine(), RandomAffine() };
+    Affine3<double> other[3] = { RandomAffine(), RandomAffine(), RandomAffine() };
+    Affine3<double> result[3];
+    Multiply( batch, other, result, 3 );
+    TEST( result[2] == batch[2]*other[2] );
+
+    // rotation builders write straight into the affine type
+    Affine3<double> rotations[2];
+    const double angles[2] = { 0.5, 1.5 };
+    const VectorN<double,3> axes[2] = { VectorN<double,3>({0,0,1}), VectorN<double,3>({1,0,0}) };
+    Matrix4<double>::RotationAround( axes, angles, rotations, 2 );
+    TEST( rotations[1].GetMatrix4().Equals( Matrix4<double>::RotationAroundX(1.5), 1e-20 ) );
+
+    Flush("TestAffine3");
+}
+
+void TestTransformHierarchy()
+{
+    typedef TransformHierarchy<double> Hierarchy;
+    Hierarchy h;
+
+    // two trees, added out of depth first order:
+    //   0 -> 1 -> 3
+    //     -> 4
+    //   2 -> 5
+    const Hierarchy::BoundsType unit( Vector3d<double>(-1,-1,-1), Vector3d<double>(1,1,1) );
+    const Hierarchy::IndexType a = h.AddNode( Hierarchy::sNone, Matrix4<double>::Translation( Vector3d<double>(10,0,0) ) );
+    const Hierarchy::IndexType b = h.AddNode( a, Matrix4<double>::RotationAroundZ(0.5) );
+    const Hierarchy::IndexType c = h.AddNode( Hierarchy::sNone, Matrix4<double>::Translation( Vector3d<double>(0,5,0) ) );
+    const Hierarchy::IndexType d = h.AddNode( b, Matrix4<double>::Translation( Vector3d<double>(1,2,3) ), unit );
+    const Hierarchy::IndexType e = h.AddNode( a, Matrix4<double>() );
+    const Hierarchy::IndexType f = h.AddNode( c, Matrix4<double>::Translation( Vector3d<double>(0,0,1) ), unit );
+    TEST( h.GetNodeCount()==6 );
+    TEST( h.GetParent(d)==b );
+
+    std::vector< Hierarchy::RangeType > ranges;
+    h.GatherDirtyRanges( ranges );
+    TEST( ranges.size()==2 );
+    TEST( ranges[0]==Hierarchy::RangeType(0,4) );
+    TEST( ranges[1]==Hierarchy::RangeType(4,6) );
+    TEST( h.GetNodeAtSlot(1)==b && h.GetNodeAtSlot(2)==d && h.GetNodeAtSlot(3)==e );
+    for (const auto& r : ranges)
+        h.UpdateRange( r );
+
+    const Matrix4<double> dw = h.GetLocal(d) * h.GetLocal(b) * h.GetLocal(a);
+    TEST( h.GetWorld(d).Equals( dw, 1e-20 ) );
+    TEST( h.GetWorld(e) == h.GetWorld(a) );
+    TEST( h.GetWorldBounds(f).Contains( Vector3d<double>(0,5,1) ) );
+    TEST( !h.GetWorldBounds(f).Contains( Vector3d<double>(0,0,0) ) );
+
+    // clean hierarchy has nothing to do
+    h.GatherDirtyRanges( ranges );
+    TEST( ranges.empty() );
+
+    // touching b only recomputes b's subtree
+    h.SetLocal( b, Matrix4<double>::RotationAroundZ(1.0) );
+    h.SetLocal( d, Matrix4<double>::Translation( Vector3d<double>(3,2,1) ) );
+    h.GatherDirtyRanges( ranges );
+    TEST( ranges.size()==1 );
+    TEST( ranges[0]==Hierarchy::RangeType(1,3) );
+    h.Update();
+    const Matrix4<double> dw2 = h.GetLocal(d) * h.GetLocal(b) * h.GetLocal(a);
+    TEST( h.GetWorld(d).Equals( dw2, 1e-20 ) );
+    const VectorN<double,3> origin = h.GetWorld(d) * VectorN<double,3>({0,0,0});
+    TEST( h.GetWorldBounds(d).Contains( origin ) );
+
+    // adding a node re-sorts, old ids stay valid
+    const Hierarchy::IndexType g = h.AddNode( c, Matrix4<double>::Translation( Vector3d<double>(0,0,7) ) );
+    h.Update();
+    TEST( h.GetWorld(d).Equals( dw2, 1e-20 ) );
+    const Matrix4<double> gw = h.GetLocal(g) * h.GetLocal(c);
+    TEST( h.GetWorld(g) == gw );
+    TEST( h.GetWorldMatrices().size()==7 );
+
+    Flush("TestTransformHierarchy");
+}
+
+void TestParallel()
+{
+    srand(34);
+    ThreadPool pool(4);
+    ThreadPool single(1);
+    const ExecutionPolicy par( pool, 100 );
+    const ExecutionPolicy sequential = ExecutionPolicy::Sequential().WithGrain(100);
+    TEST( pool.GetThreadCount()==4 );
+    TEST( par.IsParallel() && !sequential.IsParallel() );
+
+    // every index visited exactly once, including a ragged last chunk
+    std::vector< std::atomic<int> > visits(1037);
+    for (auto& v : visits) v = 0;
+    ParallelFor( par, 0, visits.size(), [&](size_t begin, size_t end) {
+        for (size_t i=begin;i!=end;++i) ++visits[i];
+    } );
+    bool once = true;
+    for (auto& v : visits) once = once && v==1;
+    TEST( once );
+
+    // nested loops run on the same pool without deadlocking
+    std::atomic<int> inner(0);
+    ParallelFor( par.WithGrain(1), 0, 8, [&](size_t, size_t) {
+        ParallelFor( par.WithGrain(10), 0, 100, [&](size_t begin, size_t end) { inner += int(end-begin); } );
+    } );
+    TEST( inner==800 );
+
+    // an exception in any chunk reaches the caller, and the pool still runs
+    // work afterwards, so its pending count wasn't left wrapped or stuck
+    for (int n=0;n!=20;++n)
+    {
+        bool caught = false;
+        try
+        {
+            ParallelFor( par.WithGrain(1), 0, 64, [&](size_t begin, size_t) {
+                if (begin==size_t(n)) throw std::runtime_error("chunk");
+            } );
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+        TEST( caught );
+    }
+    std::atomic<int> after(0);
+    ParallelFor( par.WithGrain(1), 0, 64, [&](size_t, size_t) { ++after; } );
+    TEST( after==64 );
+
+    // float sums come out bit identical whatever runs the chunks
+    std::vector<float> values(10000);
+    for (auto& v : values) v = RandomFloat(-1000,1000);
+    auto sum = [&](const ExecutionPolicy& policy) {
+        return ParallelReduce( policy, 0, values.size(), 0.0f,
+            [&](size_t begin, size_t end) { float s = 0; for (size_t i=begin;i!=end;++i) s += values[i]; return s; },
+            [](float a, float b) { return a + b; } );
+    };
+    const float reference = sum( sequential );
+    TEST( sum( par )==reference );
+    TEST( sum( ExecutionPolicy( single, 100 ) )==reference );
+    TEST( ParallelReduce( par, 5, 5, 7, [](size_t, size_t) { return 0; }, [](int a, int b) { return a+b; } )==7 );
+
+    // mesh batches
+    IndexedMesh<float> mesh;
+    for (int v=0;v!=3000;++v)
+        mesh.AddVertex( Vector3d<float>( RandomFloat(-10,10), RandomFloat(-10,10), RandomFloat(-10,10) ) );
+    for (int f=0;f!=2998;++f)
+        mesh.AddFace( f, f+1, f+2 );
+    TEST( mesh.GetBounds( par ).GetMinBound()==mesh.GetBounds().GetMinBound() );
+    TEST( mesh.GetBounds( par ).GetMaxBound()==mesh.GetBounds().GetMaxBound() );
+    TEST( mesh.GetSurfaceArea( par )==mesh.GetSurfaceArea( sequential ) );
+    TEST( Abs( mesh.GetSurfaceArea( par ) - mesh.GetSurfaceArea() ) < mesh.GetSurfaceArea()*1e-5f );
+    std::vector< Vector3d<float> > normals, parallelNormals;
+    mesh.ComputeFaceNormals( normals );
+    mesh.ComputeFaceNormals( parallelNormals, par );
+    TEST( normals==parallelNormals );
+
+    // batch transforms
+    std::vector< Affine3<double> > lhs(500), rhs(500), product(500);
+    for (size_t i=0;i!=lhs.size();++i)
+    {
+        lhs[i] = RandomAffine();
+        rhs[i] = RandomAffine();
+    }
+    Multiply( lhs.data(), rhs.data(), product.data(), product.size(), par );
+    bool same = true;
+    for (size_t i=0;i!=lhs.size();++i)
+        same = same && product[i]==lhs[i]*rhs[i];
+    TEST( same );
+
+    // hierarchy of many small trees
+    TransformHierarchy<double> h, hp;
+    for (int i=0;i!=300;++i)
+    {
+        const Matrix4<double> m = Matrix4<double>::RotationAroundZ( RandomFloat(-3,3) );
+        const TransformHierarchy<double>::IndexType parent = i%3==0 ? TransformHierarchy<double>::sNone : i-1;
+        h.AddNode( parent, m );
+        hp.AddNode( parent, m );
+    }
+    h.Update();
+    hp.Update( par );
+    TEST( h.GetWorldMatrices()==hp.GetWorldMatrices() );
+
+    Flush("TestParallel");
+}
+
+void TestArena()
+{
+    Arena arena( 1024 );
+    TEST( arena.GetBlockCount()==0 );
+
+    char* c = static_cast<char*>( arena.Allocate( 3, 1 ) );
+    double* d = arena.AllocateArray<double>( 10 );
+    TEST( c!=nullptr && reinterpret_cast<uintptr_t>(d)%alignof(double)==0 );
+    TEST( arena.GetBlockCount()==1 );
+
+    // oversized requests get a block of their own
+    arena.Allocate( 4000 );
+    TEST( arena.GetBlockCount()==2 );
+    const size_t capacity = arena.GetCapacity();
+
+    // reset rewinds, the same pattern again needs no new blocks
+    arena.Reset();
+    TEST( arena.GetBytesUsed()==0 );
+    TEST( static_cast<char*>( arena.Allocate( 3, 1 ) )==c );
+    TEST( arena.AllocateArray<double>( 10 )==d );
+    arena.Allocate( 4000 );
+    TEST( arena.GetCapacity()==capacity );
+
+    arena.Release();
+    TEST( arena.GetBlockCount()==0 && arena.GetBytesUsed()==0 );
+
+    // caller's buffer first, heap after
+    alignas(std::max_align_t) char buffer[256];
+    Arena local( buffer, sizeof(buffer), 512 );
+    int* i = local.AllocateArray<int>( 16 );
+    TEST( reinterpret_cast<char*>(i)==buffer );
+    TEST( local.GetBlockCount()==0 );
+    local.AllocateArray<int>( 100 );
+    TEST( local.GetBlockCount()==1 );
+    local.Reset();
+    TEST( local.AllocateArray<int>( 16 )==i );
+
+    // containers
+    {
+        ArenaVector<int> v( (ArenaAllocator<int>( arena )) );
+        for (int n=0;n!=1000;++n) v.push_back( n );
+        TEST( v[999]==999 );
+    }
+
+    // AABB functions, against their heap allocating forms
+    typedef AxisAlignedBoundingBox3d<int> Box;
+    const Box a( Vector3d<int>(2,2,2), Vector3d<int>(8,8,8) );
+    const Box b( Vector3d<int>(0,0,0), Vector3d<int>(10,10,10) );
+    std::vector<Box> expected;
+    auto ii = std::back_inserter( expected );
+    AABB_Difference( a, b, ii );
+    arena.Reset();
+    const ArenaVector<Box> difference = AABB_Difference( a, b, arena );
+    TEST( difference.size()==expected.size() && difference.size()==6 );
+    bool same = true;
+    for (size_t n=0;n!=expected.size();++n)
+        same = same && difference[n].GetMinBound()==expected[n].GetMinBound()
+            && difference[n].GetMaxBound()==expected[n].GetMaxBound();
+    TEST( same );
+
+    const size_t blocks = arena.GetBlockCount();
+    std::vector< LineN< VectorN<int,3> > > edges;
+    auto ei = std::back_inserter( edges );
+    AABB_GatherEdges( AxisAlignedBoundingBox< VectorN<int,3> >( a.GetMinBound(), a.GetMaxBound() ), ei, arena );
+    TEST( edges.size()==12 );
+    TEST( arena.GetBlockCount()==blocks );
+
+    Flush("TestArena");
+}
+
+MatrixX<double> RandomMatrixX(size_t rows, size_t columns)
+{
+    MatrixX<double> result( rows, columns );
+    for (size_t n=0;n!=rows;++n)
+        for (size_t m=0;m!=columns;++m)
+            result[n][m] = RandomFloat(-1,1);
+    return result;
+}
+
+void TestMatrixX()
+{
+    srand(37);
+
+    // blocked multiply sums every element in the same order as the textbook loop
+    const MatrixX<double> a = RandomMatrixX( 70, 53 );
+    const MatrixX<double> b = RandomMatrixX( 53, 97 );
+    MatrixX<double> naive( 70, 97 );
+    for (size_t n=0;n!=70;++n)
+        for (size_t m=0;m!=97;++m)
+            for (size_t k=0;k!=53;++k)
+                naive[n][m] += a[n][k] * b[k][m];
+    const MatrixX<double> ab = a * b;
+    TEST( ab.GetRows()==70 && ab.GetColumns()==97 );
+    TEST( ab==naive );
+
+    ThreadPool pool(3);
+    MatrixX<double> parallel;
+    Multiply( a, b, parallel, ExecutionPolicy( pool ) );
+    TEST( parallel==ab );
+    TEST( a.GetTranspose().GetTranspose()==a );
+    TEST( a.GetTranspose()[5][7]==a[7][5] );
+
+    // the fixed size types convert both ways, products agree
+    const Matrix4<double> r = Matrix4<double>::RotationAroundZ(0.3);
+    const Matrix4<double> t = Matrix4<double>::Translation( Vector3d<double>(1,2,3) );
+    const MatrixNM<double,4,4> rt = r * t;
+    TEST( MatrixX<double>( r ) * MatrixX<double>( t )==MatrixX<double>( rt ) );
+    Matrix4<double> back(uninitialised);
+    MatrixX<double>( rt ).ComputeFixed( back );
+    TEST( back==rt );
+    const VectorX<double> v( VectorN<double,3>({1,2,3}) );
+    TEST( v.GetSize()==3 && v[2]==3 && v.Length()==Sqrt(14.0) );
+    const VectorN<double,4> p4({1,2,3,1});
+    VectorN<double,4> rtp4(uninitialised);
+    (MatrixX<double>( rt ) * VectorX<double>( p4 )).ComputeFixed( rtp4 );
+    TEST( rtp4.DistanceSquare( back * p4 ) < 1e-24 );
+    VectorX<double> column;
+    MultiplyColumn( MatrixX<double>( rt ).GetTranspose(), VectorX<double>( p4 ), column );
+    TEST( column==MatrixX<double>( rt ) * VectorX<double>( p4 ) );
+
+    // LU
+    const MatrixX<double> m3( 3, 3, { 2,1,1, 4,-6,0, -2,7,2 } );
+    const LUDecomposition<double> lu3( m3 );
+    TEST( !lu3.IsSingular() );
+    TEST( Abs( lu3.GetDeterminant() + 16 ) < 1e-12 );
+    const VectorX<double> x3 = lu3.GetSolution( VectorX<double>({ 5,-2,9 }) );
+    TEST( x3.DistanceSquare( VectorX<double>({ 1,1,2 }) ) < 1e-24 );
+    TEST( LUDecomposition<double>( MatrixX<double>( 2, 2, { 1,2, 2,4 } ) ).IsSingular() );
+
+    const MatrixX<double> big = RandomMatrixX( 200, 200 );
+    VectorX<double> rhs( 200 );
+    for (size_t i=0;i!=200;++i) rhs[i] = RandomFloat(-1,1);
+    const LUDecomposition<double> lu( big );
+    const VectorX<double> x = lu.GetSolution( rhs );
+    VectorX<double> bigX;
+    MultiplyColumn( big, x, bigX );
+    TEST( bigX.DistanceSquare( rhs ) < 1e-20 );
+    const LUDecomposition<double> luParallel( big, ExecutionPolicy( pool ) );
+    TEST( luParallel.GetSolution( rhs )==x );
+    MatrixX<double> inverse;
+    lu3.ComputeInverse( inverse );
+    TEST( (m3 * inverse).Equals( MatrixX<double>::Identity(3), 1e-24 ) );
+
+    // Cholesky on a^T a + I, which is symmetric positive definite
+    MatrixX<double> spd = big.GetTranspose() * big;
+    spd += MatrixX<double>::Identity( 200 );
+    const CholeskyDecomposition<double> cholesky( spd );
+    TEST( cholesky.IsPositiveDefinite() );
+    const MatrixX<double>& l = cholesky.GetLower();
+    TEST( (l * l.GetTranspose()).Equals( spd, 1e-16 ) );
+    TEST( (spd * cholesky.GetSolution( rhs )).DistanceSquare( rhs ) < 1e-20 );
+    const CholeskyDecomposition<double> choleskyParallel( spd, ExecutionPolicy( pool ) );
+    TEST( choleskyParallel.GetLower()==l );
+    TEST( !CholeskyDecomposition<double>( MatrixX<double>( 2, 2, { 1,2, 2,1 } ) ).IsPositiveDefinite() );
+
+    // least squares line fit through exact points recovers the line
+    MatrixX<double> design( 20, 2 );
+    VectorX<double> ys( 20 ), fit;
+    for (size_t i=0;i!=20;++i)
+    {
+        design[i][0] = double(i);
+        design[i][1] = 1;
+        ys[i] = 3*double(i) - 2;
+    }
+    TEST( ComputeLeastSquares( design, ys, fit ) );
+    TEST( fit.DistanceSquare( VectorX<double>({ 3,-2 }) ) < 1e-20 );
+
+    Flush("TestMatrixX");
+}
+
+void TestMatrixChain()
+{
+    srand(38);
+
+    // the textbook example, (ab)c does a tenth of the work of a(bc)
+    typedef MatrixChain<10,30,5,60> Chain3;
+    static_assert( Chain3::GetCost()==4500, "chain order is solved at compile time" );
+    TEST( Chain3::sOrder.mSplit[0][2]==1 );
+    TEST( Chain3::GetLeftToRightCost()==4500 );
+    typedef MatrixChain<50,10,40,30,5> Chain4;
+    TEST( Chain4::GetCost()==10500 );
+    TEST( Chain4::GetCost() < Chain4::GetLeftToRightCost() );
+
+    MatrixNM<double,2,3> a(uninitialised);
+    MatrixNM<double,3,4> b(uninitialised);
+    MatrixNM<double,4,1> c(uninitialised);
+    MatrixNM<double,1,5> d(uninitialised);
+    for (size_t i=0;i!=6;++i) a[0][i] = RandomFloat(-1,1);
+    for (size_t i=0;i!=12;++i) b[0][i] = RandomFloat(-1,1);
+    for (size_t i=0;i!=4;++i) c[0][i] = RandomFloat(-1,1);
+    for (size_t i=0;i!=5;++i) d[0][i] = RandomFloat(-1,1);
+    const MatrixNM<double,2,5> abcd = MultiplyChain( a, b, c, d );
+    const MatrixX<double> expected = MatrixX<double>( a ) * MatrixX<double>( b )
+        * MatrixX<double>( c ) * MatrixX<double>( d );
+    TEST( MatrixX<double>( abcd ).Equals( expected, 1e-24 ) );
+
+    // square chains take derived types and agree with operator*
+    const Matrix4<double> r = Matrix4<double>::RotationAroundZ(0.3);
+    const Matrix4<double> t = Matrix4<double>::Translation( Vector3d<double>(1,2,3) );
+    const MatrixNM<double,4,4> rtr = MultiplyChain( r, t, r );
+    const MatrixNM<double,4,4> rt = r * t;
+    TEST( rtr.Equals( rt * r, 1e-24 ) );
+
+    // Strassen-Winograd against the blocked multiply, even and padded sizes
+    ThreadPool pool(3);
+    for (size_t n : { 64, 150 })
+    {
+        const MatrixX<double> lhs = RandomMatrixX( n, n );
+        const MatrixX<double> rhs = RandomMatrixX( n, n );
+        const MatrixX<double> product = lhs * rhs;
+        MatrixX<double> strassen;
+        MultiplyStrassen( lhs, rhs, strassen, 16 );
+        TEST( strassen.GetRows()==n && strassen.GetColumns()==n );
+        TEST( strassen.Equals( product, 1e-18 ) );
+        MatrixX<double> parallel;
+        MultiplyStrassen( lhs, rhs, parallel, 16, ExecutionPolicy( pool ) );
+        TEST( parallel==strassen );
+    }
+    MatrixX<double> small;
+    const MatrixX<double> s = RandomMatrixX( 20, 20 );
+    MultiplyStrassen( s, s, small );
+    TEST( small==s * s );
+
+    Flush("TestMatrixChain");
+}
+
+void TestBinaryFile()
+{
+    srand(39);
+    const char* path = "test/binary_file.tmp";
+
+    std::vector< Vector3d<float> > points;
+    std::vector< AxisAlignedBoundingBox3d<double> > boxes;
+    std::vector< Triangle3d<float> > triangles;
+    std::vector< VectorN<int,2> > pairs;
+    for (int i=0;i!=1000;++i)
+    {
+        const Vector3d<float> p( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) );
+        points.push_back( p );
+        boxes.push_back( AxisAlignedBoundingBox3d<double>( Vector3d<double>( p ) ) );
+        boxes.back().ExpandToContain( Vector3d<double>( 2, 2, 2 ) );
+        triangles.push_back( Triangle3d<float>( p, Vector3d<float>( p+p ), Vector3d<float>( p+p+p ) ) );
+        pairs.push_back( VectorN<int,2>({ i, -i }) );
+    }
+
+    BinaryWriter writer;
+    writer.AddArray( "points", points );
+    writer.AddArray( "boxes", boxes );
+    writer.AddArray( "triangles", triangles );
+    writer.AddArray( "pairs", pairs );
+    writer.AddArray( "empty", points.data(), 0 );
+    TEST( writer.GetSectionCount()==5 );
+    TEST( writer.Write( path ) );
+
+    BinaryReader reader;
+    TEST( reader.Open( path ) );
+    TEST( reader.IsNativeEndian() && reader.GetVersion()==BinaryWriter::sVersion );
+    TEST( reader.GetSectionCount()==5 );
+    TEST( reader.FindSection( "boxes" )==1 );
+    TEST( reader.FindSection( "missing" )==BinaryReader::sNoSection );
+    TEST( reader.GetSection( 2 ).mCount==1000 && reader.GetSection( 2 ).mDimension==3 );
+
+    // arrays come back in place, aligned, under their own or their base type
+    const ArraySpan< const Vector3d<float> > mappedPoints = reader.GetArray< Vector3d<float> >( 0 );
+    TEST( mappedPoints.GetSize()==1000 );
+    TEST( reinterpret_cast<uintptr_t>( mappedPoints.GetData() ) % BinaryWriter::sAlignment==0 );
+    TEST( std::equal( mappedPoints.begin(), mappedPoints.end(), points.begin() ) );
+    typedef VectorN<float,3> Vector3f;
+    TEST( reader.GetArray<Vector3f>( 0 ).GetSize()==1000 );
+    const ArraySpan< const AxisAlignedBoundingBox3d<double> > mappedBoxes = reader.GetArray< AxisAlignedBoundingBox3d<double> >( 1 );
+    TEST( mappedBoxes[999].GetMinBound()==boxes[999].GetMinBound() && mappedBoxes[999].GetMaxBound()==boxes[999].GetMaxBound() );
+    const ArraySpan< const Triangle3d<float> > mappedTriangles = reader.GetArray< Triangle3d<float> >( 2 );
+    TEST( mappedTriangles.GetSize()==1000 && mappedTriangles[500].GetC()==triangles[500].GetC() );
+    typedef VectorN<int,2> Vector2i;
+    TEST( reader.GetArray<Vector2i>( 3 )[7]==pairs[7] );
+    TEST( reader.GetArray< Vector3d<float> >( 4 ).IsEmpty() && reader.Holds< Vector3d<float> >( 4 ) );
+
+    // the wrong type is refused
+    TEST( !reader.Holds< Vector3d<double> >( 0 ) );
+    TEST( reader.GetArray< Vector3d<double> >( 0 ).IsEmpty() );
+    TEST( reader.GetArray< Vector3d<float> >( 2 ).IsEmpty() );
+    typedef VectorN<unsigned,2> Vector2u;
+    TEST( reader.GetArray<Vector2u>( 3 ).IsEmpty() );
+    reader.Close();
+    TEST( !reader.IsOpen() );
+
+    // a file from a machine of the other byte order: swap every field and scalar
+    std::vector<unsigned char> bytes;
+    {
+        std::FILE* file = std::fopen( path, "rb" );
+        TEST( file!=nullptr );
+        int c;
+        while ((c = std::fgetc( file ))!=EOF)
+            bytes.push_back( (unsigned char)c );
+        std::fclose( file );
+    }
+    unsigned char* b = bytes.data();
+    std::reverse( b+8, b+12 );
+    std::reverse( b+12, b+16 );
+    std::reverse( b+16, b+24 );
+    std::reverse( b+24, b+32 );
+    for (size_t s=0;s!=5;++s)
+    {
+        BinarySection section;
+        std::memcpy( &section, b + 64 + s*sizeof(BinarySection), sizeof(section) );
+        const size_t scalar = section.mScalar & 0xff;
+        for (size_t i=0;i!=section.mCount*section.mElementSize;i+=scalar)
+            std::reverse( b+section.mOffset+i, b+section.mOffset+i+scalar );
+        unsigned char* entry = b + 64 + s*sizeof(BinarySection);
+        for (size_t f=0;f!=4;++f)
+            std::reverse( entry+f*4, entry+f*4+4 );
+        std::reverse( entry+16, entry+24 );
+        std::reverse( entry+24, entry+32 );
+    }
+    {
+        std::FILE* file = std::fopen( path, "wb" );
+        std::fwrite( bytes.data(), 1, bytes.size(), file );
+        std::fclose( file );
+    }
+    TEST( reader.Open( path ) );
+    TEST( !reader.IsNativeEndian() );
+    TEST( reader.GetArray< Vector3d<float> >( 0 ).IsEmpty() );
+    std::vector< Vector3d<float> > swappedPoints;
+    TEST( reader.ComputeArray( 0, swappedPoints ) );
+    TEST( swappedPoints==points );
+    std::vector< AxisAlignedBoundingBox3d<double> > swappedBoxes;
+    TEST( reader.ComputeArray( 1, swappedBoxes ) && swappedBoxes[3].GetMaxBound()==boxes[3].GetMaxBound() );
+    reader.Close();
+
+    // a section table overlapping the header, truncated and foreign files are refused
+    {
+        std::vector<unsigned char> overlapping( bytes );
+        std::fill( overlapping.begin()+16, overlapping.begin()+32, (unsigned char)0 );
+        std::FILE* file = std::fopen( path, "wb" );
+        std::fwrite( overlapping.data(), 1, overlapping.size(), file );
+        std::fclose( file );
+    }
+    TEST( !reader.Open( path ) );
+    {
+        std::FILE* file = std::fopen( path, "wb" );
+        std::fwrite( bytes.data(), 1, 200, file );
+        std::fclose( file );
+    }
+    TEST( !reader.Open( path ) );
+    {
+        std::FILE* file = std::fopen( path, "wb" );
+        std::fputs( "not a geometry file, though long enough to hold a header of sixty four bytes", file );
+        std::fclose( file );
+    }
+    TEST( !reader.Open( path ) );
+    TEST( !reader.Open( "test/does_not_exist.tmp" ) );
+    std::remove( path );
+
+    Flush("TestBinaryFile");
+}
+
+// reads the whole cloud, checking each chunk's bounds against its points
+bool ReadPointCloud(const char* path, size_t chunkBytes, const ExecutionPolicy& policy,
+    std::vector< Vector3d<float> >& points, size_t& chunkCount, bool& boundsExact)
+{
+    PointCloudReader<float> reader( chunkBytes );
+    if (!reader.Open( path ))
+        return false;
+    points.clear();
+    chunkCount = 0;
+    boundsExact = true;
+    return reader.Read( [&](const PointCloudChunk<float>& chunk) {
+        boundsExact &= chunk.GetFirstPoint()==points.size();
+        // as the incremental loop the reader replaces would have found them
+        AxisAlignedBoundingBox3d<float> bounds( chunk.GetPoint(0) );
+        points.push_back( chunk.GetPoint(0) );
+        for (size_t i=1;i!=chunk.GetSize();++i)
+        {
+            points.push_back( chunk.GetPoint(i) );
+            bounds.ExpandToContain( chunk.GetPoint(i) );
+        }
+        boundsExact &= bounds.GetMinBound()==chunk.GetBounds().GetMinBound()
+            && bounds.GetMaxBound()==chunk.GetBounds().GetMaxBound();
+        ++chunkCount;
+    }, policy );
+}
+
+void TestPointCloudReader()
+{
+    srand(40);
+    const char* path = "test/point_cloud.tmp";
+
+    // both paths round as strtod does in the C locale
+    const char* numbers[] = { "1.5e3", "-0.125", "3.14159265358979", "0.1", "1e-5", "123456789012345678901234",
+        "2.2250738585072014e-308", "+7", "9007199254740993", ".5", "-0", "6.02214076e23",
+        "+123456789012345678901234", "+1e300", "1e400", "-1e-400" };
+    for (const char* n : numbers)
+    {
+        const char* cursor = n;
+        double value;
+        TEST( ParseDouble( cursor, n+std::strlen(n), value ) && *cursor==0 && value==std::strtod( n, nullptr ) );
+    }
+    const char* notNumber = "x1";
+    const char* cursor = notNumber;
+    double value;
+    TEST( !ParseDouble( cursor, notNumber+2, value ) && cursor==notNumber );
+
+    std::vector< Vector3d<float> > expected;
+    for (size_t i=0;i!=5000;++i)
+        expected.push_back( Vector3d<float>( RandomFloat(-100,100), RandomFloat(-100,100), RandomFloat(-1,1) ) );
+
+    ThreadPool pool(3);
+    std::vector< Vector3d<float> > points;
+    size_t chunks;
+    bool exact;
+
+    // xyz with extra columns, comments, blank lines and a missing final newline
+    {
+        std::FILE* file = std::fopen( path, "wb" );
+        std::fprintf( file, "# x y z intensity\n" );
+        for (size_t i=0;i!=expected.size();++i)
+        {
+            std::fprintf( file, "%.9g %.9g,%.9g %d%s", expected[i][0], expected[i][1], expected[i][2], int(i),
+                i+1==expected.size() ? "" : i%1000==0 ? "\r\n\n" : "\n" );
+        }
+        std::fclose( file );
+    }
+    TEST( ReadPointCloud( path, 4096, ExecutionPolicy(), points, chunks, exact ) );
+    TEST( points==expected && chunks>10 && exact );
+    TEST( ReadPointCloud( path, 4096, ExecutionPolicy( pool ), points, chunks, exact ) );
+    TEST( points==expected && exact );
+
+    // ascii ply with x y z not first and faces after the vertices
+    {
+        std::FILE* file = std::fopen( path, "wb" );
+        std::fprintf( file, "ply\nformat ascii 1.0\ncomment test\nelement vertex %d\nproperty uchar red\n"
+            "property float x\nproperty float y\nproperty float z\nelement face 2\n"
+            "property list uchar int vertex_indices\nend_header\n", int(expected.size()) );
+        for (const auto& p : expected)
+            std::fprintf( file, "255 %.9g %.9g %.9g\n", p[0], p[1], p[2] );
+        std::fprintf( file, "3 0 1 2\n3 2 3 4\n" );
+        std::fclose( file );
+    }
+    PointCloudReader<float> plyReader;
+    TEST( plyReader.Open( path ) );
+    TEST( plyReader.GetFormat()==PointCloudFormat::plyAscii && plyReader.GetDeclaredCount()==expected.size() );
+    plyReader.Close();
+    TEST( ReadPointCloud( path, 4096, ExecutionPolicy( pool ), points, chunks, exact ) );
+    TEST( points==expected && exact );
+
+    // binary ply in the other byte order from this machine, mixed property types
+    const uint16_t probe = 1;
+    const bool little = *reinterpret_cast<const unsigned char*>( &probe )==1;
+    {
+        std::FILE* file = std::fopen( path, "wb" );
+        std::fprintf( file, "ply\nformat %s 1.0\nelement vertex %d\nproperty double x\nproperty short flags\n"
+            "property float y\nproperty float z\nend_header\n", little ? "binary_big_endian" : "binary_little_endian",
+            int(expected.size()) );
+        for (const auto& p : expected)
+        {
+            unsigned char vertex[18];
+            const double x = p[0];
+            const int16_t flags = 7;
+            const float y = p[1], z = p[2];
+            std::memcpy( vertex, &x, 8 );
+            std::memcpy( vertex+8, &flags, 2 );
+            std::memcpy( vertex+10, &y, 4 );
+            std::memcpy( vertex+14, &z, 4 );
+            std::reverse( vertex, vertex+8 );
+            std::reverse( vertex+8, vertex+10 );
+            std::reverse( vertex+10, vertex+14 );
+            std::reverse( vertex+14, vertex+18 );
+            std::fwrite( vertex, 1, sizeof(vertex), file );
+        }
+        std::fclose( file );
+    }
+    TEST( ReadPointCloud( path, 1000, ExecutionPolicy(), points, chunks, exact ) );
+    TEST( points==expected && chunks==91 && exact );
+    TEST( ReadPointCloud( path, 1000, ExecutionPolicy( pool ), points, chunks, exact ) );
+    TEST( points==expected && exact );
+
+    // a bad line fails the read, a truncated binary file too
+    {
+        std::FILE* file = std::fopen( path, "wb" );
+        std::fprintf( file, "1 2 3\n4 5\n7 8 9\n" );
+        std::fclose( file );
+    }
+    TEST( !ReadPointCloud( path, 4096, ExecutionPolicy(), points, chunks, exact ) );
+    {
+        std::FILE* file = std::fopen( path, "wb" );
+        std::fprintf( file, "ply\nformat binary_little_endian 1.0\nelement vertex 10\nproperty float x\n"
+            "property float y\nproperty float z\nend_header\n" );
+        std::fclose( file );
+    }
+    TEST( !ReadPointCloud( path, 4096, ExecutionPolicy(), points, chunks, exact ) );
+    TEST( !plyReader.Open( "test/does_not_exist.tmp" ) );
+    std::remove( path );
+
+    Flush("TestPointCloudReader");
+}
+
+// the box ExpandToContain builds a point at a time from points[0]
+template< typename AABB, typename Point >
+AABB IncrementalBounds(const std::vector<Point>& points)
+{
+    AABB result( points[0] );
+    for (size_t i=1;i!=points.size();++i)
+        result.ExpandToContain( points[i] );
+    return result;
+}
+
+template< typename AABB >
+bool SameBounds(const AABB& a, const AABB& b)
+{
+    return a.GetMinBound()==b.GetMinBound() && a.GetMaxBound()==b.GetMaxBound();
+}
+
+void TestComputeBounds()
+{
+    srand(41);
+    ThreadPool pool(3);
+    const ExecutionPolicy parallel( pool, 1000 );
+
+    std::vector< Vector3d<float> > points;
+    for (size_t i=0;i!=100000;++i)
+        points.push_back( Vector3d<float>( RandomFloat(-1,1), RandomFloat(-5,5), RandomFloat(0,1) ) );
+    typedef AxisAlignedBoundingBox3d<float> Box3;
+    const Box3 expected = IncrementalBounds<Box3>( points );
+    Box3 box(uninitialised);
+    AABB_ComputeBounds( points.begin(), points.end(), box );
+    TEST( SameBounds( box, expected ) );
+    Box3 parallelBox(uninitialised);
+    AABB_ComputeBounds( points.begin(), points.end(), parallelBox, parallel );
+    TEST( SameBounds( parallelBox, expected ) );
+
+    // the first point alone holds the max, or shares it, or is everything
+    std::vector< Vector3d<float> > edge;
+    edge.push_back( Vector3d<float>( 5, 0, -0.0f ) );
+    edge.push_back( Vector3d<float>( 1, 0, 0.0f ) );
+    edge.push_back( Vector3d<float>( 2, -0.0f, -0.0f ) );
+    AABB_ComputeBounds( edge.begin(), edge.end(), box );
+    TEST( SameBounds( box, IncrementalBounds<Box3>( edge ) ) );
+    TEST( box.GetMaxBound()[0]==5 );
+    edge.push_back( Vector3d<float>( 5, 0, 0 ) );
+    AABB_ComputeBounds( edge.begin(), edge.end(), box, parallel );
+    TEST( SameBounds( box, IncrementalBounds<Box3>( edge ) ) );
+    TEST( box.GetMaxBound()[0] > 5 );
+    AABB_ComputeBounds( edge.begin(), edge.begin()+1, box );
+    TEST( SameBounds( box, Box3( edge[0] ) ) );
+
+    // integers are nudged by one
+    typedef VectorN<int,2> Vector2i;
+    std::vector<Vector2i> grid;
+    for (size_t i=0;i!=10000;++i)
+        grid.push_back( Vector2i({ rand()%1000 - 500, rand()%7 }) );
+    typedef AxisAlignedBoundingBox<Vector2i> Box2i;
+    Box2i gridBox(uninitialised);
+    AABB_ComputeBounds( grid.begin(), grid.end(), gridBox, parallel );
+    TEST( SameBounds( gridBox, IncrementalBounds<Box2i>( grid ) ) );
+
+    Flush("TestComputeBounds");
+}
+
+uint64_t RandomKey()
+{
+    uint64_t key = 0;
+    for (int i=0;i!=4;++i)
+        key = (key << 16) ^ uint64_t(rand() & 0xffff);
+    return key;
+}
+
+void TestSpaceFillingCurve()
+{
+    srand(42);
+
+    TEST( MortonEncode( 1, 0 )==1 && MortonEncode( 0, 1 )==2 && MortonEncode( 3, 0 )==5 );
+    TEST( MortonEncode( 1, 1, 1 )==7 && MortonEncode( 0, 0, 2 )==32 );
+    TEST( MortonEncode( 0x1fffff, 0x1fffff, 0x1fffff )==0x7fffffffffffffffull );
+    bool roundTrip = true;
+    bool adjacent = true;
+    for (int i=0;i!=1000;++i)
+    {
+        const uint32_t x = uint32_t(RandomKey()), y = uint32_t(RandomKey()), z = uint32_t(RandomKey()) & 0x1fffff;
+        uint32_t a, b, c;
+        MortonDecode( MortonEncode( x, y ), a, b );
+        roundTrip &= a==x && b==y;
+        MortonDecode( MortonEncode( x & 0x1fffff, y & 0x1fffff, z ), a, b, c );
+        roundTrip &= a==(x & 0x1fffff) && b==(y & 0x1fffff) && c==z;
+        HilbertDecode( HilbertEncode( x, y ), a, b );
+        roundTrip &= a==x && b==y;
+        HilbertDecode( HilbertEncode( x & 0x1fffff, y & 0x1fffff, z ), a, b, c );
+        roundTrip &= a==(x & 0x1fffff) && b==(y & 0x1fffff) && c==z;
+
+        // consecutive distances along the curve are neighbouring cells
+        const uint64_t key2 = RandomKey() - (i==0 ? 0 : 1);
+        const uint64_t key3 = (RandomKey() >> 1) - (i==0 ? 0 : 1);
+        uint32_t p[3], q[3];
+        HilbertDecode( i==0 ? 0 : key2, p[0], p[1] );
+        HilbertDecode( i==0 ? 1 : key2+1, q[0], q[1] );
+        adjacent &= (p[0]>q[0] ? p[0]-q[0] : q[0]-p[0]) + (p[1]>q[1] ? p[1]-q[1] : q[1]-p[1])==1;
+        HilbertDecode( i==0 ? 0 : key3, p[0], p[1], p[2] );
+        HilbertDecode( i==0 ? 1 : key3+1, q[0], q[1], q[2] );
+        uint32_t manhattan = 0;
+        for (int d=0;d!=3;++d)
+            manhattan += p[d]>q[d] ? p[d]-q[d] : q[d]-p[d];
+        adjacent &= manhattan==1;
+    }
+    TEST( roundTrip );
+    TEST( adjacent );
+
+    // radix sort is stable and the same for any policy
+    ThreadPool pool(3);
+    std::vector<uint64_t> keys;
+    for (size_t i=0;i!=100000;++i)
+        keys.push_back( RandomKey() >> (i%3==0 ? 0 : 40) );
+    std::vector<uint32_t> order( keys.size() );
+    for (size_t i=0;i!=order.size();++i)
+        order[i] = uint32_t(i);
+    std::vector<uint32_t> expected( order );
+    std::stable_sort( expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; } );
+    std::vector<uint32_t> sequentialOrder, parallelOrder;
+    ComputeSortOrder( keys, sequentialOrder );
+    ComputeSortOrder( keys, parallelOrder, ExecutionPolicy( pool, 5000 ) );
+    TEST( sequentialOrder==expected );
+    TEST( parallelOrder==expected );
+    std::vector<uint64_t> sortedKeys( keys );
+    RadixSort( sortedKeys, order, ExecutionPolicy( pool ) );
+    TEST( std::is_sorted( sortedKeys.begin(), sortedKeys.end() ) && order==expected );
+
+    // sorting on just the significant low bits gives the same order
+    std::vector<uint64_t> narrow( keys.size() );
+    for (size_t i=0;i!=keys.size();++i)
+        narrow[i] = keys[i] & ((uint64_t(1) << 33) - 1);
+    std::vector<uint32_t> narrowExpected( expected.size() );
+    for (size_t i=0;i!=narrowExpected.size();++i)
+        narrowExpected[i] = uint32_t(i);
+    std::stable_sort( narrowExpected.begin(), narrowExpected.end(), [&](uint32_t a, uint32_t b) { return narrow[a] < narrow[b]; } );
+    std::vector<uint32_t> narrowOrder( narrowExpected.size() ), narrowParallel;
+    for (size_t i=0;i!=narrowOrder.size();++i)
+        narrowOrder[i] = uint32_t(i);
+    narrowParallel = narrowOrder;
+    std::vector<uint64_t> narrowSorted( narrow ), narrowSortedParallel( narrow );
+    RadixSort( narrowSorted, narrowOrder, ExecutionPolicy(), 33 );
+    RadixSort( narrowSortedParallel, narrowParallel, ExecutionPolicy( pool ), 33 );
+    TEST( narrowOrder==narrowExpected && narrowParallel==narrowExpected );
+
+    // points reordered along the curves come out in key order
+    std::vector< Vector3d<float> > points;
+    for (size_t i=0;i!=20000;++i)
+        points.push_back( Vector3d<float>( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) ) );
+    AxisAlignedBoundingBox3d<float> bounds(uninitialised);
+    AABB_ComputeBounds( points.begin(), points.end(), bounds );
+    std::vector<uint64_t> curveKeys;
+    ComputeHilbertKeys( bounds, points.begin(), points.end(), curveKeys, ExecutionPolicy( pool ) );
+    ComputeSortOrder( curveKeys, order, ExecutionPolicy( pool ) );
+    ApplyOrder( order, points, ExecutionPolicy( pool ) );
+    ComputeHilbertKeys( bounds, points.begin(), points.end(), curveKeys );
+    TEST( std::is_sorted( curveKeys.begin(), curveKeys.end() ) );
+    ComputeMortonKeys( bounds, points.begin(), points.end(), curveKeys );
+    ComputeSortOrder( curveKeys, order );
+    ApplyOrder( order, points );
+    ComputeMortonKeys( bounds, points.begin(), points.end(), curveKeys );
+    TEST( std::is_sorted( curveKeys.begin(), curveKeys.end() ) );
+
+    // the grid's corners, clamping, and integer points keeping their own cells
+    const CurveGrid< AxisAlignedBoundingBox3d<float> > grid( bounds );
+    uint32_t cell[3];
+    grid.ComputeCell( bounds.GetMinBound(), cell );
+    TEST( cell[0]==0 && cell[1]==0 && cell[2]==0 );
+    grid.ComputeCell( Vector3d<float>( 10, 10, -10 ), cell );
+    TEST( cell[0]==0x1fffff && cell[1]==0x1fffff && cell[2]==0 );
+    typedef VectorN<int,2> Vector2i;
+    typedef AxisAlignedBoundingBox<Vector2i> Box2i;
+    const CurveGrid<Box2i> intGrid( Box2i( Vector2i({ -3, 0 }), Vector2i({ 5, 2 }) ) );
+    uint32_t a[2], b[2];
+    intGrid.ComputeCell( Vector2i({ 1, 1 }), a );
+    intGrid.ComputeCell( Vector2i({ 2, 1 }), b );
+    TEST( a[0]<b[0] && a[1]==b[1] );
+    TEST( intGrid.GetMortonKey( Vector2i({ 1, 1 }) )!=intGrid.GetMortonKey( Vector2i({ 2, 1 }) ) );
+
+    Flush("TestSpaceFillingCurve");
+}
+
+// every box is reached once, and each node's bounds hold its children's
+bool CheckLinearBVH(const LinearBVH<float>& bvh, uint32_t node, std::vector<int>& seen)
+{
+    if (node & LinearBVH<float>::sLeaf)
+    {
+        ++seen[bvh.GetPrimitive( node )];
+        return true;
+    }
+    const AxisAlignedBoundingBox3d<float>& bounds = bvh.GetNodeBounds( node );
+    bool result = true;
+    for (uint32_t child : { bvh.GetLeftChild( node ), bvh.GetRightChild( node ) })
+    {
+        const AxisAlignedBoundingBox3d<float>& c = bvh.GetNodeBounds( child );
+        for (size_t d=0;d!=3;++d)
+        {
+            result &= bounds.GetMinBound()[d] <= c.GetMinBound()[d];
+            result &= bounds.GetMaxBound()[d] >= c.GetMaxBound()[d];
+        }
+        result &= CheckLinearBVH( bvh, child, seen );
+    }
+    return result;
+}
+
+void TestLinearBVH()
+{
+    srand(43);
+    typedef AxisAlignedBoundingBox3d<float> Box;
+
+    std::vector<Box> boxes;
+    for (size_t i=0;i!=20000;++i)
+    {
+        const Vector3d<float> p( RandomFloat(-10,10), RandomFloat(-10,10), RandomFloat(-1,1) );
+        Box b( p );
+        b.ExpandToContain( Vector3d<float>( p[0]+RandomFloat(0,0.5f), p[1]+RandomFloat(0,0.5f), p[2]+RandomFloat(0,0.5f) ) );
+        boxes.push_back( b );
+        // duplicate centres make equal keys
+        if (i%100==0)
+            boxes.push_back( b );
+    }
+
+    ThreadPool pool(3);
+    const LinearBVH<float> bvh( boxes );
+    LinearBVH<float> parallel;
+    parallel.Build( boxes, ExecutionPolicy( pool, 512 ) );
+    TEST( bvh.GetPrimitiveCount()==boxes.size() );
+
+    std::vector<int> seen( boxes.size(), 0 );
+    TEST( CheckLinearBVH( bvh, bvh.GetRoot(), seen ) );
+    TEST( std::count( seen.begin(), seen.end(), 1 )==int(boxes.size()) );
+
+    // the tree does not depend on the policy
+    bool same = true;
+    for (uint32_t n=0;n+1<boxes.size();++n)
+    {
+        same &= bvh.GetLeftChild(n)==parallel.GetLeftChild(n) && bvh.GetRightChild(n)==parallel.GetRightChild(n);
+        same &= bvh.GetNodeBounds(n).GetMinBound()==parallel.GetNodeBounds(n).GetMinBound();
+        same &= bvh.GetNodeBounds(n).GetMaxBound()==parallel.GetNodeBounds(n).GetMaxBound();
+    }
+    TEST( same );
+
+    // queries against brute force
+    bool overlapsMatch = true;
+    bool raysMatch = true;
+    size_t rayHits = 0;
+    for (int q=0;q!=50;++q)
+    {
+        const Vector3d<float> p( RandomFloat(-10,10), RandomFloat(-10,10), RandomFloat(-1,1) );
+        Box query( p );
+        query.ExpandToContain( Vector3d<float>( p[0]+RandomFloat(0,2), p[1]+RandomFloat(0,2), p[2]+RandomFloat(0,2) ) );
+        std::vector<uint32_t> found, expected;
+        parallel.QueryOverlaps( query, [&](uint32_t id) { found.push_back( id ); } );
+        for (size_t i=0;i!=boxes.size();++i)
+        {
+            if (boxes[i].Overlaps( query ))
+                expected.push_back( uint32_t(i) );
+        }
+        std::sort( found.begin(), found.end() );
+        overlapsMatch &= found==expected;
+
+        const Ray3d<float> ray( Vector3d<float>( -12, RandomFloat(-10,10), 0 ),
+            Vector3d<float>( 1, RandomFloat(-0.5f,0.5f), RandomFloat(-0.05f,0.05f) ) );
+        found.clear();
+        expected.clear();
+        bvh.QueryRay( ray, 30, [&](uint32_t id) { found.push_back( id ); } );
+        for (size_t i=0;i!=boxes.size();++i)
+        {
+            if (ray.Intersects( boxes[i], 30 ))
+                expected.push_back( uint32_t(i) );
+        }
+        std::sort( found.begin(), found.end() );
+        raysMatch &= found==expected;
+        rayHits += found.size();
+    }
+    TEST( overlapsMatch );
+    TEST( raysMatch && rayHits>50 );
+
+    // tiny trees
+    std::vector<Box> one( 1, boxes[0] );
+    LinearBVH<float> single( one );
+    TEST( single.GetRoot()==LinearBVH<float>::sLeaf && single.GetPrimitive( single.GetRoot() )==0 );
+    std::vector<Box> two( 2, boxes[0] );
+    LinearBVH<float> pair( two );
+    TEST( pair.GetRoot()==0 && (pair.GetLeftChild(0) & LinearBVH<float>::sLeaf) && (pair.GetRightChild(0) & LinearBVH<float>::sLeaf) );
+    pair.Build( std::vector<Box>() );
+    TEST( pair.GetPrimitiveCount()==0 );
+
+    Flush("TestLinearBVH");
+}
+
+// convex and counterclockwise with no point outside
+bool CheckConvexHull(const std::vector< Vector2d<float> >& points, const std::vector<uint32_t>& hull)
+{
+    const size_t n = hull.size();
+    if (n<3)
+        return false;
+    bool result = true;
+    for (size_t i=0;i!=n;++i)
+    {
+        const Vector2d<float>& a = points[hull[i]];
+        const Vector2d<float>& b = points[hull[(i+1)%n]];
+        result &= Orient2d( a, b, points[hull[(i+2)%n]] ) > 0;
+        for (const Vector2d<float>& p : points)
+            result &= Orient2d( a, b, p ) >= 0;
+    }
+    return result;
+}
+
+void TestConvexHull()
+{
+    srand(44);
+    typedef Vector2d<float> Point;
+
+    // near collinear triples, where the plain determinant gets the sign wrong
+    bool consistent = true;
+    for (int i=0;i!=2000;++i)
+    {
+        const Point a( RandomFloat(-1,1), RandomFloat(-1,1) );
+        const Point b( RandomFloat(-1,1), RandomFloat(-1,1) );
+        const float t = RandomFloat(-2,2);
+        const Point c( a[0]+t*(b[0]-a[0]), a[1]+t*(b[1]-a[1]) );
+        const double o = Orient2d( a, b, c );
+        const int sign = (o>0) - (o<0);
+        const double r = Orient2d( b, c, a );
+        const double s = Orient2d( c, a, b );
+        const double u = Orient2d( b, a, c );
+        consistent &= (r>0)-(r<0)==sign && (s>0)-(s<0)==sign && (u>0)-(u<0)==-sign;
+    }
+    TEST( consistent );
+    TEST( Orient2d( Point(0,0), Point(1,1), Point(2,2) )==0 );
+    TEST( Orient2d( Point(0,0), Point(1,0), Point(0,1) ) > 0 );
+    TEST( Orient2dExact( 0.5, 0.5, 12, 12, 24, nextafter(24.0,25.0) ) > 0 );
+
+    // a disc, so the octagon filter has something to drop
+    std::vector<Point> points;
+    for (size_t i=0;i!=20000;++i)
+    {
+        const Point p( RandomFloat(-1,1), RandomFloat(-1,1) );
+        if (p[0]*p[0] + p[1]*p[1] < 1)
+            points.push_back( p );
+    }
+    std::vector<uint32_t> hull, parallel;
+    ComputeConvexHull( points.begin(), points.end(), hull );
+    ThreadPool pool(3);
+    ComputeConvexHull( points.begin(), points.end(), parallel, ExecutionPolicy( pool, 1000 ) );
+    TEST( CheckConvexHull( points, hull ) );
+    TEST( hull==parallel );
+
+    // the same hull from monotone chain over the sorted points
+    std::vector<uint32_t> order( points.size() );
+    std::iota( order.begin(), order.end(), uint32_t(0) );
+    std::sort( order.begin(), order.end(), [&](uint32_t i, uint32_t j) {
+        return points[i][0]!=points[j][0] ? points[i][0] < points[j][0] : points[i][1] < points[j][1];
+    } );
+    std::vector<Point> sorted;
+    for (uint32_t i : order)
+        sorted.push_back( points[i] );
+    std::vector<uint32_t> chain;
+    ComputeSortedConvexHull( sorted.begin(), sorted.end(), chain );
+    bool same = chain.size()==hull.size();
+    for (size_t i=0;same && i!=chain.size();++i)
+        same &= order[chain[i]]==hull[i];
+    TEST( same );
+
+    // a grid has many collinear and tied points, and a circle is all hull
+    std::vector<Point> grid;
+    for (int y=0;y!=40;++y)
+        for (int x=0;x!=30;++x)
+            grid.push_back( Point( float(x), float(y) ) );
+    for (size_t i=grid.size();i>1;--i)
+        std::swap( grid[i-1], grid[rand()%i] );
+    ComputeConvexHull( grid.begin(), grid.end(), hull, ExecutionPolicy( pool, 100 ) );
+    TEST( hull.size()==4 && CheckConvexHull( grid, hull ) );
+    TEST( grid[hull[0]]==Point(0,0) && grid[hull[2]]==Point(29,39) );
+
+    std::vector<Point> circle;
+    for (int i=0;i!=500;++i)
+        circle.push_back( Point( 1000*cosf( i*0.012566371f ), 1000*sinf( i*0.012566371f ) ) );
+    ComputeConvexHull( circle.begin(), circle.end(), hull );
+    TEST( CheckConvexHull( circle, hull ) && hull.size() > 400 );
+
+    // degenerate sets
+    std::vector<Point> few;
+    ComputeConvexHull( few.begin(), few.end(), hull );
+    TEST( hull.empty() );
+    few.assign( 5, Point(1,2) );
+    ComputeConvexHull( few.begin(), few.end(), hull );
+    TEST( hull.size()==1 );
+    ComputeSortedConvexHull( few.begin(), few.end(), hull );
+    TEST( hull.size()==1 );
+    few.clear();
+    for (int i=0;i!=7;++i)
+        few.push_back( Point( float(3*i%7), float(2*(3*i%7)) ) );
+    ComputeConvexHull( few.begin(), few.end(), hull );
+    TEST( hull.size()==2 && few[hull[0]]==Point(0,0) && few[hull[1]]==Point(6,12) );
+
+    Flush("TestConvexHull");
+}
+
+// closed, consistently wound, and nothing outside by more than the tolerance
+// every edge shared the other way round and a closed surface of triangles
+bool CheckConvexHull3dTopology(const ConvexHull3d<float>& hull)
+{
+    const std::vector<uint32_t>& indices = hull.GetIndices();
+    const std::vector<uint32_t>& adjacency = hull.GetAdjacency();
+    const size_t faces = hull.GetFaceCount();
+    bool result = faces >= 4;
+    for (size_t f=0;f!=faces;++f)
+    {
+        for (size_t k=0;k!=3;++k)
+        {
+            // the face across shares the edge the other way round
+            const uint32_t g = adjacency[f*3+k];
+            const uint32_t a = indices[f*3+k];
+            const uint32_t b = indices[f*3+(k+1)%3];
+            bool shared = false;
+            for (size_t j=0;g<faces && j!=3;++j)
+                shared |= indices[g*3+j]==b && indices[g*3+(j+1)%3]==a && adjacency[g*3+j]==f;
+            result &= shared;
+        }
+    }
+
+    // V - E + F = 2
+    std::vector<uint32_t> vertices;
+    hull.ComputeVertices( vertices );
+    result &= vertices.size() + faces - faces*3/2 == 2;
+    return result;
+}
+
+bool CheckConvexHull3d(const std::vector< Vector3d<float> >& points, const ConvexHull3d<float>& hull)
+{
+    bool result = CheckConvexHull3dTopology( hull );
+    for (size_t f=0;f!=hull.GetFaceCount();++f)
+    {
+        const Triangle3d<float> t = hull.GetTriangle( points, f );
+        const Vector3d<float> normal = FaceNormal( t );
+        for (const Vector3d<float>& p : points)
+            result &= DotProduct( normal, Vector3d<float>( p - t.GetA() ) ) <= 1e-4f;
+    }
+    return result;
+}
+
+void TestConvexHull3d()
+{
+    srand(45);
+    typedef Vector3d<float> Point;
+
+    // a ball, most points inside
+    std::vector<Point> points;
+    while (points.size()!=20000)
+    {
+        const Point p( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) );
+        if (p.LengthSquare() < 1)
+            points.push_back( p );
+    }
+    ThreadPool pool(3);
+    ConvexHull3d<float> hull;
+    TEST( hull.Build( points, ExecutionPolicy( pool, 1000 ) ) );
+    TEST( CheckConvexHull3d( points, hull ) );
+    const ConvexHull3d<float> sequential( points );
+    TEST( sequential.GetIndices()==hull.GetIndices() );
+
+    // a sphere, every point on the hull
+    std::vector<Point> sphere;
+    while (sphere.size()!=2000)
+    {
+        Point p( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) );
+        if (p.LengthSquare() > 0.01f)
+        {
+            p.Normalise();
+            sphere.push_back( Point( 10*p[0], 10*p[1], 10*p[2] ) );
+        }
+    }
+    TEST( hull.Build( sphere ) && CheckConvexHull3d( sphere, hull ) );
+    std::vector<uint32_t> vertices;
+    hull.ComputeVertices( vertices );
+    TEST( vertices.size() > 1900 && hull.GetFaceCount()==2*vertices.size()-4 );
+
+    // a lattice cube, its corners among the vertices and nothing inside. with
+    // no face merging, lattice points on its faces may be kept as well
+    std::vector<Point> cube;
+    for (int i=0;i!=1000;++i)
+    {
+        Point p( float(rand()%5), float(rand()%5), float(rand()%5) );
+        cube.push_back( p );
+    }
+    for (int c=0;c!=8;++c)
+        cube.push_back( Point( float(c&1)*4, float((c>>1)&1)*4, float((c>>2)&1)*4 ) );
+    TEST( hull.Build( cube ) && CheckConvexHull3d( cube, hull ) );
+    hull.ComputeVertices( vertices );
+    size_t corners = 0;
+    bool surface = true;
+    for (uint32_t v : vertices)
+    {
+        int on = 0;
+        for (size_t d=0;d!=3;++d)
+            on += cube[v][d]==0 || cube[v][d]==4;
+        corners += on==3;
+        surface &= on!=0;
+    }
+    TEST( corners==8 && surface );
+
+    // lattices nudged by about the tolerance either build a closed hull or
+    // fail cleanly, never stitch a broken one. the nudged copies of repeated
+    // points make slivers whose float normals are too rough to test against
+    for (int trial=0;trial!=20;++trial)
+    {
+        std::vector<Point> nudged( cube );
+        for (Point& p : nudged)
+            for (size_t d=0;d!=3;++d)
+                p[d] += RandomFloat(-1,1) * 4e-6f;
+        if (hull.Build( nudged ))
+            TEST( CheckConvexHull3dTopology( hull ) );
+        else
+            TEST( hull.GetFaceCount()==0 );
+    }
+
+    // no volume
+    std::vector<Point> flat;
+    for (int i=0;i!=100;++i)
+        flat.push_back( Point( RandomFloat(-1,1), RandomFloat(-1,1), 2 ) );
+    TEST( !hull.Build( flat ) && hull.GetFaceCount()==0 );
+    flat.erase( flat.begin()+3, flat.end() );
+    TEST( !hull.Build( flat ) );
+
+    Flush("TestConvexHull3d");
+}
+
+void TestPolygon2d()
+{
+    srand(46);
+    typedef Vector2d<float> Point;
+
+    // a ragged star with a square hole, and a second hole wound the other way
+    std::vector<Point> outline;
+    for (int i=0;i!=2000;++i)
+    {
+        const float angle = i * 6.2831853f / 2000;
+        const float r = (i%2 ? 10.0f : 6.0f) + RandomFloat(-1,1);
+        outline.push_back( Point( r*cosf( angle ), r*sinf( angle ) ) );
+    }
+    Polygon2d<float> polygon( outline );
+    polygon.AddRing( { Point(-2,-2), Point(2,-2), Point(2,2), Point(-2,2) } );
+    polygon.AddRing( { Point(3,3), Point(3,4), Point(4,4), Point(4,3) } );
+    TEST( polygon.GetRingCount()==3 && polygon.GetRingSize(1)==4 && polygon.GetRingStart(2)==2004 );
+    TEST( polygon.GetSignedArea(1)==16 && polygon.GetSignedArea(2)==-1 );
+    TEST( polygon.GetArea() > 100 && polygon.GetArea() < 300 );
+
+    // the grid answers exactly as the plain crossing count does
+    const Polygon2d<float> plain( polygon );
+    polygon.Prepare();
+    TEST( polygon.IsPrepared() && !plain.IsPrepared() );
+    std::vector<Point> queries;
+    for (int i=0;i!=20000;++i)
+        queries.push_back( Point( RandomFloat(-12,12), RandomFloat(-12,12) ) );
+    // and on the ring points themselves
+    for (size_t i=0;i<polygon.GetPoints().size();i+=7)
+        queries.push_back( polygon.GetPoints()[i] );
+    std::vector<uint8_t> expected, found;
+    plain.ComputeContains( queries.begin(), queries.end(), expected );
+    ThreadPool pool(3);
+    polygon.ComputeContains( queries.begin(), queries.end(), found, ExecutionPolicy( pool, 1000 ) );
+    TEST( found==expected );
+    TEST( std::count( found.begin(), found.end(), 1 ) > 1000 );
+    TEST( polygon.Contains( Point(5,0) ) && !polygon.Contains( Point(0,0) ) );
+    TEST( !polygon.Contains( Point(3.5f,3.5f) ) && polygon.Contains( Point(2.5f,3.5f) ) );
+    TEST( !polygon.Contains( Point(20,0) ) && !polygon.Contains( Point(nanf(""),0) ) );
+
+    // lattice rings and points, so points land on edges, vertices and
+    // grid lines, and rays run along edges
+    std::vector<Point> zigzag;
+    for (int x=0;x<=20;++x)
+        zigzag.push_back( Point( float(x), float(x%3) ) );
+    zigzag.push_back( Point(20,12) );
+    zigzag.push_back( Point(10,6) );
+    zigzag.push_back( Point(0,12) );
+    Polygon2d<float> lattice( zigzag );
+    lattice.AddRing( { Point(4,4), Point(8,4), Point(8,8), Point(6,6), Point(4,8) } );
+    const Polygon2d<float> latticePlain( lattice );
+    lattice.Prepare();
+    bool same = true;
+    size_t inside = 0;
+    for (int y=-2;y<=28;++y)
+    {
+        for (int x=-2;x<=42;++x)
+        {
+            const Point p( x*0.5f, y*0.5f );
+            same &= lattice.Contains( p )==latticePlain.Contains( p );
+            inside += lattice.Contains( p );
+        }
+    }
+    TEST( same && inside > 100 );
+
+    // empty, and a single point
+    Polygon2d<float> empty;
+    empty.Prepare();
+    TEST( !empty.Contains( Point(0,0) ) );
+    Polygon2d<float> dot( std::vector<Point>( 1, Point(1,1) ) );
+    dot.Prepare();
+    TEST( !dot.Contains( Point(1,1) ) && dot.GetArea()==0 );
+
+    Flush("TestPolygon2d");
+}
+
+// n + 2h - 2 counterclockwise triangles covering the polygon's area, each inside it
+bool CheckTriangulation(const Polygon2d<float>& polygon, const std::vector<uint32_t>& triangles, size_t holes)
+{
+    const std::vector< Vector2d<float> >& points = polygon.GetPoints();
+    bool result = triangles.size()==3*(points.size() + 2*holes - 2);
+    double area = 0;
+    for (size_t t=0;t+2<triangles.size();t+=3)
+    {
+        const Vector2d<float>& a = points[triangles[t]];
+        const Vector2d<float>& b = points[triangles[t+1]];
+        const Vector2d<float>& c = points[triangles[t+2]];
+        const double twice = Orient2d( a, b, c );
+        result &= twice > 0;
+        area += twice/2;
+        const Vector2d<float> centre( (a[0]+b[0]+c[0])/3, (a[1]+b[1]+c[1])/3 );
+        result &= polygon.Contains( centre );
+    }
+    return result && Fabs( area - polygon.GetArea() ) < 1e-6*polygon.GetArea();
+}
+
+void TestTriangulation()
+{
+    srand(47);
+    typedef Vector2d<float> Point;
+    std::vector<uint32_t> triangles;
+
+    // a square, and the same wound clockwise
+    Polygon2d<float> square( { Point(0,0), Point(1,0), Point(1,1), Point(0,1) } );
+    TEST( ComputeTriangulation( square, triangles ) && CheckTriangulation( square, triangles, 0 ) );
+    Polygon2d<float> backwards( { Point(0,1), Point(1,1), Point(1,0), Point(0,0) } );
+    TEST( ComputeTriangulation( backwards, triangles ) && CheckTriangulation( backwards, triangles, 0 ) );
+
+    // a comb, all split and merge vertices, with horizontal edges
+    std::vector<Point> comb;
+    for (int i=0;i!=50;++i)
+    {
+        comb.push_back( Point( float(2*i), 0 ) );
+        comb.push_back( Point( float(2*i)+1, 10 ) );
+        comb.push_back( Point( float(2*i)+1.5f, 10 ) );
+    }
+    comb.push_back( Point( 100, -5 ) );
+    comb.push_back( Point( 0, -5 ) );
+    std::reverse( comb.begin(), comb.end() );
+    Polygon2d<float> teeth( comb );
+    TEST( ComputeTriangulation( teeth, triangles ) && CheckTriangulation( teeth, triangles, 0 ) );
+
+    // a ragged star with holes, one of them clockwise
+    std::vector<Point> outline;
+    for (int i=0;i!=3000;++i)
+    {
+        const float angle = i * 6.2831853f / 3000;
+        const float r = (i%2 ? 10.0f : 7.0f) + RandomFloat(-0.5f,0.5f);
+        outline.push_back( Point( r*cosf( angle ), r*sinf( angle ) ) );
+    }
+    Polygon2d<float> star( outline );
+    star.AddRing( { Point(-2,-2), Point(2,-2), Point(2,2), Point(-2,2) } );
+    star.AddRing( { Point(3,0), Point(4,1), Point(5,0), Point(4,-1) } );
+    std::vector<Point> round;
+    for (int i=0;i!=40;++i)
+        round.push_back( Point( -4 + cosf( i*0.157f ), sinf( i*0.157f ) ) );
+    star.AddRing( round );
+    star.Prepare();
+    TEST( ComputeTriangulation( star, triangles ) && CheckTriangulation( star, triangles, 3 ) );
+
+    // lattice points, so many share a y
+    std::vector<Point> steps;
+    for (int i=0;i!=20;++i)
+    {
+        steps.push_back( Point( float(i), float(i%2) ) );
+    }
+    steps.push_back( Point( 19, 5 ) );
+    steps.push_back( Point( 10, 3 ) );
+    steps.push_back( Point( 0, 5 ) );
+    Polygon2d<float> stairs( steps );
+    stairs.AddRing( { Point(2,2), Point(4,2), Point(4,3), Point(2,3) } );
+    TEST( ComputeTriangulation( stairs, triangles ) && CheckTriangulation( stairs, triangles, 1 ) );
+
+    // monotone polygons with collinear chains: after a reflex vertex,
+    // straight down from the top, and on both sides. every triangle has area
+    Polygon2d<float> bent( { Point(0,20), Point(-10,16), Point(-2,10), Point(-1,5), Point(0,0),
+        Point(2,5), Point(4,10), Point(6,15) } );
+    TEST( ComputeTriangulation( bent, triangles ) && CheckTriangulation( bent, triangles, 0 ) );
+    Polygon2d<float> straight( { Point(0,10), Point(0,8), Point(0,6), Point(0,4), Point(0,2), Point(0,0), Point(3,5) } );
+    TEST( ComputeTriangulation( straight, triangles ) && CheckTriangulation( straight, triangles, 0 ) );
+    Polygon2d<float> spire( { Point(0,10), Point(-1,8), Point(-2,6), Point(-3,4), Point(0,0),
+        Point(3,4), Point(2,6), Point(1,8) } );
+    TEST( ComputeTriangulation( spire, triangles ) && CheckTriangulation( spire, triangles, 0 ) );
+
+    Polygon2d<float> line( { Point(0,0), Point(1,1) } );
+    TEST( !ComputeTriangulation( line, triangles ) && triangles.empty() );
+
+    Flush("TestTriangulation");
+}
+
+void TestGjk()
+{
+    srand(48);
+    typedef Vector3d<double> Point;
+    typedef VectorN<double,3> Base;
+    typedef AxisAlignedBoundingBox3d<double> Box;
+    GjkSimplex<Base> simplex;
+    GjkResult<Base> result;
+
+    // boxes apart, then overlapping by half along x
+    const BoxSupport<Box> unit( Box( Point(0,0,0), Point(1,1,1) ) );
+    const BoxSupport<Box> right( Box( Point(3,0.5,0.5), Point(4,2,2) ) );
+    TEST( !ComputeGjk( unit, right, simplex, result ) );
+    TEST( fabs( result.mDistance - 2 ) < 1e-9 && fabs( result.mNormal[0] - 1 ) < 1e-9 );
+    TEST( fabs( result.mPointA[0] - 1 ) < 1e-9 && fabs( result.mPointB[0] - 3 ) < 1e-9 );
+    const BoxSupport<Box> overlap( Box( Point(0.5,-1,-1), Point(2,2,2) ) );
+    simplex.Clear();
+    TEST( ComputeGjk( unit, overlap, simplex, result ) );
+    TEST( ComputePenetration( unit, overlap, simplex, result ) );
+    TEST( fabs( result.mPenetration - 0.5 ) < 1e-9 && fabs( result.mNormal[0] - 1 ) < 1e-9 );
+    TEST( result.mConverged );
+
+    // running out of iterations is reported, with the estimate so far
+    const SphereSupport<Point> ball( Point(0,0,0), 1 ), other( Point(1,0.3,0.2), 1 );
+    simplex.Clear();
+    TEST( ComputeGjk( ball, other, simplex, result ) && result.mConverged );
+    TEST( !ComputePenetration( ball, other, simplex, result, 2 ) && !result.mConverged );
+    TEST( result.mPenetration > 0 && result.mPenetration < 2 - Point(1,0.3,0.2).Length() + 1e-9 );
+    simplex.Clear();
+    TEST( !ComputeGjk( ball, SphereSupport<Point>( Point(5,1,0), 1 ), simplex, result, 0 ) && !result.mConverged );
+
+    // a triangle under a tetrahedron given as points
+    const TriangleSupport< Triangle<Point> > floor( Triangle<Point>( Point(-1,-1,0), Point(2,-1,0), Point(-1,2,0) ) );
+    const Point tetrahedron[4] = { Point(0,0,1), Point(1,0,2), Point(0,1,2), Point(0,0,3) };
+    const PointSetSupport<Point> cloud( tetrahedron, 4 );
+    simplex.Clear();
+    TEST( !ComputeGjk( floor, cloud, simplex, result ) && fabs( result.mDistance - 1 ) < 1e-9 );
+    TEST( fabs( result.mPointA[2] ) < 1e-9 && fabs( result.mNormal[2] - 1 ) < 1e-9 );
+
+    // coplanar triangles overlap with no depth to find
+    const TriangleSupport< Triangle<Point> > flat( Triangle<Point>( Point(0,0,0), Point(1,0,0), Point(0,1,0) ) );
+    simplex.Clear();
+    TEST( ComputeGjk( floor, flat, simplex, result ) && !ComputePenetration( floor, flat, simplex, result ) );
+
+    // random boxes against the exact gap or overlap, in 3D and 2D
+    int failures = 0;
+    for (int i=0;i!=500;++i)
+    {
+        const Point a( RandomFloat(-2,2), RandomFloat(-2,2), RandomFloat(-2,2) );
+        const Point b( RandomFloat(-2,2), RandomFloat(-2,2), RandomFloat(-2,2) );
+        const Point sa( RandomFloat(0.1f,2), RandomFloat(0.1f,2), RandomFloat(0.1f,2) );
+        const Point sb( RandomFloat(0.1f,2), RandomFloat(0.1f,2), RandomFloat(0.1f,2) );
+        const Box boxA( a, Point( a + sa ) );
+        const Box boxB( b, Point( b + sb ) );
+        double gap = 0, depth = 1e9;
+        for (int d=0;d!=3;++d)
+        {
+            const double g = std::max( a[d] - b[d] - sb[d], b[d] - a[d] - sa[d] );
+            gap += g > 0 ? g*g : 0;
+            depth = std::min( depth, -g );
+        }
+        simplex.Clear();
+        const bool hit = ComputeGjk( BoxSupport<Box>( boxA ), BoxSupport<Box>( boxB ), simplex, result );
+        if (depth > 1e-6)
+        {
+            failures += !hit || !ComputePenetration( BoxSupport<Box>( boxA ), BoxSupport<Box>( boxB ), simplex, result )
+                || fabs( result.mPenetration - depth ) > 1e-6;
+        }
+        else if (depth < -1e-6)
+        {
+            failures += hit || fabs( result.mDistance - sqrt( gap ) ) > 1e-6
+                || fabs( (result.mPointB - result.mPointA).Length() - result.mDistance ) > 1e-6;
+        }
+    }
+    TEST( failures==0 );
+
+    typedef Vector2d<double> Point2;
+    typedef VectorN<double,2> Base2;
+    GjkSimplex<Base2> simplex2;
+    GjkResult<Base2> result2;
+    failures = 0;
+    for (int i=0;i!=500;++i)
+    {
+        const Point2 a( RandomFloat(-2,2), RandomFloat(-2,2) );
+        const Point2 b( RandomFloat(-2,2), RandomFloat(-2,2) );
+        const double ra = RandomFloat(0.1f,1), rb = RandomFloat(0.1f,1);
+        const SphereSupport<Point2> circleA( a, ra );
+        const SphereSupport<Point2> circleB( b, rb );
+        const double apart = (b - a).Length() - ra - rb;
+        simplex2.Clear();
+        const bool hit = ComputeGjk( circleA, circleB, simplex2, result2 );
+        if (apart > 1e-3)
+            failures += hit || fabs( result2.mDistance - apart ) > 1e-6;
+        else if (apart < -1e-3)
+            failures += !hit || !ComputePenetration( circleA, circleB, simplex2, result2 )
+                || fabs( result2.mPenetration + apart ) > 1e-3;
+    }
+    TEST( failures==0 );
+
+    // point clouds drifting past each other, the simplex kept from one
+    // step to the next
+    std::vector<Point> rock;
+    while (rock.size()!=40)
+    {
+        Point p( RandomFloat(-1,1), RandomFloat(-1,1), RandomFloat(-1,1) );
+        if (p.LengthSquare() > 0.01)
+        {
+            p.Normalise();
+            rock.push_back( p );
+        }
+    }
+    size_t cold = 0, warm = 0;
+    simplex.Clear();
+    for (int i=0;i!=100;++i)
+    {
+        std::vector<Point> moved( rock );
+        for (Point& p : moved)
+            p = Point( p[0] + 3, p[1] + 0.02*i - 1, p[2] );
+        const PointSetSupport<Point> still( rock.data(), rock.size() );
+        const PointSetSupport<Point> moving( moved.data(), moved.size() );
+        GjkSimplex<Base> fresh;
+        GjkResult<Base> reference;
+        ComputeGjk( still, moving, fresh, reference );
+        TEST( !ComputeGjk( still, moving, simplex, result ) );
+        TEST( fabs( result.mDistance - reference.mDistance ) < 1e-9 );
+        cold += reference.mIterations;
+        warm += result.mIterations;
+    }
+    TEST( warm < cold );
+
+    Flush("TestGjk");
+}
+
+void TestOrientedBoundingBox()
+{
+    srand(49);
+    typedef Vector3d<float> Point;
+    typedef OrientedBoundingBox3d<float> OBB;
+
+    // a unit box turned 45 degrees about z reaches sqrt 2 along x
+    const OBB turned( Point(0,0,0), Point(1,1,1), Matrix4<float>::RotationAroundZ( 0.78539816f ) );
+    const OBB::BoundsType bounds = turned.GetBounds();
+    TEST( fabsf( bounds.GetMaxBound()[0] - 1.4142136f ) < 1e-5f && fabsf( bounds.GetMinBound()[2] + 1 ) < 1e-5f );
+    TEST( turned.Contains( Point(1.4f,0,0) ) && !turned.Contains( Point(1,1,0) ) );
+
+    // its corner region is empty, the axis aligned box there is not
+    const OBB corner( AxisAlignedBoundingBox3d<float>( Point(0.8f,0.8f,-1), Point(1.2f,1.2f,1) ) );
+    TEST( !turned.Intersects( corner ) && !corner.Intersects( turned ) );
+    TEST( turned.GetBounds().Contains( corner.GetCenter() ) );
+    const OBB edge( AxisAlignedBoundingBox3d<float>( Point(1.3f,-0.1f,-1), Point(1.6f,0.1f,1) ) );
+    TEST( turned.Intersects( edge ) );
+
+    // rods crossing in x, then one lifted clear, separated only by the
+    // cross product of their edges
+    const OBB rodX( Point(0,0,0), Point(5,0.1f,0.1f), Matrix4<float>() );
+    const OBB rodY( Point(0,0,0), Point(5,0.1f,0.1f), Matrix4<float>::RotationAroundZ( 1.2f ) );
+    const OBB lifted( Point(0,0,0.5f), Point(5,0.1f,0.1f), Matrix4<float>::RotationAroundZ( 1.2f ) );
+    TEST( rodX.Intersects( rodY ) && !rodX.Intersects( lifted ) );
+
+    // random boxes: corners of one inside the other must intersect, and
+    // the batch test must agree with the single one
+    std::vector<OBB> boxes;
+    OrientedBoundingBoxArray<float> array;
+    for (int i=0;i!=400;++i)
+    {
+        const Matrix4<float> r = Matrix4<float>::RotationFromEuler(
+            VectorN<float,3>( { RandomFloat(-3,3), RandomFloat(-3,3), RandomFloat(-3,3) } ) );
+        boxes.push_back( OBB( Point( RandomFloat(-4,4), RandomFloat(-4,4), RandomFloat(-4,4) ),
+            Point( RandomFloat(0.1f,2), RandomFloat(0.1f,2), RandomFloat(0.1f,0.5f) ), r ) );
+        array.Add( boxes.back() );
+    }
+    TEST( array.GetSize()==400 && array.Get( 7 ).GetCenter()==boxes[7].GetCenter() );
+    std::vector<uint8_t> hits( boxes.size() );
+    int failures = 0, overlaps = 0;
+    for (size_t i=0;i!=boxes.size();++i)
+    {
+        ComputeIntersections( array, 0, array.GetSize(), boxes[i], hits.data() );
+        for (size_t j=0;j!=boxes.size();++j)
+        {
+            const bool hit = boxes[i].Intersects( boxes[j] );
+            overlaps += hit;
+            failures += hit!=bool( hits[j] ) || hit!=boxes[j].Intersects( boxes[i] );
+            for (int c=0;c!=8;++c)
+            {
+                Point p( boxes[j].GetCenter() );
+                for (size_t k=0;k!=3;++k)
+                {
+                    Point offset( boxes[j].GetAxis( k ) );
+                    offset *= (c >> k & 1 ? 1 : -1) * boxes[j].GetHalfExtents()[k] * 0.999f;
+                    p += offset;
+                }
+                failures += boxes[i].Contains( p ) && !hit;
+                failures += !boxes[j].GetBounds().Contains( p );
+            }
+        }
+    }
+    TEST( failures==0 && overlaps > 400 && overlaps < 400*400 );
+
+    // a sub range starting part way into a block
+    std::vector<uint8_t> some( 250 );
+    ComputeIntersections( array, 37, 287, boxes[5], some.data() );
+    failures = 0;
+    for (size_t j=0;j!=some.size();++j)
+        failures += bool( some[j] )!=boxes[5].Intersects( boxes[37+j] );
+    TEST( failures==0 );
+
+    // a rotated rod of points, fitted far tighter than its axis aligned box
+    const Matrix4<float> tilt = Matrix4<float>::RotationFromEuler( VectorN<float,3>( { 0.3f, 0.7f, -0.4f } ) );
+    std::vector<Point> rod;
+    for (int i=0;i!=5000;++i)
+    {
+        const VectorN<float,3> local( { RandomFloat(-10,10), RandomFloat(-1,1), RandomFloat(-0.2f,0.2f) } );
+        rod.push_back( Point( Point( tilt*local ) + Point(100,-50,20) ) );
+    }
+    ThreadPool pool(3);
+    OBB fitted( uninitialised );
+    ComputeOrientedBoundingBox( rod.begin(), rod.end(), fitted, ExecutionPolicy( pool, 500 ) );
+    bool inside = true;
+    for (const Point& p : rod)
+        inside &= fitted.Contains( p );
+    TEST( inside );
+    TEST( fitted.GetVolume() < 20*2*0.4f*1.1f && fitted.GetVolume() < fitted.GetBounds().GetDiagonal()[0]*10 );
+    const Point longAxis( tilt*VectorN<float,3>( { 1, 0, 0 } ) );
+    TEST( fabsf( DotProduct( fitted.GetAxis( 0 ), longAxis ) ) > 0.999f );
+    TEST( fabsf( DotProduct( CrossProduct( fitted.GetAxis( 0 ), fitted.GetAxis( 1 ) ), fitted.GetAxis( 2 ) ) - 1 ) < 1e-5f );
+    OBB sequential( uninitialised );
+    ComputeOrientedBoundingBox( rod.begin(), rod.end(), sequential, ExecutionPolicy().WithGrain( 500 ) );
+    TEST( sequential.GetCenter()==fitted.GetCenter() && sequential.GetHalfExtents()==fitted.GetHalfExtents() );
+
+    Flush("TestOrientedBoundingBox");
+}
+
+// the smallest of the spheres through two to four of points holding all
+// of them, by brute force
+float BruteForceMinimalRadius(const std::vector< Vector3d<float> >& points)
+{
+    typedef Vector3d<float> Point;
+    const size_t n = points.size();
+    float best = 1e30f;
+    for (size_t a=0;a!=n;++a)
+    for (size_t b=a+1;b!=n;++b)
+    for (size_t c=b;c!=n;++c)
+    for (size_t d=c;d!=n;++d)
+    {
+        std::vector<Point> subset( 1, points[a] );
+        subset.push_back( points[b] );
+        if (c!=b) subset.push_back( points[c] );
+        if (d!=c) subset.push_back( points[d] );
+        Sphere<Point> sphere( uninitialised );
+        if (!ComputeCircumsphere( subset.data(), subset.size(), sphere ))
+            continue;
+        bool holds = true;
+        for (const Point& p : points)
+            holds &= (p - sphere.GetCenter()).Length() <= sphere.GetRadius()*1.0001f;
+        if (holds)
+            best = std::min( best, sphere.GetRadius() );
+    }
+    return best;
+}
+
+void TestSphere()
+{
+    srand(50);
+    typedef Vector3d<float> Point;
+    typedef Vector2d<float> Point2;
+
+    // corners of a square, a circle through all four
+    const Point2 square[4] = { Point2(0,0), Point2(2,0), Point2(2,2), Point2(0,2) };
+    Sphere<Point2> circle( uninitialised );
+    ComputeMinimalSphere( square, square+4, circle );
+    TEST( fabsf( circle.GetRadius() - 1.4142136f ) < 1e-5f && (circle.GetCenter() - Point2(1,1)).Length() < 1e-5f );
+
+    // points on a line, and one point many times over
+    std::vector<Point> line;
+    for (int i=0;i!=50;++i)
+        line.push_back( Point( float(i), float(2*i), -float(i) ) );
+    Sphere<Point> sphere( uninitialised );
+    ComputeMinimalSphere( line.begin(), line.end(), sphere );
+    TEST( fabsf( sphere.GetRadius() - (line[49] - line[0]).Length()/2 ) < 1e-4f );
+    const std::vector<Point> same( 20, Point(3,4,5) );
+    ComputeMinimalSphere( same.begin(), same.end(), sphere );
+    TEST( sphere.GetRadius() < 1e-5f && sphere.Contains( same[0] ) );
+
+    // small clouds against brute force, Ritter against Welzl
+    int failures = 0;
+    for (int trial=0;trial!=30;++trial)
+    {
+        std::vector<Point> points;
+        for (int i=0;i!=9;++i)
+            points.push_back( Point( RandomFloat(-5,5), RandomFloat(-2,2), RandomFloat(-1,1) ) );
+        ComputeMinimalSphere( points.begin(), points.end(), sphere );
+        failures += fabsf( sphere.GetRadius() - BruteForceMinimalRadius( points ) ) > 1e-4f;
+        for (const Point& p : points)
+            failures += !sphere.Contains( p );
+    }
+    TEST( failures==0 );
+
+    std::vector<Point> cloud;
+    for (int i=0;i!=20000;++i)
+        cloud.push_back( Point( RandomFloat(995,1005), RandomFloat(-2,2), RandomFloat(-1,1) ) );
+    Sphere<Point> ritter( uninitialised );
+    ComputeRitterSphere( cloud.begin(), cloud.end(), ritter );
+    ComputeMinimalSphere( cloud.begin(), cloud.end(), sphere );
+    bool inside = true;
+    for (const Point& p : cloud)
+        inside &= sphere.Contains( p ) && ritter.Contains( p );
+    TEST( inside );
+    AxisAlignedBoundingBox3d<float> bounds( cloud[0] );
+    for (const Point& p : cloud)
+        bounds.ExpandToContain( p );
+    TEST( sphere.GetRadius() <= ritter.GetRadius() && ritter.GetRadius() < 1.2f*sphere.GetRadius() );
+    TEST( sphere.GetRadius() < Sphere<Point>( bounds ).GetRadius() );
+
+    // float rounding of p - center decides here, the radius must hold
+    // every point as Contains itself measures it. then tight clusters far
+    // from the origin, where the center Ritter moves rounds well away from
+    // where it was meant to go
+    failures = 0;
+    for (int trial=0;trial!=4000;++trial)
+    {
+        const bool far = trial%2==1;
+        const float scale = expf( RandomFloat(-10,10) );
+        const float offset = far ? RandomFloat(1e4f,1e6f) : 0;
+        const Point centre( offset + RandomFloat(-1,1)*scale, RandomFloat(-1,1)*scale, -offset + RandomFloat(-1,1)*scale );
+        std::vector<Point> points;
+        for (int i=0;i!=8;++i)
+            points.push_back( Point( offset + RandomFloat(-1,1)*scale, RandomFloat(-1,1)*scale, -offset + RandomFloat(-1,1)*scale ) );
+        const Sphere<Point> about( centre, GetEnclosingRadius( points.begin(), points.end(), centre ) );
+        ComputeRitterSphere( points.begin(), points.end(), ritter );
+        ComputeMinimalSphere( points.begin(), points.end(), sphere );
+        for (const Point& p : points)
+            failures += !about.Contains( p ) || !ritter.Contains( p ) || !sphere.Contains( p );
+    }
+    TEST( failures==0 );
+
+    // the batch tests against the single ones, from an offset
+    SphereArray<Point> spheres;
+    for (int i=0;i!=1000;++i)
+        spheres.Add( Sphere<Point>( Point( RandomFloat(-10,10), RandomFloat(-10,10), RandomFloat(-10,10) ), RandomFloat(0,2) ) );
+    TEST( spheres.GetSize()==1000 && spheres.Get( 5 ).GetRadius()==spheres.GetRadii()[5] );
+    const Sphere<Point> query( Point(1,2,3), 4 );
+    const AxisAlignedBoundingBox<Point> box( Point(-3,-1,0), Point(2,6,4) );
+    std::vector<uint8_t> hits( 1000 ), boxHits( 1000 );
+    ComputeOverlaps( spheres, 100, 1000, query, hits.data() );
+    ComputeOverlaps( spheres, 100, 1000, box, boxHits.data() );
+    int overlaps = 0, boxOverlaps = 0;
+    failures = 0;
+    for (size_t i=100;i!=1000;++i)
+    {
+        const Sphere<Point> s = spheres.Get( i );
+        overlaps += hits[i-100];
+        boxOverlaps += boxHits[i-100];
+        failures += bool( hits[i-100] )!=s.Overlaps( query ) || s.Overlaps( query )!=query.Overlaps( s );
+        failures += bool( boxHits[i-100] )!=s.Overlaps( box );
+        failures += box.Contains( s.GetCenter() ) && !s.Overlaps( box );
+    }
+    TEST( failures==0 && overlaps > 0 && overlaps < 900 && boxOverlaps > 0 && boxOverlaps < 900 );
+
+    Flush("TestSphere");
+}
+
 int main()
 {
     TestLayout();
@@ -692,6 +3076,32 @@ int main()
     TestSwizzle();
     TestManhattan();
     Test2dIntersection();
+    TestMesh();
+    TestRayTriangle();
+    TestBVH();
+    TestQuantisedBVH();
+    TestTriangleArray();
+    TestFastMaths();
+    TestBatchRotation();
+    TestQuaternion();
+    TestAffine3();
+    TestTransformHierarchy();
+    TestParallel();
+    TestArena();
+    TestMatrixX();
+    TestMatrixChain();
+    TestBinaryFile();
+    TestPointCloudReader();
+    TestComputeBounds();
+    TestSpaceFillingCurve();
+    TestLinearBVH();
+    TestConvexHull();
+    TestConvexHull3d();
+    TestPolygon2d();
+    TestTriangulation();
+    TestGjk();
+    TestOrientedBoundingBox();
+    TestSphere();
     // Geometry::MatrixN<int,4> matrix11({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 });
     // in OGL format
     // x.x x.y x.z 0
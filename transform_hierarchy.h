@@ -0,0 +1,331 @@
+#ifndef GEOMETRY_TRANSFORM_HIERARCHY_H_INCLUDED_
+#define GEOMETRY_TRANSFORM_HIERARCHY_H_INCLUDED_
+
+#include "matrix4.h"
+#include "affine3.h"
+#include "aabb3d.h"
+#include "parallel.h"
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // parent/child transforms with lazily recomputed world matrices.
+    // nodes are kept in depth first order so every subtree is a contiguous
+    // range of slots; Update only walks the ranges under dirty nodes, and
+    // those ranges never overlap so they can be processed concurrently.
+    // world = local * parent world, the Matrix4 convention for row vectors
+    template <typename Scalar>
+    class TransformHierarchy
+    {
+        public:
+            typedef Matrix4<Scalar> MatrixType;
+            typedef AxisAlignedBoundingBox3d<Scalar> BoundsType;
+            typedef Vector3d<Scalar> VectorType;
+            typedef uint32_t IndexType;
+            typedef std::pair<size_t, size_t> RangeType;
+
+            static constexpr IndexType sNone = 0xffffffff;
+
+            TransformHierarchy();
+
+            // adds a node under parent (or sNone for a root), returning its id.
+            // ids are handed out in order and stay valid for the hierarchy's lifetime
+            IndexType AddNode(IndexType parent, const MatrixType& local);
+            IndexType AddNode(IndexType parent, const MatrixType& local, const BoundsType& localBounds);
+
+            size_t GetNodeCount() const;
+            IndexType GetParent(IndexType node) const;
+
+            const MatrixType& GetLocal(IndexType node) const;
+            void SetLocal(IndexType node, const MatrixType& local);
+            void SetLocalBounds(IndexType node, const BoundsType& localBounds);
+
+            // recomputes every dirty subtree
+            void Update();
+            void Update(const ExecutionPolicy& policy);
+
+            // the two halves of Update, for callers running the ranges on
+            // several threads: gathers the disjoint slot ranges needing work,
+            // then UpdateRange may be called on each concurrently
+            void GatherDirtyRanges(std::vector<RangeType>& ranges);
+            void UpdateRange(const RangeType& range);
+
+            // valid after Update
+            const MatrixType& GetWorld(IndexType node) const;
+            const BoundsType& GetWorldBounds(IndexType node) const;
+
+            // everything in slot (depth first) order, valid after Update
+            const std::vector<MatrixType>& GetWorldMatrices() const;
+            const std::vector<BoundsType>& GetWorldBoundsArray() const;
+            IndexType GetNodeAtSlot(size_t slot) const;
+
+        private:
+            void Rebuild();
+
+            // by id
+            std::vector<IndexType> mParent;
+            std::vector<IndexType> mSlot;
+
+            // by slot
+            std::vector<IndexType> mNode;
+            std::vector<IndexType> mParentSlot;
+            std::vector<IndexType> mSubtreeSize;
+            std::vector<MatrixType> mLocal;
+            std::vector<BoundsType> mLocalBounds;
+            std::vector<MatrixType> mWorld;
+            std::vector<BoundsType> mWorldBounds;
+            std::vector<char> mDirty;
+
+            bool mStructureChanged;
+    };
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template <typename Scalar>
+    TransformHierarchy<Scalar>::TransformHierarchy()
+        : mStructureChanged(false)
+    {
+    }
+
+    template <typename Scalar>
+    typename TransformHierarchy<Scalar>::IndexType TransformHierarchy<Scalar>::AddNode(IndexType parent, const MatrixType& local)
+    {
+        return AddNode( parent, local, BoundsType( VectorType(0,0,0) ) );
+    }
+
+    template <typename Scalar>
+    typename TransformHierarchy<Scalar>::IndexType TransformHierarchy<Scalar>::AddNode(
+        IndexType parent, const MatrixType& local, const BoundsType& localBounds)
+    {
+        assert( parent==sNone || parent<mParent.size() );
+        const IndexType id = IndexType( mParent.size() );
+        mParent.push_back( parent );
+
+        // parked at the end until the next Update puts it in depth first order
+        mSlot.push_back( id );
+        mNode.push_back( id );
+        mParentSlot.push_back( sNone );
+        mSubtreeSize.push_back( 1 );
+        mLocal.push_back( local );
+        mLocalBounds.push_back( localBounds );
+        mWorld.push_back( local );
+        mWorldBounds.push_back( localBounds );
+        mDirty.push_back( 1 );
+        mStructureChanged = true;
+        return id;
+    }
+
+    template <typename Scalar>
+    size_t TransformHierarchy<Scalar>::GetNodeCount() const
+    {
+        return mParent.size();
+    }
+
+    template <typename Scalar>
+    typename TransformHierarchy<Scalar>::IndexType TransformHierarchy<Scalar>::GetParent(IndexType node) const
+    {
+        assert( node<mParent.size() );
+        return mParent[node];
+    }
+
+    template <typename Scalar>
+    const typename TransformHierarchy<Scalar>::MatrixType& TransformHierarchy<Scalar>::GetLocal(IndexType node) const
+    {
+        assert( node<mParent.size() );
+        return mLocal[mSlot[node]];
+    }
+
+    template <typename Scalar>
+    void TransformHierarchy<Scalar>::SetLocal(IndexType node, const MatrixType& local)
+    {
+        assert( node<mParent.size() );
+        mLocal[mSlot[node]] = local;
+        mDirty[mSlot[node]] = 1;
+    }
+
+    template <typename Scalar>
+    void TransformHierarchy<Scalar>::SetLocalBounds(IndexType node, const BoundsType& localBounds)
+    {
+        assert( node<mParent.size() );
+        mLocalBounds[mSlot[node]] = localBounds;
+        mDirty[mSlot[node]] = 1;
+    }
+
+    template <typename Scalar>
+    void TransformHierarchy<Scalar>::Rebuild()
+    {
+        const size_t count = mParent.size();
+
+        // children of each node in one flat array, in id order, by a
+        // counting sort on the parent, roots counted as children of node
+        // count. the counts go two along so that placing the children moves
+        // each start into place, leaving node p's children at
+        // [childStart[p], childStart[p+1])
+        std::vector<size_t> childStart( count+3, 0 );
+        for (size_t i=0;i!=count;++i)
+            ++childStart[(mParent[i]==sNone ? count : size_t(mParent[i])) + 2];
+        for (size_t p=0;p!=count+2;++p)
+            childStart[p+1] += childStart[p];
+        std::vector<IndexType> children( count );
+        for (size_t i=0;i!=count;++i)
+            children[childStart[(mParent[i]==sNone ? count : size_t(mParent[i])) + 1]++] = IndexType(i);
+
+        // preorder walk, pushing children last first so they come off in id order
+        std::vector<IndexType> order;
+        order.reserve( count );
+        std::vector<IndexType> stack;
+        stack.reserve( count );
+        for (size_t c=childStart[count+1];c--!=childStart[count];)
+            stack.push_back( children[c] );
+        while (!stack.empty())
+        {
+            const IndexType node = stack.back();
+            stack.pop_back();
+            order.push_back( node );
+            for (size_t c=childStart[node+1];c--!=childStart[node];)
+                stack.push_back( children[c] );
+        }
+        assert( order.size()==count );
+
+        std::vector<MatrixType> local;
+        std::vector<BoundsType> localBounds;
+        local.reserve( count );
+        localBounds.reserve( count );
+        for (size_t s=0;s!=count;++s)
+        {
+            local.push_back( mLocal[mSlot[order[s]]] );
+            localBounds.push_back( mLocalBounds[mSlot[order[s]]] );
+        }
+        mLocal.swap( local );
+        mLocalBounds.swap( localBounds );
+
+        mNode = order;
+        for (size_t s=0;s!=count;++s)
+            mSlot[order[s]] = IndexType(s);
+        for (size_t s=0;s!=count;++s)
+        {
+            const IndexType parent = mParent[order[s]];
+            mParentSlot[s] = parent==sNone ? sNone : mSlot[parent];
+        }
+
+        // subtree sizes accumulate from the back, children follow parents
+        std::fill( mSubtreeSize.begin(), mSubtreeSize.end(), 1 );
+        for (size_t s=count;s--!=0;)
+        {
+            if (mParentSlot[s]!=sNone)
+                mSubtreeSize[mParentSlot[s]] += mSubtreeSize[s];
+        }
+
+        std::fill( mDirty.begin(), mDirty.end(), 1 );
+        mStructureChanged = false;
+    }
+
+    template <typename Scalar>
+    void TransformHierarchy<Scalar>::GatherDirtyRanges(std::vector<RangeType>& ranges)
+    {
+        if (mStructureChanged)
+            Rebuild();
+
+        ranges.clear();
+        const size_t count = mDirty.size();
+        for (size_t s=0;s<count;)
+        {
+            if (mDirty[s])
+            {
+                ranges.push_back( RangeType( s, s+mSubtreeSize[s] ) );
+                s += mSubtreeSize[s];
+            }
+            else
+            {
+                ++s;
+            }
+        }
+    }
+
+    template <typename Scalar>
+    void TransformHierarchy<Scalar>::UpdateRange(const RangeType& range)
+    {
+        assert( !mStructureChanged );
+        for (size_t s=range.first;s!=range.second;++s)
+        {
+            const IndexType parent = mParentSlot[s];
+            if (parent==sNone)
+                mWorld[s] = mLocal[s];
+            else
+                mWorld[s] = mLocal[s] * mWorld[parent];
+
+            mWorldBounds[s] = Affine3<Scalar>( mWorld[s] ).TransformBounds( mLocalBounds[s] );
+            mDirty[s] = 0;
+        }
+    }
+
+    template <typename Scalar>
+    void TransformHierarchy<Scalar>::Update()
+    {
+        std::vector<RangeType> ranges;
+        GatherDirtyRanges( ranges );
+        for (const RangeType& range : ranges)
+            UpdateRange( range );
+    }
+
+    template <typename Scalar>
+    void TransformHierarchy<Scalar>::Update(const ExecutionPolicy& policy)
+    {
+        std::vector<RangeType> ranges;
+        GatherDirtyRanges( ranges );
+
+        // the grain counts dirty subtrees here, not nodes, as their sizes vary wildly
+        ParallelFor( policy.WithGrain(1), 0, ranges.size(), [this, &ranges](size_t begin, size_t end) {
+            for (size_t r=begin;r!=end;++r)
+                UpdateRange( ranges[r] );
+        } );
+    }
+
+    template <typename Scalar>
+    const typename TransformHierarchy<Scalar>::MatrixType& TransformHierarchy<Scalar>::GetWorld(IndexType node) const
+    {
+        assert( node<mParent.size() );
+        assert( !mStructureChanged && !mDirty[mSlot[node]] );
+        return mWorld[mSlot[node]];
+    }
+
+    template <typename Scalar>
+    const typename TransformHierarchy<Scalar>::BoundsType& TransformHierarchy<Scalar>::GetWorldBounds(IndexType node) const
+    {
+        assert( node<mParent.size() );
+        assert( !mStructureChanged && !mDirty[mSlot[node]] );
+        return mWorldBounds[mSlot[node]];
+    }
+
+    template <typename Scalar>
+    const std::vector<typename TransformHierarchy<Scalar>::MatrixType>& TransformHierarchy<Scalar>::GetWorldMatrices() const
+    {
+        return mWorld;
+    }
+
+    template <typename Scalar>
+    const std::vector<typename TransformHierarchy<Scalar>::BoundsType>& TransformHierarchy<Scalar>::GetWorldBoundsArray() const
+    {
+        return mWorldBounds;
+    }
+
+    template <typename Scalar>
+    typename TransformHierarchy<Scalar>::IndexType TransformHierarchy<Scalar>::GetNodeAtSlot(size_t slot) const
+    {
+        assert( slot<mNode.size() );
+        return mNode[slot];
+    }
+}
+
+#endif//GEOMETRY_TRANSFORM_HIERARCHY_H_INCLUDED_
@@ -33,8 +33,8 @@ namespace Geometry
     template<typename Triangle>
     typename Triangle::VectorType FaceNormal( const Triangle& t )
     {
-        const typename Triangle::VectorType ab = t.GetB() - t.GetA();
-        const typename Triangle::VectorType ac = t.GetC() - t.GetA();
+        const typename Triangle::VectorType ab( t.GetB() - t.GetA() );
+        const typename Triangle::VectorType ac( t.GetC() - t.GetA() );
         typename Triangle::VectorType cross = CrossProduct( ab, ac );
         cross.Normalise();
         return cross;
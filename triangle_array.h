@@ -0,0 +1,269 @@
+#ifndef GEOMETRY_TRIANGLE_ARRAY_H_INCLUDED_
+#define GEOMETRY_TRIANGLE_ARRAY_H_INCLUDED_
+
+#include "triangle.h"
+#include "base_maths.h"
+
+#include <cassert>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // what the batch angle functions write out
+    enum AngleOutput {
+        // angles in radians
+        angle_radians,
+        // the cosine of each angle, skipping the acos entirely.
+        // note the ordering flips, the smallest angle has the largest cosine
+        angle_cosines
+    };
+
+    // triangles stored structure-of-arrays: one contiguous array per
+    // vertex per axis, so batch kernels read straight lines of scalars
+    template<typename T>
+    class TriangleArray
+    {
+        public:
+            typedef T VertexType;
+            typedef typename VertexType::VectorType VectorType;
+            typedef typename VectorType::ScalarType ScalarType;
+            typedef Triangle<T> TriangleType;
+            const static size_t sDimensions = VectorType::sDimensions;
+
+            TriangleArray();
+
+            size_t GetSize() const;
+            void Reserve(size_t count);
+
+            void Add(const TriangleType& t);
+            TriangleType Get(size_t i) const;
+
+            // the coordinate along axis of vertex (0,1,2) of every triangle
+            const ScalarType* GetCoordinates(size_t vertex, size_t axis) const;
+            ScalarType* GetCoordinates(size_t vertex, size_t axis);
+
+        private:
+            std::vector<ScalarType> mData[3*sDimensions];
+    };
+
+    //
+    // Free-functions
+    //
+
+    // squared edge lengths for triangles [first,last), edge n runs from vertex n to vertex n+1
+    template<typename T>
+    void ComputeEdgeLengthsSquare(
+        const TriangleArray<T>& triangles, size_t first, size_t last,
+        typename TriangleArray<T>::ScalarType* d0s,
+        typename TriangleArray<T>::ScalarType* d1s,
+        typename TriangleArray<T>::ScalarType* d2s )
+    {
+        typedef typename TriangleArray<T>::ScalarType ScalarType;
+        assert( first<=last && last<=triangles.GetSize() );
+        const size_t count = last-first;
+        for (size_t i=0;i!=count;++i)
+        {
+            d0s[i] = 0; d1s[i] = 0; d2s[i] = 0;
+        }
+        for (size_t d=0;d!=TriangleArray<T>::sDimensions;++d)
+        {
+            const ScalarType* a = triangles.GetCoordinates(0,d) + first;
+            const ScalarType* b = triangles.GetCoordinates(1,d) + first;
+            const ScalarType* c = triangles.GetCoordinates(2,d) + first;
+            for (size_t i=0;i!=count;++i)
+            {
+                const ScalarType ab = b[i]-a[i];
+                const ScalarType bc = c[i]-b[i];
+                const ScalarType ca = a[i]-c[i];
+                d0s[i] += ab*ab;
+                d1s[i] += bc*bc;
+                d2s[i] += ca*ca;
+            }
+        }
+    }
+
+    // batch Triangle::ComputeAngles, angle n is at vertex n. the acos comes
+    // from the given accuracy tier, the C library unless accuracy_fast asks
+    // for ACosApprox. an angle at either end of a zero length edge is given
+    // as pi, matching the largest angle ComputeTriangleQuality reports for it
+    template<Accuracy A = accuracy_exact, typename T>
+    void ComputeAngles(
+        const TriangleArray<T>& triangles, size_t first, size_t last,
+        typename TriangleArray<T>::ScalarType* a0,
+        typename TriangleArray<T>::ScalarType* a1,
+        typename TriangleArray<T>::ScalarType* a2,
+        AngleOutput output = angle_radians )
+    {
+        typedef typename TriangleArray<T>::ScalarType ScalarType;
+        // squared edge lengths land in the outputs, then are replaced in place
+        ComputeEdgeLengthsSquare( triangles, first, last, a0, a1, a2 );
+        const size_t count = last-first;
+        for (size_t i=0;i!=count;++i)
+        {
+            const ScalarType d0s = a0[i], d1s = a1[i], d2s = a2[i];
+            const ScalarType p0 = d2s * d0s, p1 = d0s * d1s, p2 = d1s * d2s;
+            ScalarType c0 = p0 > 0 ? ( d2s + d0s - d1s ) / ( 2 * Sqrt( p0 ) ) : ScalarType(-1);
+            ScalarType c1 = p1 > 0 ? ( d0s + d1s - d2s ) / ( 2 * Sqrt( p1 ) ) : ScalarType(-1);
+            ScalarType c2 = p2 > 0 ? ( d1s + d2s - d0s ) / ( 2 * Sqrt( p2 ) ) : ScalarType(-1);
+            // rounding can push a near degenerate triangle fractionally outside [-1,1]
+            c0 = std::min( std::max( c0, ScalarType(-1) ), ScalarType(1) );
+            c1 = std::min( std::max( c1, ScalarType(-1) ), ScalarType(1) );
+            c2 = std::min( std::max( c2, ScalarType(-1) ), ScalarType(1) );
+            a0[i] = c0; a1[i] = c1; a2[i] = c2;
+        }
+        if (output == angle_radians)
+        {
+            for (size_t i=0;i!=count;++i)
+            {
+                a0[i] = A == accuracy_fast ? ACosApprox( a0[i] ) : ACos( a0[i] );
+                a1[i] = A == accuracy_fast ? ACosApprox( a1[i] ) : ACos( a1[i] );
+                a2[i] = A == accuracy_fast ? ACosApprox( a2[i] ) : ACos( a2[i] );
+            }
+        }
+    }
+
+    // the smallest and largest angle, and the surface area, of each triangle
+    // in [first,last) in a single pass. any output may be null. degenerate
+    // triangles give angles of 0 and pi and no area.
+    // with angle_cosines minAngle/maxAngle hold the cosines of those angles,
+    // otherwise the acos comes from the given tier as in ComputeAngles
+    template<Accuracy A = accuracy_exact, typename T>
+    void ComputeTriangleQuality(
+        const TriangleArray<T>& triangles, size_t first, size_t last,
+        typename TriangleArray<T>::ScalarType* minAngle,
+        typename TriangleArray<T>::ScalarType* maxAngle,
+        typename TriangleArray<T>::ScalarType* area,
+        AngleOutput output = angle_radians )
+    {
+        typedef typename TriangleArray<T>::ScalarType ScalarType;
+        const size_t count = last-first;
+
+        // a block of squared edge lengths at a time, on the stack
+        const size_t block = 256;
+        ScalarType d0s[block], d1s[block], d2s[block];
+        for (size_t begin=0;begin<count;begin+=block)
+        {
+            const size_t n = std::min( block, count-begin );
+            ComputeEdgeLengthsSquare( triangles, first+begin, first+begin+n, d0s, d1s, d2s );
+            for (size_t j=0;j!=n;++j)
+            {
+                const size_t i = begin+j;
+                const ScalarType a = d0s[j], b = d1s[j], c = d2s[j];
+
+                // the smallest angle is opposite the shortest edge, the largest
+                // opposite the longest. edge 1 is opposite vertex 0 and so on
+                const ScalarType lo = std::min( a, std::min( b, c ) );
+                const ScalarType hi = std::max( a, std::max( b, c ) );
+                const ScalarType mid = a + b + c - lo - hi;
+
+                // a zero length edge makes the triangle a segment, with
+                // angles of 0 and pi as for three points on a line
+                if (minAngle)
+                {
+                    const ScalarType d = mid * hi;
+                    const ScalarType cmin = d > 0 ? ( mid + hi - lo ) / ( 2 * Sqrt( d ) ) : ScalarType(1);
+                    minAngle[i] = std::min( cmin, ScalarType(1) );
+                }
+                if (maxAngle)
+                {
+                    const ScalarType d = lo * mid;
+                    const ScalarType cmax = d > 0 ? ( lo + mid - hi ) / ( 2 * Sqrt( d ) ) : ScalarType(-1);
+                    maxAngle[i] = std::max( cmax, ScalarType(-1) );
+                }
+                if (area)
+                {
+                    // Heron's formula on squared lengths: 16A^2 = 4a^2b^2 - (a^2+b^2-c^2)^2
+                    const ScalarType k = a + b - c;
+                    const ScalarType a16 = 4*a*b - k*k;
+                    area[i] = a16 > 0 ? Sqrt( a16 ) / 4 : 0;
+                }
+            }
+        }
+
+        if (output == angle_radians)
+        {
+            if (minAngle)
+                for (size_t i=0;i!=count;++i)
+                    minAngle[i] = A == accuracy_fast ? ACosApprox( minAngle[i] ) : ACos( minAngle[i] );
+            if (maxAngle)
+                for (size_t i=0;i!=count;++i)
+                    maxAngle[i] = A == accuracy_fast ? ACosApprox( maxAngle[i] ) : ACos( maxAngle[i] );
+        }
+    }
+
+    // surface areas of triangles [first,last)
+    template<typename T>
+    void ComputeSurfaceAreas(
+        const TriangleArray<T>& triangles, size_t first, size_t last,
+        typename TriangleArray<T>::ScalarType* area )
+    {
+        ComputeTriangleQuality( triangles, first, last, nullptr, nullptr, area );
+    }
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template<typename T>
+    TriangleArray<T>::TriangleArray()
+    {
+    }
+
+    template<typename T>
+    size_t TriangleArray<T>::GetSize() const
+    {
+        return mData[0].size();
+    }
+
+    template<typename T>
+    void TriangleArray<T>::Reserve(size_t count)
+    {
+        for (auto& a : mData)
+            a.reserve(count);
+    }
+
+    template<typename T>
+    void TriangleArray<T>::Add(const TriangleType& t)
+    {
+        for (size_t v=0;v!=3;++v)
+            for (size_t d=0;d!=sDimensions;++d)
+                mData[v*sDimensions+d].push_back( t.Get(int(v))[d] );
+    }
+
+    template<typename T>
+    typename TriangleArray<T>::TriangleType TriangleArray<T>::Get(size_t i) const
+    {
+        assert( i<GetSize() );
+        TriangleType result( uninitialised );
+        VertexType v[3] = { VertexType(uninitialised), VertexType(uninitialised), VertexType(uninitialised) };
+        for (size_t n=0;n!=3;++n)
+            for (size_t d=0;d!=sDimensions;++d)
+                v[n][d] = mData[n*sDimensions+d][i];
+        result.SetA(v[0]);
+        result.SetB(v[1]);
+        result.SetC(v[2]);
+        return result;
+    }
+
+    template<typename T>
+    const typename TriangleArray<T>::ScalarType* TriangleArray<T>::GetCoordinates(size_t vertex, size_t axis) const
+    {
+        assert( vertex<3 && axis<sDimensions );
+        return mData[vertex*sDimensions+axis].data();
+    }
+
+    template<typename T>
+    typename TriangleArray<T>::ScalarType* TriangleArray<T>::GetCoordinates(size_t vertex, size_t axis)
+    {
+        assert( vertex<3 && axis<sDimensions );
+        return mData[vertex*sDimensions+axis].data();
+    }
+}
+
+#endif//GEOMETRY_TRIANGLE_ARRAY_H_INCLUDED_
@@ -0,0 +1,295 @@
+#ifndef GEOMETRY_VECTORX_H_INCLUDED_
+#define GEOMETRY_VECTORX_H_INCLUDED_
+
+#include "base_maths.h"
+#include "vectorn.h"
+
+#include <cassert>
+#include <initializer_list>
+#include <vector>
+#include <algorithm>
+
+namespace Geometry
+{
+    //
+    // Interface
+    //
+
+    // VectorN with its size chosen at runtime
+    template< typename Scalar >
+    class VectorX
+    {
+    public:
+        typedef Scalar ScalarType;
+        typedef VectorX<Scalar> VectorType;
+
+        // empty
+        VectorX();
+
+        // zero filled. there is no uninitialised form, std::vector
+        // value-initialises whatever it is asked for
+        explicit VectorX(size_t size);
+
+        VectorX(size_t size, Scalar value);
+
+        VectorX(std::initializer_list<Scalar> data);
+
+        // from a fixed size vector
+        template< size_t N >
+        explicit VectorX(const VectorN<Scalar, N>& rhs);
+
+        size_t GetSize() const;
+
+        // keeps the leading elements, new ones are zero
+        void Resize(size_t size);
+
+        // copies out to a fixed size vector of the same size
+        template< size_t N >
+        void ComputeFixed(VectorN<Scalar, N>& result) const;
+
+        // simple accessors
+        void Set (size_t offset, Scalar value);
+        Scalar& operator[] (size_t offset);
+        Scalar Get (size_t offset) const;
+        const Scalar& operator[] (size_t offset) const;
+
+        Scalar* GetData();
+        const Scalar* GetData() const;
+
+        Scalar LengthSquare() const;
+        Scalar Length() const;
+        Scalar DistanceSquare(const VectorX& rhs) const;
+
+        // binary operators
+        VectorX& operator += (const VectorX& rhs);
+        VectorX& operator -= (const VectorX& rhs);
+        VectorX& operator *= (const Scalar rhs);
+        VectorX& operator /= (const Scalar rhs);
+        bool operator == (const VectorX& rhs) const;
+        bool operator != (const VectorX& rhs) const;
+
+        void Normalise();
+
+        static
+        Scalar DotProduct( const VectorX& lhs, const VectorX& rhs );
+
+    private:
+        std::vector<Scalar> mData;
+    };
+
+    //
+    // Free-functions
+    //
+
+    template< typename Scalar >
+    Scalar DotProduct( const VectorX<Scalar>& lhs, const VectorX<Scalar>& rhs )
+    {
+        return VectorX<Scalar>::DotProduct( lhs, rhs );
+    }
+
+    template< typename Scalar >
+    VectorX<Scalar> operator+ (VectorX<Scalar> lhs, const VectorX<Scalar>& rhs)
+    {
+        lhs += rhs;
+        return lhs;
+    }
+
+    template< typename Scalar >
+    VectorX<Scalar> operator- (VectorX<Scalar> lhs, const VectorX<Scalar>& rhs)
+    {
+        lhs -= rhs;
+        return lhs;
+    }
+
+    template< typename Scalar >
+    VectorX<Scalar> operator- (VectorX<Scalar> arg)
+    {
+        for (size_t i=0;i!=arg.GetSize();++i)
+            arg[i] = -arg[i];
+        return arg;
+    }
+
+    //
+    // Class Implementation
+    // (in header as is a template)
+    //
+
+    template< typename Scalar >
+    VectorX<Scalar>::VectorX()
+    {
+    }
+
+    template< typename Scalar >
+    VectorX<Scalar>::VectorX(size_t size)
+        : mData(size, Scalar(0))
+    {
+    }
+
+    template< typename Scalar >
+    VectorX<Scalar>::VectorX(size_t size, Scalar value)
+        : mData(size, value)
+    {
+    }
+
+    template< typename Scalar >
+    VectorX<Scalar>::VectorX(std::initializer_list<Scalar> data)
+        : mData(data)
+    {
+    }
+
+    template< typename Scalar >
+    template< size_t N >
+    VectorX<Scalar>::VectorX(const VectorN<Scalar, N>& rhs)
+        : mData(&rhs[0], &rhs[0]+N)
+    {
+    }
+
+    template< typename Scalar >
+    size_t VectorX<Scalar>::GetSize() const
+    {
+        return mData.size();
+    }
+
+    template< typename Scalar >
+    void VectorX<Scalar>::Resize(size_t size)
+    {
+        mData.resize(size, Scalar(0));
+    }
+
+    template< typename Scalar >
+    template< size_t N >
+    void VectorX<Scalar>::ComputeFixed(VectorN<Scalar, N>& result) const
+    {
+        assert( mData.size()==N );
+        std::copy( mData.begin(), mData.end(), &result[0] );
+    }
+
+    template< typename Scalar >
+    void VectorX<Scalar>::Set(size_t offset, Scalar value)
+    {
+        assert( offset<mData.size() );
+        mData[offset]=value;
+    }
+
+    template< typename Scalar >
+    Scalar& VectorX<Scalar>::operator[] (size_t offset)
+    {
+        assert( offset<mData.size() );
+        return mData[offset];
+    }
+
+    template< typename Scalar >
+    Scalar VectorX<Scalar>::Get(size_t offset) const
+    {
+        assert( offset<mData.size() );
+        return mData[offset];
+    }
+
+    template< typename Scalar >
+    const Scalar& VectorX<Scalar>::operator[] (size_t offset) const
+    {
+        assert( offset<mData.size() );
+        return mData[offset];
+    }
+
+    template< typename Scalar >
+    Scalar* VectorX<Scalar>::GetData()
+    {
+        return mData.data();
+    }
+
+    template< typename Scalar >
+    const Scalar* VectorX<Scalar>::GetData() const
+    {
+        return mData.data();
+    }
+
+    template< typename Scalar >
+    Scalar VectorX<Scalar>::LengthSquare() const
+    {
+        return DotProduct( *this, *this );
+    }
+
+    template< typename Scalar >
+    Scalar VectorX<Scalar>::Length() const
+    {
+        return Sqrt( LengthSquare() );
+    }
+
+    template< typename Scalar >
+    Scalar VectorX<Scalar>::DistanceSquare(const VectorX& rhs) const
+    {
+        assert( rhs.GetSize()==GetSize() );
+        Scalar l2 = 0;
+        for (size_t i=0;i!=mData.size();++i)
+        {
+            const Scalar d = rhs.mData[i] - mData[i];
+            l2 += d*d;
+        }
+        return l2;
+    }
+
+    template< typename Scalar >
+    VectorX<Scalar>& VectorX<Scalar>::operator += (const VectorX& rhs)
+    {
+        assert( rhs.GetSize()==GetSize() );
+        for (size_t i=0;i!=mData.size();++i)
+            mData[i] += rhs.mData[i];
+        return *this;
+    }
+
+    template< typename Scalar >
+    VectorX<Scalar>& VectorX<Scalar>::operator -= (const VectorX& rhs)
+    {
+        assert( rhs.GetSize()==GetSize() );
+        for (size_t i=0;i!=mData.size();++i)
+            mData[i] -= rhs.mData[i];
+        return *this;
+    }
+
+    template< typename Scalar >
+    VectorX<Scalar>& VectorX<Scalar>::operator *= (const Scalar rhs)
+    {
+        for (auto& d : mData)
+            d *= rhs;
+        return *this;
+    }
+
+    template< typename Scalar >
+    VectorX<Scalar>& VectorX<Scalar>::operator /= (const Scalar rhs)
+    {
+        for (auto& d : mData)
+            d /= rhs;
+        return *this;
+    }
+
+    template< typename Scalar >
+    bool VectorX<Scalar>::operator == (const VectorX& rhs) const
+    {
+        return mData == rhs.mData;
+    }
+
+    template< typename Scalar >
+    bool VectorX<Scalar>::operator != (const VectorX& rhs) const
+    {
+        return !operator==(rhs);
+    }
+
+    template< typename Scalar >
+    void VectorX<Scalar>::Normalise()
+    {
+        *this /= Length();
+    }
+
+    template< typename Scalar >
+    Scalar VectorX<Scalar>::DotProduct( const VectorX& lhs, const VectorX& rhs )
+    {
+        assert( lhs.GetSize()==rhs.GetSize() );
+        Scalar result = 0;
+        for (size_t i=0;i!=lhs.mData.size();++i)
+            result += lhs.mData[i] * rhs.mData[i];
+        return result;
+    }
+}
+
+#endif//GEOMETRY_VECTORX_H_INCLUDED_